@@ -0,0 +1,71 @@
+#include "arena.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+using namespace std;
+
+static char* align_up(char* pointer, size_t alignment) {
+    uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+    return reinterpret_cast<char*>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+}
+
+Arena::~Arena() {
+    for (Block* list : {used, spare}) {
+        while (list != nullptr) {
+            Block* next = list->next;
+            free(list);
+            list = next;
+        }
+    }
+}
+
+void* Arena::allocate(size_t size, size_t alignment) {
+    char* start = align_up(cursor, alignment);
+    if (cursor == nullptr || start + size > limit) {
+        grow(size, alignment);
+        start = align_up(cursor, alignment);
+    }
+    cursor = start + size;
+    allocated += size;
+    return start;
+}
+
+void Arena::reset() {
+    while (used != nullptr) {
+        Block* next = used->next;
+        used->next = spare;
+        spare = used;
+        used = next;
+    }
+    cursor = nullptr;
+    limit = nullptr;
+    allocated = 0;
+}
+
+void Arena::grow(size_t size, size_t alignment) {
+    size_t needed = size + alignment + sizeof(Block);
+
+    // Reuse a spare block if one is big enough
+    Block** link = &spare;
+    while (*link != nullptr && (*link)->size + sizeof(Block) < needed) {
+        link = &(*link)->next;
+    }
+    Block* block = *link;
+    if (block != nullptr) {
+        *link = block->next;
+    } else {
+        size_t space = needed > block_size ? needed : block_size;
+        block = static_cast<Block*>(malloc(space));
+        if (block == nullptr) {
+            throw bad_alloc();
+        }
+        block->size = space - sizeof(Block);
+        reserved += space;
+    }
+
+    block->next = used;
+    used = block;
+    cursor = reinterpret_cast<char*>(block + 1);
+    limit = cursor + block->size;
+}
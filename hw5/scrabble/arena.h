@@ -0,0 +1,96 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <utility>
+
+/*
+ A bump allocator: allocations are carved out of large blocks one after the other, and only freed all at once by
+ reset() or the destructor. Nothing allocated in it is destroyed, so it is for objects whose destructors would only
+ free memory that came from the same arena, such as containers using an ArenaAllocator.
+
+ Dictionary keeps its trie in one for the lifetime of the dictionary; each ComputerPlayer search owns one for its
+ scratch space, freed when the search ends, so searches running at once share nothing.
+*/
+class Arena {
+public:
+    static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) : block_size(block_size) {}
+    ~Arena();
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    // alignment must be a power of two
+    void* allocate(size_t size, size_t alignment);
+
+    template<class T, class... Args>
+    T* make(Args&&... args) {
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    /*
+    Frees everything allocated so far. The blocks are kept for the next allocations, so an arena reset every turn
+    stops asking the system for memory once it has grown to what a turn needs.
+    */
+    void reset();
+
+    // Bytes handed out since the last reset
+    size_t bytes_allocated() const { return allocated; }
+
+    // Bytes of blocks held, in use or kept for reuse
+    size_t bytes_reserved() const { return reserved; }
+
+private:
+    struct Block {
+        Block* next;
+        size_t size;  // Of the space after this header
+    };
+
+    size_t block_size;
+    Block* used = nullptr;   // The current block first
+    Block* spare = nullptr;  // Blocks freed by reset()
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    size_t allocated = 0;
+    size_t reserved = 0;
+
+    // Switches to a block with room for size bytes at alignment, reusing a spare one if it is big enough
+    void grow(size_t size, size_t alignment);
+};
+
+// Lets standard containers allocate from an Arena. Deallocation does nothing; the arena frees everything at once.
+template<class T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(Arena& arena) : arena(&arena) {}
+
+    template<class U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+
+    void deallocate(T*, size_t) {}
+
+    template<class U>
+    bool operator==(const ArenaAllocator<U>& other) const {
+        return arena == other.arena;
+    }
+
+    template<class U>
+    bool operator!=(const ArenaAllocator<U>& other) const {
+        return arena != other.arena;
+    }
+
+private:
+    template<class U>
+    friend class ArenaAllocator;
+
+    Arena* arena;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "tile_bag.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Every operator new in the program goes through here, so the counts include the standard containers
+static size_t allocations = 0;
+static size_t allocated_bytes = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    allocated_bytes += size;
+    void* memory = malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) {
+        throw bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+// Resident set size of this process in kB, from /proc
+static size_t rss_kb() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            return stoul(line.substr(6));
+        }
+    }
+    return 0;
+}
+
+// How many allocations and how much memory loading the dictionary and searching for moves take.
+// Run from this directory so the config files can be found.
+int main() {
+    size_t rss_before = rss_kb();
+    size_t allocations_before = allocations;
+    size_t bytes_before = allocated_bytes;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Dictionary dictionary = Dictionary::read("../config/english-dictionary.txt");
+    chrono::duration<double> load_time = chrono::steady_clock::now() - start;
+    cout << "dictionary: " << allocations - allocations_before << " allocations, "
+         << (allocated_bytes - bytes_before) / 1024 << " kB allocated, " << rss_kb() - rss_before << " kB more RSS, "
+         << load_time.count() * 1000 << " ms" << endl;
+
+    size_t turns = 0;
+    size_t points = 0;  // Should not change with how the search allocates
+    size_t search_allocations = 0;
+    double search_time = 0;
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        Board board = Board::read("../config/standard-board.txt");
+        TileBag bag = TileBag::read("../config/english-tile-bag.txt", seed);
+        ComputerPlayer cpu("cpu", 7);
+        for (size_t turn = 0; turn < 12; turn++) {
+            cpu.add_tiles(bag.remove_random_tiles(7 - cpu.count_tiles()));
+            allocations_before = allocations;
+            start = chrono::steady_clock::now();
+            Move move = cpu.get_move(board, dictionary);
+            search_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            search_allocations += allocations - allocations_before;
+            turns++;
+            if (move.kind != MoveKind::PLACE) {
+                break;
+            }
+            points += board.place(move).points;
+            cpu.remove_tiles(move.tiles);
+        }
+    }
+    cout << "search: " << search_allocations / turns << " allocations, " << search_time / turns * 1000
+         << " ms per turn over " << turns << " turns, " << points << " points" << endl;
+    return 0;
+}
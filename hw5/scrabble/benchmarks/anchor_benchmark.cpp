@@ -0,0 +1,50 @@
+#include "board.h"
+#include "board_rules.h"
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+// Compares get_anchors() on the occupancy bitboards with the square by square scan it replaced, on boards at several
+// stages of a game. Run from this directory so the board file can be found.
+int main() {
+    Board board = Board::read("../config/standard-board.txt");
+    mt19937 random(2024);
+    const size_t rounds = 20000;
+
+    cout << "tiles  anchors  square scan (us)  bitboards (us)  speedup" << endl;
+    for (size_t tiles = 0; tiles <= 100; tiles += 20) {
+        while (tiles > 0 && board.get_move_index() < tiles) {
+            Board::Position p(random() % board.rows, random() % board.columns);
+            if (!board.in_bounds_and_has_tile(p)) {
+                board.place_unchecked(Move(vector<TileKind>{TileKind('A', 1)}, p.row, p.column, Direction::ACROSS));
+            }
+        }
+
+        size_t scan_count = 0;
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < rounds; i++) {
+            scan_count += BoardRules::get_anchors(board).size();
+        }
+        chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+        chrono::duration<double, micro> scan_time = stop - start;
+
+        size_t bits_count = 0;
+        start = chrono::high_resolution_clock::now();
+        for (size_t i = 0; i < rounds; i++) {
+            bits_count += board.get_anchors().size();
+        }
+        stop = chrono::high_resolution_clock::now();
+        chrono::duration<double, micro> bits_time = stop - start;
+
+        if (scan_count != bits_count) {
+            cout << "anchor counts differ!" << endl;
+            return 1;
+        }
+        cout << tiles << "\t" << bits_count / rounds << "\t " << scan_time.count() / rounds << "\t\t   "
+             << bits_time.count() / rounds << "\t\t   " << scan_time.count() / bits_time.count() << "x" << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,90 @@
+#include "board.h"
+#include "position_corpus.h"
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+using namespace std;
+
+// Times writing a position corpus and reading it back through the memory mapping, compared with rebuilding the same
+// positions by replaying moves. Run from this directory so the board file can be found.
+int main() {
+    const Board initial = Board::read("../config/standard-board.txt");
+    const string path = "/tmp/corpus_benchmark.bin";
+    const size_t games = 2000;
+
+    // The moves of a synthetic game that fills the board with five letter words, three per row
+    vector<Move> moves;
+    for (size_t row = 0; row < initial.rows; row++) {
+        for (size_t column = 0; column + 5 <= initial.columns; column += 5) {
+            vector<TileKind> tiles;
+            for (size_t i = 0; i < 5; i++) {
+                tiles.push_back(TileKind('a' + (row + column + i) % 26, 1));
+            }
+            moves.push_back(Move(tiles, row, column, Direction::ACROSS));
+        }
+    }
+
+    // Writing every position of every game
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    {
+        PositionCorpusWriter writer(path);
+        for (size_t i = 0; i < games; i++) {
+            Board board = initial;
+            for (const Move& move : moves) {
+                board.place_unchecked(move);
+                writer.add(board);
+            }
+        }
+    }
+    chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> write_time = stop - start;
+
+    PositionCorpus corpus(path);
+    size_t positions = corpus.size();
+    cout << positions << " positions, " << corpus[0].size() << " bytes each" << endl;
+    cout << "write: " << positions / write_time.count() / 1e6 << " million positions per second" << endl;
+
+    // Zero-copy: count tiles straight out of the mapping
+    start = chrono::high_resolution_clock::now();
+    size_t tiles = 0;
+    for (size_t i = 0; i < positions; i++) {
+        BoardSnapshot snapshot = corpus[i];
+        for (size_t row = 0; row < snapshot.get_rows(); row++) {
+            for (size_t column = 0; column < snapshot.get_columns(); column++) {
+                tiles += snapshot.has_tile(row, column);
+            }
+        }
+    }
+    stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> view_time = stop - start;
+    cout << "scan views: " << positions / view_time.count() / 1e6 << " million positions per second (" << tiles
+         << " tiles)" << endl;
+
+    // Copying each position into a Board
+    start = chrono::high_resolution_clock::now();
+    tiles = 0;
+    for (size_t i = 0; i < positions; i++) {
+        tiles += corpus.board(i).get_move_index();
+    }
+    stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> board_time = stop - start;
+    cout << "load boards: " << positions / board_time.count() / 1e6 << " million positions per second" << endl;
+
+    // Getting each position on its own by replaying its game up to it, as a job visiting positions in any order would
+    start = chrono::high_resolution_clock::now();
+    tiles = 0;
+    for (size_t i = 0; i < positions; i++) {
+        Board board = initial;
+        for (size_t turn = 0; turn <= i % moves.size(); turn++) {
+            board.place_unchecked(moves[turn]);
+        }
+        tiles += board.get_move_index();
+    }
+    stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> replay_time = stop - start;
+    cout << "replay: " << positions / replay_time.count() / 1e6 << " million positions per second" << endl;
+
+    remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "tile_bag.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+// Points the way ComputerPlayer ranks moves, with the bonus for using the whole hand
+static size_t move_points(const Board& board, const Move& move) {
+    if (move.kind != MoveKind::PLACE) {
+        return 0;
+    }
+    return board.test_place(move).points + (move.tiles.size() == 7 ? 50 : 0);
+}
+
+// Plays out a few games on the standard board with full searches and, at every position, also searches with a few
+// time budgets: how late the timed searches return, how often they finish and how much of the best score they find.
+// Run from this directory so the config files can be found.
+int main() {
+    Dictionary dictionary = Dictionary::read("../config/english-dictionary.txt");
+
+    const vector<int> budgets = {1, 5, 20, 100};
+    vector<double> overshoot(budgets.size());
+    vector<size_t> completed(budgets.size());
+    vector<size_t> points(budgets.size());
+    size_t best_points = 0;
+    size_t positions = 0;
+
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        Board board = Board::read("../config/standard-board.txt");
+        TileBag bag = TileBag::read("../config/english-tile-bag.txt", seed);
+        for (size_t turn = 0; turn < 12; turn++) {
+            ComputerPlayer cpu("cpu", 7);
+            cpu.add_tiles(bag.remove_random_tiles(7));
+            Move best = cpu.get_move(board, dictionary);
+            if (best.kind != MoveKind::PLACE) {
+                break;
+            }
+            best_points += move_points(board, best);
+            positions++;
+
+            for (size_t i = 0; i < budgets.size(); i++) {
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                chrono::steady_clock::time_point deadline = start + chrono::milliseconds(budgets[i]);
+                ComputerPlayer::SearchResult result = cpu.get_move(board, dictionary, deadline);
+                chrono::duration<double, milli> late = chrono::steady_clock::now() - deadline;
+                overshoot[i] += late.count() > 0 ? late.count() : 0;
+                completed[i] += result.complete;
+                points[i] += move_points(board, result.move);
+            }
+            board.place(best);
+        }
+    }
+
+    cout << positions << " positions, full searches scored " << best_points << " points" << endl;
+    for (size_t i = 0; i < budgets.size(); i++) {
+        cout << budgets[i] << " ms: " << overshoot[i] / positions << " ms late on average, " << completed[i]
+             << " complete, " << 100.0 * points[i] / best_points << "% of the points" << endl;
+    }
+    return 0;
+}
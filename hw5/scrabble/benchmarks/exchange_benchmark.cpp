@@ -0,0 +1,66 @@
+#include "computer_player.h"
+#include "exchange_evaluator.h"
+#include "game_session.h"
+#include "scrabble.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+// Plays computer games between a player that may exchange and one that may not, taking turns at going first: how
+// often the first one exchanges and how it does, and how long weighing every subset of a full rack takes.
+// Run from this directory so the config files can be found.
+int main() {
+    auto dictionary = make_shared<const Dictionary>(Dictionary::read("../config/english-dictionary.txt"));
+    const Board board = Board::read("../config/standard-board.txt");
+    const TileBag bag = TileBag::read("../config/english-tile-bag.txt", 0);
+
+    const size_t games = 16;
+    size_t wins = 0;
+    size_t exchanges = 0;
+    long margin = 0;
+    for (size_t game = 0; game < games; game++) {
+        GameSession session(dictionary, board, bag, 7, 2024, game);
+        shared_ptr<ComputerPlayer> exchanging = make_shared<ComputerPlayer>("exchanging", 7);
+        shared_ptr<ComputerPlayer> placing = make_shared<ComputerPlayer>("placing", 7);
+        exchanging->enable_exchanges(bag);
+        size_t seat = game % 2;
+        session.add_player(seat == 0 ? exchanging : placing);
+        session.add_player(seat == 0 ? placing : exchanging);
+
+        while (!session.is_over()) {
+            GameSession::TurnResult turn = session.play_turn();
+            if (turn.player_index == seat && turn.kind == MoveKind::EXCHANGE) {
+                exchanges++;
+            }
+        }
+        Scrabble::final_subtraction(session.get_players());
+        long difference = static_cast<long>(exchanging->get_points()) - static_cast<long>(placing->get_points());
+        margin += difference;
+        wins += difference > 0;
+    }
+
+    cout << games << " games: the exchanging player won " << wins << ", by " << static_cast<double>(margin) / games
+         << " points a game on average, exchanging " << static_cast<double>(exchanges) / games << " times a game"
+         << endl;
+
+    vector<TileKind> rack;
+    for (char letter : string("qvvwuue")) {
+        rack.push_back(bag.get_kinds().at(letter));
+    }
+    LeaveTable::Counts unseen = {};
+    for (const auto& kind : bag.get_kinds()) {
+        unseen[LeaveTable::index_of(kind.second.letter)] = bag.count_tiles(kind.second);
+    }
+    const size_t repeats = 10000;
+    uint32_t sink = 0;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; i++) {
+        sink += ExchangeEvaluator(rack, unseen).best_exchange();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    cout << "weighing the 128 subsets of a 7 tile rack: " << elapsed.count() / repeats * 1e6 << " us (" << sink % 2
+         << ")" << endl;
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "fixed_board.h"
+#include "tile_bag.h"
+#include <chrono>
+#include <iostream>
+
+using namespace std;
+
+// Runs the same scoring and anchor queries against a Board and its StandardBoard copy.
+// Run from this directory so the board file can be found.
+template<class B>
+double time_queries(const B& board, const vector<Move>& moves, size_t rounds, size_t& checksum) {
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const Move& move : moves) {
+            PlaceResult result = board.test_place(move);
+            checksum += result.valid ? result.points : 1;
+        }
+        checksum += board.get_anchors().size();
+    }
+    chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> elapsed = stop - start;
+    return elapsed.count();
+}
+
+int main() {
+    Board board = Board::read("../config/standard-board.txt");
+    vector<TileKind> hello;
+    for (char letter : string("HELLO")) {
+        hello.push_back(TileKind(letter, 1));
+    }
+    board.place(Move(hello, 7, 5, Direction::ACROSS));
+    vector<TileKind> down;
+    for (char letter : string("AXE")) {
+        down.push_back(TileKind(letter, 2));
+    }
+    board.place(Move(down, 8, 8, Direction::DOWN));
+
+    // Three letter moves from every anchor
+    vector<Move> moves;
+    for (const Board::Anchor& anchor : board.get_anchors()) {
+        vector<TileKind> tiles;
+        for (char letter : string("SET")) {
+            tiles.push_back(TileKind(letter, 1));
+        }
+        moves.push_back(Move(tiles, anchor.position.row, anchor.position.column, anchor.direction));
+    }
+
+    const size_t rounds = 2000;
+    size_t board_checksum = 0;
+    size_t fixed_checksum = 0;
+    double board_time = time_queries(board, moves, rounds, board_checksum);
+    StandardBoard fixed(board);
+    double fixed_time = time_queries(fixed, moves, rounds, fixed_checksum);
+
+    cout << moves.size() << " moves and one get_anchors per round, " << rounds << " rounds" << endl;
+    cout << "Board:         " << board_time << " s" << endl;
+    cout << "StandardBoard: " << fixed_time << " s (" << board_time / fixed_time << "x)" << endl;
+    if (board_checksum != fixed_checksum) {
+        cout << "results differ!" << endl;
+        return 1;
+    }
+
+    // Whole move searches, which copy into a StandardBoard first
+    Dictionary dictionary = Dictionary::read("../config/english-dictionary.txt");
+    ComputerPlayer player("bench", 7);
+    TileBag bag = TileBag::read("../config/english-tile-bag.txt", 104);
+    player.add_tiles(bag.remove_random_tiles(7));
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    const size_t searches = 20;
+    for (size_t i = 0; i < searches; i++) {
+        player.get_move(board, dictionary);
+    }
+    chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> search_time = stop - start;
+    cout << "get_move: " << search_time.count() / searches * 1000 << " ms per search" << endl;
+
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "tile_bag.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+static bool same_move(const Move& a, const Move& b) {
+    if (a.kind != b.kind || a.row != b.row || a.column != b.column || a.direction != b.direction
+        || a.tiles.size() != b.tiles.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.tiles.size(); i++) {
+        if (!(a.tiles[i] == b.tiles[i]) || a.tiles[i].assigned != b.tiles[i].assigned) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Plays out a few games on the standard board, searching every position exhaustively and with branch and bound:
+// how many trie nodes the bound cuts, how much faster that is, and that both pick the same move.
+// Run from this directory so the config files can be found.
+int main() {
+    Dictionary dictionary = Dictionary::read("../config/english-dictionary.txt");
+    const ComputerPlayer::Deadline untimed = ComputerPlayer::Deadline::max();
+
+    size_t positions = 0;
+    size_t exhaustive_nodes = 0;
+    size_t pruned_nodes = 0;
+    size_t cut = 0;
+    double exhaustive_time = 0;
+    double pruned_time = 0;
+    for (uint32_t seed = 1; seed <= 4; seed++) {
+        Board board = Board::read("../config/standard-board.txt");
+        TileBag bag = TileBag::read("../config/english-tile-bag.txt", seed);
+        for (size_t turn = 0; turn < 12; turn++) {
+            ComputerPlayer cpu("cpu", 7);
+            cpu.add_tiles(bag.remove_random_tiles(7));
+
+            cpu.set_pruning(false);
+            chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+            ComputerPlayer::SearchResult exhaustive = cpu.get_move(board, dictionary, untimed);
+            chrono::high_resolution_clock::time_point middle = chrono::high_resolution_clock::now();
+            cpu.set_pruning(true);
+            ComputerPlayer::SearchResult pruned = cpu.get_move(board, dictionary, untimed);
+            chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+
+            if (!same_move(exhaustive.move, pruned.move)) {
+                cout << "seed " << seed << " turn " << turn << ": moves DIFFER" << endl;
+                return 1;
+            }
+            exhaustive_time += chrono::duration<double>(middle - start).count();
+            pruned_time += chrono::duration<double>(stop - middle).count();
+            exhaustive_nodes += exhaustive.nodes;
+            pruned_nodes += pruned.nodes;
+            cut += pruned.pruned;
+            positions++;
+
+            if (exhaustive.move.kind != MoveKind::PLACE) {
+                break;
+            }
+            board.place(exhaustive.move);
+        }
+    }
+
+    cout << positions << " positions, same moves with and without pruning" << endl;
+    cout << "exhaustive:       " << exhaustive_nodes / positions << " nodes, " << exhaustive_time / positions * 1000
+         << " ms per position" << endl;
+    cout << "branch and bound: " << pruned_nodes / positions << " nodes (" << cut / positions << " cut), "
+         << pruned_time / positions * 1000 << " ms per position" << endl;
+    cout << "pruning ratio " << 100.0 * (exhaustive_nodes - pruned_nodes) / exhaustive_nodes << "% of nodes, "
+         << exhaustive_time / pruned_time << "x faster" << endl;
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "board.h"
+#include "computer_player.h"
+#include "dictionary.h"
+#include "rack_inference.h"
+#include "tile_bag.h"
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+static const size_t HAND_SIZE = 7;
+static const size_t SAMPLES = 6;
+
+static void take(vector<TileKind>& rack, const vector<TileKind>& tiles) {
+    for (const TileKind& tile : tiles) {
+        for (size_t i = 0; i < rack.size(); i++) {
+            if (rack[i].letter == tile.letter) {
+                rack.erase(rack.begin() + i);
+                break;
+            }
+        }
+    }
+}
+
+// Mean probability the estimate gives each kind of tile the opponent really holds
+static double hit_rate(const RackInference& inference, const vector<TileKind>& rack) {
+    RackInference::Counts held = {};
+    size_t kinds = 0;
+    double total = 0;
+    for (const TileKind& tile : rack) {
+        if (held[RackInference::index_of(tile.letter)]++ == 0) {
+            total += inference.probability_of(tile.letter);
+            kinds++;
+        }
+    }
+    return kinds > 0 ? total / kinds : 0;
+}
+
+// Mean score of the best reply to racks sampled from the estimate
+static double predicted_reply(RackInference& inference, const Board& board, const Dictionary& dictionary) {
+    double total = 0;
+    for (size_t i = 0; i < SAMPLES; i++) {
+        ComputerPlayer cpu("sample", HAND_SIZE);
+        cpu.add_tiles(inference.sample_rack());
+        Move move = cpu.get_move(board, dictionary, chrono::steady_clock::now() + chrono::milliseconds(20)).move;
+        total += move.kind == MoveKind::PLACE ? board.test_place(move).points : 0;
+    }
+    return total / SAMPLES;
+}
+
+// Plays computer games between two players while the first one tracks the second's rack, once modeling the opponent
+// as keeping good leaves and once as only chasing points (which is what ComputerPlayer does): how long an update
+// takes, how likely each estimate finds the kinds of tiles the opponent really holds, and how close replies simulated
+// from sampled racks come to the real one. "unseen only" is a fresh estimate every turn, which knows which tiles are
+// unseen but nothing about the opponent's earlier moves.
+// Run from this directory so the config files can be found.
+int main() {
+    Dictionary dictionary = Dictionary::read("../config/english-dictionary.txt");
+
+    const char* names[3] = {"keeps leaves", "chases points", "unseen only"};
+    size_t updates = 0;
+    double update_time = 0;
+    double hits[3] = {};
+    double error[3] = {};
+    for (uint32_t seed = 1; seed <= 5; seed++) {
+        Board board = Board::read("../config/standard-board.txt");
+        TileBag bag = TileBag::read("../config/english-tile-bag.txt", seed);
+        const TileBag full_bag = bag;
+        vector<TileKind> racks[2] = {bag.remove_random_tiles(HAND_SIZE), bag.remove_random_tiles(HAND_SIZE)};
+        vector<RackInference> inferences(2, RackInference(full_bag, board, racks[0], HAND_SIZE, seed));
+        inferences[1].set_keep_weight(0);
+
+        size_t passes = 0;
+        for (size_t turn = 0; passes < 2 && !racks[0].empty() && !racks[1].empty(); turn++) {
+            size_t mover = turn % 2;
+            ComputerPlayer cpu("cpu", HAND_SIZE);
+            cpu.add_tiles(racks[mover]);
+            Move move = cpu.get_move(board, dictionary);
+
+            double predicted[3] = {};
+            if (mover == 1) {
+                inferences.push_back(RackInference(full_bag, board, racks[0], HAND_SIZE, seed + turn));
+                for (size_t i = 0; i < 3; i++) {
+                    predicted[i] = predicted_reply(inferences[i], board, dictionary);
+                    hits[i] += hit_rate(inferences[i], racks[1]);
+                }
+                inferences.pop_back();
+            }
+
+            vector<TileKind> drawn;
+            size_t points = 0;
+            if (move.kind == MoveKind::PASS) {
+                passes++;
+            } else {
+                passes = 0;
+                if (move.kind == MoveKind::PLACE) {
+                    points = board.place(move).points;
+                }
+                take(racks[mover], move.tiles);
+                drawn = bag.remove_random_tiles(move.tiles.size());
+                racks[mover].insert(racks[mover].end(), drawn.begin(), drawn.end());
+                if (move.kind == MoveKind::EXCHANGE) {
+                    for (const TileKind& tile : move.tiles) {
+                        bag.add_tiles(tile, 1);
+                    }
+                }
+            }
+
+            for (RackInference& inference : inferences) {
+                if (mover == 0) {
+                    inference.observe_own_draw(drawn);
+                    if (move.kind == MoveKind::EXCHANGE) {
+                        inference.observe_own_return(move.tiles);
+                    }
+                } else {
+                    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                    inference.observe_opponent(move);
+                    update_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                }
+            }
+            if (mover == 1) {
+                for (size_t i = 0; i < 3; i++) {
+                    error[i] += predicted[i] > points ? predicted[i] - points : points - predicted[i];
+                }
+                updates++;
+            }
+        }
+    }
+
+    cout << updates << " opponent moves, " << RackInference::DEFAULT_PARTICLES << " particles, "
+         << update_time / (2 * updates) * 1e6 << " us per update" << endl;
+    for (size_t i = 0; i < 3; i++) {
+        cout << names[i] << ": held tiles found with probability " << hits[i] / updates << ", reply score off by "
+             << error[i] / updates << " points" << endl;
+    }
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "board.h"
+#include "game_record.h"
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+// Times decoding a game record and rebuilding boards from it with GameReplay.
+// Run from this directory so the board file can be found.
+int main() {
+    Board initial = Board::read("../config/standard-board.txt");
+
+    // A synthetic game that fills the board with five letter words, three per row
+    GameRecord record;
+    record.seed = 54;
+    record.players = {"a", "b"};
+    size_t score = 0;
+    for (size_t row = 0; row < initial.rows; row++) {
+        for (size_t column = 0; column + 5 <= initial.columns; column += 5) {
+            vector<TileKind> tiles;
+            for (size_t i = 0; i < 5; i++) {
+                tiles.push_back(TileKind('a' + (row + column + i) % 26, 1));
+            }
+            score += 5;
+            Move move(tiles, row, column, Direction::ACROSS);
+            record.turns.push_back(GameRecord::Turn(record.turns.size() % 2, move, 5, score));
+        }
+    }
+
+    stringstream encoded;
+    record.write(encoded);
+    string bytes = encoded.str();
+    cout << record.turns.size() << " turns encode to " << bytes.size() << " bytes" << endl;
+
+    const size_t games = 20000;
+
+    // Decoding
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    size_t decoded_turns = 0;
+    for (size_t i = 0; i < games; i++) {
+        istringstream in(bytes);
+        decoded_turns += GameRecord::read(in).turns.size();
+    }
+    chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> decode_time = stop - start;
+    cout << "decode: " << decoded_turns / decode_time.count() / 1e6 << " million turns per second" << endl;
+
+    // Replaying every game from the empty board to the end
+    GameReplay replay(initial, record);
+    start = chrono::high_resolution_clock::now();
+    size_t replayed = 0;
+    for (size_t i = 0; i < games; i++) {
+        replay.seek(0);
+        while (replay.step()) {
+            replayed++;
+        }
+    }
+    stop = chrono::high_resolution_clock::now();
+    chrono::duration<double> replay_time = stop - start;
+    cout << "replay: " << replayed / replay_time.count() / 1e6 << " million moves per second" << endl;
+
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include "board.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+using namespace std;
+
+// Counts heap allocations so the benchmark can show how many each scoring call makes
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* memory = malloc(size)) {
+        return memory;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+
+void operator delete(void* memory, size_t) noexcept { free(memory); }
+
+// Scores the same candidate moves with test_place() and the allocation-free score_place().
+// Run from this directory so the board file can be found.
+int main() {
+    Board board = Board::read("../config/standard-board.txt");
+    vector<TileKind> hello;
+    for (char letter : string("HELLO")) {
+        hello.push_back(TileKind(letter, 1));
+    }
+    board.place(Move(hello, 7, 5, Direction::ACROSS));
+    vector<TileKind> down;
+    for (char letter : string("AXE")) {
+        down.push_back(TileKind(letter, 2));
+    }
+    board.place(Move(down, 8, 8, Direction::DOWN));
+
+    // Four letter moves from every anchor, valid or not
+    vector<Move> moves;
+    for (const Board::Anchor& anchor : board.get_anchors()) {
+        vector<TileKind> tiles;
+        for (char letter : string("RATE")) {
+            tiles.push_back(TileKind(letter, 1));
+        }
+        moves.push_back(Move(tiles, anchor.position.row, anchor.position.column, anchor.direction));
+    }
+
+    const size_t rounds = 5000;
+    size_t calls = rounds * moves.size();
+
+    size_t result_points = 0;
+    size_t before = allocations;
+    chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const Move& move : moves) {
+            PlaceResult result = board.test_place(move);
+            result_points += result.valid ? result.points : 0;
+        }
+    }
+    chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+    chrono::duration<double, nano> result_time = stop - start;
+    size_t result_allocations = allocations - before;
+
+    size_t score_points = 0;
+    before = allocations;
+    start = chrono::high_resolution_clock::now();
+    for (size_t round = 0; round < rounds; round++) {
+        for (const Move& move : moves) {
+            PlaceScore score = board.score_place(move);
+            score_points += score.valid() ? score.points : 0;
+        }
+    }
+    stop = chrono::high_resolution_clock::now();
+    chrono::duration<double, nano> score_time = stop - start;
+    size_t score_allocations = allocations - before;
+
+    cout << moves.size() << " candidate moves, " << rounds << " rounds" << endl;
+    cout << "test_place:  " << result_time.count() / calls << " ns, " << double(result_allocations) / calls
+         << " allocations per call" << endl;
+    cout << "score_place: " << score_time.count() / calls << " ns, " << double(score_allocations) / calls
+         << " allocations per call" << endl;
+    if (result_points != score_points) {
+        cout << "points differ!" << endl;
+        return 1;
+    }
+    return 0;
+}
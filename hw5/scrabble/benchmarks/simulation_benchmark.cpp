@@ -0,0 +1,42 @@
+#include "simulation.h"
+#include <chrono>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+// Plays the same batch of computer games on 1, 2 and 4 threads and checks the results match.
+// Run from this directory so the config files can be found.
+int main() {
+    auto dictionary = make_shared<const Dictionary>(Dictionary::read("../config/english-dictionary.txt"));
+    Simulation simulation(
+            dictionary,
+            Board::read("../tests/config/small-board.txt"),
+            TileBag::read("../tests/config/small-tile-bag.txt", 0),
+            7,
+            2,
+            2024);
+
+    const size_t games = 16;
+    vector<Simulation::Result> reference;
+    for (size_t threads = 1; threads <= 4; threads *= 2) {
+        chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+        vector<Simulation::Result> results = simulation.play_games(0, games, threads);
+        chrono::high_resolution_clock::time_point stop = chrono::high_resolution_clock::now();
+        chrono::duration<double> elapsed = stop - start;
+
+        bool same = true;
+        if (reference.empty()) {
+            reference = results;
+        }
+        for (size_t i = 0; i < games; i++) {
+            same = same && results[i].scores == reference[i].scores && results[i].turns == reference[i].turns;
+        }
+        cout << threads << " threads: " << games / elapsed.count() << " games per second, results "
+             << (same ? "identical" : "DIFFER") << endl;
+        if (!same) {
+            return 1;
+        }
+    }
+    return 0;
+}
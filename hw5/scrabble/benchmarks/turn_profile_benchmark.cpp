@@ -0,0 +1,57 @@
+#include "computer_player.h"
+#include "game_session.h"
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+// Plays one computer game on the standard board with profiling compiled in, prints where the turns spent their time
+// and writes turn_trace.json for chrome://tracing. Run from this directory so the config files can be found.
+int main() {
+    auto dictionary = make_shared<const Dictionary>(Dictionary::read("../config/english-dictionary.txt"));
+    GameSession session(
+            dictionary,
+            Board::read("../config/standard-board.txt"),
+            TileBag::read("../config/english-tile-bag.txt", 0),
+            7,
+            2024);
+    vector<shared_ptr<ComputerPlayer>> players;
+    for (size_t i = 0; i < 2; i++) {
+        players.push_back(make_shared<ComputerPlayer>("cpu" + to_string(i + 1), 7));
+        session.add_player(players.back());
+    }
+
+    vector<TurnProfile> turns;
+    TurnProfile total;
+    while (!session.is_over() && turns.size() < 20) {
+        session.play_turn();
+        // Whoever moved has the newest profile
+        const TurnProfile* latest = &players[0]->get_last_profile();
+        for (auto player : players) {
+            if (player->get_last_profile().start > latest->start) {
+                latest = &player->get_last_profile();
+            }
+        }
+        turns.push_back(*latest);
+        total.anchors_time += latest->anchors_time;
+        total.search_time += latest->search_time;
+        total.scoring_time += latest->scoring_time;
+        total.trie_nodes_visited += latest->trie_nodes_visited;
+        total.candidates += latest->candidates;
+        total.rejected += latest->rejected;
+        total.pruned += latest->pruned;
+    }
+
+    double n = turns.size();
+    cout << turns.size() << " turns, per turn:" << endl;
+    cout << "  anchors  " << total.anchors_time / n << " us" << endl;
+    cout << "  search   " << total.search_time / n << " us, " << total.trie_nodes_visited / n << " trie nodes, "
+         << total.pruned / n << " pruned" << endl;
+    cout << "  scoring  " << total.scoring_time / n << " us, " << total.candidates / n << " candidates, "
+         << total.rejected / n << " rejected" << endl;
+
+    ofstream trace("turn_trace.json");
+    write_chrome_trace(trace, turns);
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "board.h"
 
+#include "board_rules.h"
 #include "board_square.h"
 #include "exceptions.h"
 #include "formatting.h"
@@ -83,182 +84,98 @@ Board Board::read(const string& file_path) {
     return board;
 }
 
-size_t Board::get_move_index() const { return this->move_index; }
-
-// Testing a PLACE move
-PlaceResult Board::test_place(const Move& move) const {
-    // Set the starting position
-    Position starting_position(move.row, move.column);
-
-    // Check if the starting position has a tile
-    if (in_bounds_and_has_tile(starting_position)) {
-        return PlaceResult("Your starting position already has a tile on it!");
-    }
-
-    // Check to see if any tiles would be out of bound
-    Position moving_cursor = starting_position;
-    for (int i = 0; i < move.tiles.size();) {
-        if (in_bounds_and_has_tile(moving_cursor)) {
-            moving_cursor = moving_cursor.translate(move.direction);
-            continue;
-        }
-        if (is_in_bounds(moving_cursor) == false) {
-            return PlaceResult("One or more tiles is out of bounds!");
-        }
-        moving_cursor = moving_cursor.translate(move.direction);
-        i++;
+void Board::write_snapshot(string& out) const {
+    if (rows > 0xff || columns > 0xff || move_index > 0xffff) {
+        throw out_of_range("board is too large for a snapshot");
     }
-
-    // Check if the first move is on the start tile
-    moving_cursor = starting_position;
-    if (move_index == 0) {
-        bool on_start = false;
-        for (int i = 0; i < move.tiles.size(); i++) {
-            if (moving_cursor == start) {
-                on_start = true;
+    out.push_back(static_cast<char>(rows));
+    out.push_back(static_cast<char>(columns));
+    out.push_back(static_cast<char>(start.row));
+    out.push_back(static_cast<char>(start.column));
+    out.push_back(static_cast<char>(move_index & 0xff));
+    out.push_back(static_cast<char>(move_index >> 8));
+    out.append(2, '\0');
+
+    for (const vector<BoardSquare>& row : squares) {
+        for (const BoardSquare& square : row) {
+            out.push_back(static_cast<char>(square.letter_multiplier | square.word_multiplier << 4));
+            if (square.has_tile()) {
+                TileKind tile = square.get_tile_kind();
+                out.push_back(tile.letter);
+                out.push_back(tile.assigned);
+                out.push_back(static_cast<char>(tile.points));
+            } else {
+                out.append(3, '\0');
             }
-            moving_cursor = moving_cursor.translate(move.direction);
-        }
-        if (on_start != true) {
-            return PlaceResult("The first move must contain the start square!");
         }
     }
+}
 
-    // Check for at least one adjacent tile
-    moving_cursor = starting_position;
-    bool adjacent = false;
-    for (int i = 0; i < move.tiles.size(); i++) {
-        if (has_adjacent(moving_cursor) == true) {
-            adjacent = true;
-        }
-        moving_cursor = moving_cursor.translate(move.direction);
-    }
-    if (adjacent != true && move_index > 0) {
-        return PlaceResult("At least one tile must be adjacent to a previously placed tile!");
-    }
-
-    // Get the points and words
-    vector<string> words;
-    string word;
-    int word_points = 0;
-    int word_bonus = 1;
-    int total_points = 0;
-
-    // Start from the word
-    moving_cursor = starting_position;
-    for (int i = 0; i < move.tiles.size();) {
-
-        // Skip over occupied tiles
-        if (in_bounds_and_has_tile(moving_cursor)) {
-            word_points += at(moving_cursor).get_tile_kind().points;
-            word.push_back(at(moving_cursor).get_tile_kind().letter);
-            moving_cursor = moving_cursor.translate(move.direction);
-            continue;
-        }
-
-        Position running_cursor = moving_cursor;
+Board Board::read_snapshot(const BoardSnapshot& snapshot) {
+    Board board(
+            snapshot.get_rows(),
+            snapshot.get_columns(),
+            snapshot.get_start_row() + 1,
+            snapshot.get_start_column() + 1);
+    board.move_index = snapshot.get_move_index();
 
-        // Check is first letter is attached to anything
-        if (i == 0) {
-            while (in_bounds_and_has_tile(running_cursor.translate(move.direction, -1))) {
-                running_cursor = running_cursor.translate(move.direction, -1);
-            }
-            while (running_cursor != moving_cursor) {
-                word_points += at(running_cursor).get_tile_kind().points;
-                word += at(running_cursor).get_tile_kind().letter;
-                running_cursor = running_cursor.translate(move.direction);
+    for (size_t i = 0; i < board.rows; i++) {
+        vector<BoardSquare> row;
+        row.reserve(board.columns);
+        for (size_t j = 0; j < board.columns; j++) {
+            row.push_back(BoardSquare(snapshot.letter_multiplier(i, j), snapshot.word_multiplier(i, j)));
+            if (snapshot.has_tile(i, j)) {
+                row.back().set_tile_kind(snapshot.get_tile_kind(i, j));
+                board.mark_tile(i, j);
             }
         }
+        board.squares.push_back(row);
+    }
 
-        // Check if word creates any accidental words
-        running_cursor = moving_cursor;
-        if (has_adjacent(moving_cursor)
-            && (in_bounds_and_has_tile(moving_cursor.translate(!move.direction, -1))
-                || in_bounds_and_has_tile(moving_cursor.translate(!move.direction, 1)))) {
-            string accident_word;
-            int accident_points = 0;  // for each accident word
-            int accident_bonus = 1;
-            while (in_bounds_and_has_tile(running_cursor.translate(!move.direction, -1))) {
-                running_cursor = running_cursor.translate(!move.direction, -1);
-            }
-            while (in_bounds_and_has_tile(running_cursor) || running_cursor == moving_cursor) {
-
-                if (running_cursor == moving_cursor) {
-                    accident_points += move.tiles[i].points * at(moving_cursor).letter_multiplier;
-                    accident_bonus *= at(moving_cursor).word_multiplier;
-
-                    accident_word += move.tiles[i].letter;
+    return board;
+}
 
-                } else {
-                    accident_points += at(running_cursor).get_tile_kind().points;
-                    accident_word += at(running_cursor).get_tile_kind().letter;
-                }
-                running_cursor = running_cursor.translate(!move.direction);
-            }
+size_t Board::get_move_index() const { return this->move_index; }
 
-            if (accident_word.size() > 1) {
-                words.push_back(accident_word);
+// Testing a PLACE move
+PlaceResult Board::test_place(const Move& move) const {
+    return BoardRules::test_place(*this, move);
+}
 
-                accident_points *= accident_bonus;
-                total_points += accident_points;
+PlaceScore Board::score_place(const Move& move) const { return BoardRules::score_place(*this, move); }
 
-                accident_points = 0;
-            }
-        }
+// Placing a PLACE move
+PlaceResult Board::place(const Move& move) {
+    PlaceResult result = test_place(move);
 
-        // Iterate through word
-        word_points += move.tiles[i].points * at(moving_cursor).letter_multiplier;
-        word_bonus *= at(moving_cursor).word_multiplier;
+    if (result.valid == true) {
+        place_unchecked(move);
+    }
 
-        if (move.tiles[i].letter == '?') {
-            word += move.tiles[i].assigned;
-        } else {
-            word += move.tiles[i].letter;
-        }
+    return result;
+}
 
-        running_cursor = moving_cursor;
-        // Check if last letter is attached to anything
-        if (i == move.tiles.size() - 1) {
-            running_cursor = running_cursor.translate(move.direction);
-            while (in_bounds_and_has_tile(running_cursor)) {
-                word_points += at(running_cursor).get_tile_kind().points;
-                word += at(running_cursor).get_tile_kind().letter;
-                running_cursor = running_cursor.translate(move.direction);
-            }
+void Board::place_unchecked(const Move& move) {
+    // Traverse word
+    Position moving_cursor(move.row, move.column);
+    for (int i = 0; i < move.tiles.size();) {
+        if (in_bounds_and_has_tile(moving_cursor)) {
+            moving_cursor = moving_cursor.translate(move.direction);
+            continue;
         }
+        squares[moving_cursor.row][moving_cursor.column].set_tile_kind(move.tiles[i]);
+        mark_tile(moving_cursor.row, moving_cursor.column);
         moving_cursor = moving_cursor.translate(move.direction);
         i++;
     }
-
-    if (word.size() > 1) {
-        word_points *= word_bonus;
-        total_points += word_points;
-        words.push_back(word);
-    }
-
-    return PlaceResult(words, total_points);
+    move_index++;
 }
 
-// Placing a PLACE move
-PlaceResult Board::place(const Move& move) {
-    PlaceResult result = test_place(move);
-
-    if (result.valid == true) {
-        // Traverse word
-        Position moving_cursor(move.row, move.column);
-        for (int i = 0; i < move.tiles.size();) {
-            if (in_bounds_and_has_tile(moving_cursor)) {
-                moving_cursor = moving_cursor.translate(move.direction);
-                continue;
-            }
-            squares[moving_cursor.row][moving_cursor.column].set_tile_kind(move.tiles[i]);
-            moving_cursor = moving_cursor.translate(move.direction);
-            i++;
-        }
-        move_index++;
+void Board::mark_tile(size_t row, size_t column) {
+    if (!row_tiles.empty()) {
+        row_tiles[row] |= uint32_t(1) << column;
+        column_tiles[column] |= uint32_t(1) << row;
     }
-
-    return result;
 }
 
 // The rest of this file is provided for you. No need to make changes.
@@ -279,21 +196,18 @@ bool Board::in_bounds_and_has_tile(const Position& position) const {
 
 // Checks if a tile has at least one adjacent tile
 bool Board::has_adjacent(const Position& position) const {
-    Position down = position.translate(Direction::DOWN, 1);
-    Position up = position.translate(Direction::DOWN, -1);
-    Position right = position.translate(Direction::ACROSS, 1);
-    Position left = position.translate(Direction::ACROSS, -1);
-    return in_bounds_and_has_tile(down) || in_bounds_and_has_tile(up) || in_bounds_and_has_tile(right)
-           || in_bounds_and_has_tile(left);
+    return BoardRules::has_adjacent(*this, position);
 }
 
 char Board::letter_at(Position p) const { return at(p).get_tile_kind().letter; }
 
+char Board::word_letter_at(Position p) const {
+    TileKind tile = at(p).get_tile_kind();
+    return tile.letter == TileKind::BLANK_LETTER ? tile.assigned : tile.letter;
+}
+
 bool Board::is_anchor_spot(Position p) const {
-    if (is_in_bounds(p) && !at(p).has_tile() && (has_adjacent(p) || p == start)) {
-        return true;
-    }
-    return false;
+    return BoardRules::is_anchor_spot(*this, p);
 }
 
 vector<Board::Position> Board::find_open(const Position& position) const {
@@ -322,49 +236,10 @@ vector<Board::Position> Board::find_open(const Position& position) const {
 }
 
 std::vector<Board::Anchor> Board::get_anchors() const {
-    vector<Anchor> anchors;
-
-    // Scan the each square of the board
-    for (int i = 0; i < squares.size(); i++) {
-        for (int j = 0; j < squares[i].size(); j++) {
-            Position current(i, j);
-
-            // If the square has an adjacent square
-            if (is_anchor_spot(current)) {
-                // Across anchors
-                size_t limit = 0;
-                while (is_in_bounds(current.translate(Direction::ACROSS, -1))
-                       && !at(current.translate(Direction::ACROSS, -1)).has_tile()) {
-                    if (is_anchor_spot(current.translate(Direction::ACROSS, -1))) {
-                        break;
-                    }
-                    limit++;
-                    current = current.translate(Direction::ACROSS, -1);
-                }
-                current.row = i;
-                current.column = j;
-                Anchor across_anchor(current, Direction::ACROSS, limit);
-                anchors.push_back(across_anchor);
-
-                // Down anchors
-                limit = 0;
-                while (is_in_bounds(current.translate(Direction::DOWN, -1))
-                       && !at(current.translate(Direction::DOWN, -1)).has_tile()) {
-                    if (is_anchor_spot(current.translate(Direction::DOWN, -1))) {
-                        break;
-                    }
-                    limit++;
-                    current = current.translate(Direction::DOWN, -1);
-                }
-                current.row = i;
-                current.column = j;
-                Anchor down_anchor(current, Direction::DOWN, limit);
-                anchors.push_back(down_anchor);
-            }
-        }
+    if (row_tiles.empty()) {
+        return BoardRules::get_anchors(*this);
     }
-
-    return anchors;
+    return BoardRules::get_anchors_from_bits(*this);
 }
 
 void Board::print(ostream& out) const {
@@ -1,15 +1,22 @@
 #ifndef BOARD_H
 #define BOARD_H
 
+#include "board_snapshot.h"
 #include "board_square.h"
 #include "exceptions.h"
 #include "move.h"
 #include "place_result.h"
 #include "tile_kind.h"
+#include <cstdint>
 #include <ostream>
 #include <string>
 #include <vector>
 
+struct BoardRules;
+
+template<size_t R, size_t C>
+class FixedBoard;
+
 class Board {
 public:
     size_t rows;
@@ -39,6 +46,15 @@ public:
 
     static Board read(const std::string& file_path);  // Used for testing
 
+    /*
+    Appends a compact binary image of the board (multipliers, placed tiles, move index and start square) to out. See
+    BoardSnapshot for the layout. Throws std::out_of_range if the board is larger than 255 by 255.
+    */
+    void write_snapshot(std::string& out) const;
+
+    // Rebuilds a board from a snapshot written by write_snapshot().
+    static Board read_snapshot(const BoardSnapshot& snapshot);
+
     size_t get_move_index() const;
 
     /*
@@ -60,9 +76,22 @@ public:
     */
     PlaceResult test_place(const Move& move) const;
 
+    /*
+    The same checks and points as test_place(), without allocating: errors come back as a PlaceError and words as
+    spans into the board. For callers like ComputerPlayer that score many candidate moves; see BoardRules::span_word
+    to spell a word out.
+    */
+    PlaceScore score_place(const Move& move) const;
+
     PlaceResult place(const Move& move);  // Used for testing - remember that the move struct should use 0 based
                                           // indexing, NOT 1 based
 
+    /*
+    Puts the tiles of move on the board without checking or scoring it, skipping squares that already have a tile the
+    same way place() does. Only for moves that are already known to be valid, e.g. ones read back from a GameRecord.
+    */
+    void place_unchecked(const Move& move);
+
     void print(std::ostream& out) const;
 
     // Note: These methods have been made public
@@ -75,6 +104,12 @@ public:
     */
     char letter_at(Position p) const;
 
+    /*
+    Returns the letter the tile at p stands for in words: its own letter, or the assigned one if it is a blank.
+    Assumes there is a tile at p
+    */
+    char word_letter_at(Position p) const;
+
     /* HW5: IMPLEMENT THIS
     Returns bool indicating whether position p is an anchor spot or not.
 
@@ -96,9 +131,18 @@ public:
 
 protected:
     Board(size_t rows, size_t columns, size_t starting_row, size_t starting_column)
-            : rows(rows), columns(columns), start(starting_row - 1, starting_column - 1) {}
+            : rows(rows), columns(columns), start(starting_row - 1, starting_column - 1) {
+        if (rows <= MAX_BITBOARD_SIZE && columns <= MAX_BITBOARD_SIZE) {
+            row_tiles.resize(rows);
+            column_tiles.resize(columns);
+        }
+    }
 
 private:
+    friend struct BoardRules;
+    template<size_t R, size_t C>
+    friend class FixedBoard;
+
     BoardSquare& at(const Position& position);
     const BoardSquare& at(const Position& position) const;
 
@@ -110,6 +154,21 @@ private:
 
     std::vector<std::vector<BoardSquare>> squares;
     size_t move_index = 0;
+
+    /*
+    Occupancy bitboards: bit c of row_tiles[r] and bit r of column_tiles[c] are set when square (r, c) has a tile.
+    get_anchors() works on these a row at a time. Both are left empty on boards larger than MAX_BITBOARD_SIZE in
+    either direction, which fall back to checking squares one at a time.
+    */
+    static const size_t MAX_BITBOARD_SIZE = 32;
+    std::vector<uint32_t> row_tiles;
+    std::vector<uint32_t> column_tiles;
+
+    // Records a new tile at (row, column) in the bitboards
+    void mark_tile(size_t row, size_t column);
+
+    uint32_t row_bits(size_t row) const { return row_tiles[row]; }
+    uint32_t column_bits(size_t column) const { return column_tiles[column]; }
 };
 
 #endif
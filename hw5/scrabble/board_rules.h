@@ -0,0 +1,507 @@
+#ifndef BOARD_RULES_H
+#define BOARD_RULES_H
+
+#include "board.h"
+#include "move.h"
+#include "place_result.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ The placement and anchor rules of Board, written once for any board type so that the fixed size FixedBoard gets the
+ same behaviour with its geometry known at compile time.
+
+ A board type needs public rows, columns and start, get_move_index(), is_in_bounds(), in_bounds_and_has_tile() and
+ word_letter_at(), and an at(Position) (which may be private if the board is a friend of BoardRules) returning
+ something with letter_multiplier, word_multiplier, has_tile() and get_tile_kind().
+*/
+struct BoardRules {
+    // See Board::test_place. Scores with score_place() and spells out the words and error message.
+    template<class B>
+    static PlaceResult test_place(const B& board, const Move& move);
+
+    // See Board::score_place
+    template<class B>
+    static PlaceScore score_place(const B& board, const Move& move);
+
+    // What the squares from one square on can add at most to a move in one direction, for some number of extra tiles
+    struct Extension {
+        int word_points = 0;   // Letter points the squares add to the move's word, tiles on the board included
+        int word_bonus = 1;    // Product of the word multipliers under the extra tiles
+        int cross_points = 0;  // Points of the words the extra tiles make across the move
+        int tiles = 0;         // Extra tiles that fit
+    };
+
+    /*
+    Upper bounds on what extending a move in direction with up to extra_tiles more tiles, each worth at most
+    extra_points, can add to its score, for every square the extension could start at: entry
+    (row * columns + column) * (extra_tiles + 1) + count for count extra tiles. The tiles fill the empty squares of the
+    line in order, up to the first one whose checks (see ComputerPlayer::cross_checks) allow none of letters, since no
+    move can cover it, and the tiles already on the board up to there count as well.
+
+    A move whose own tiles have made word points w, word bonus b and cross points c before that square, counted as in
+    score_place(), scores at most c + cross_points + (w + word_points) * b * word_bonus with the extra tiles.
+    */
+    template<class B, class Extensions>
+    static void extension_bounds(
+            const B& board,
+            Direction direction,
+            size_t extra_tiles,
+            unsigned short extra_points,
+            const uint32_t* checks,
+            uint32_t letters,
+            Extensions& extensions);
+
+    /*
+    Adds a tile placed on square by a move in direction to the word points, word bonus and cross points the move has
+    made so far, as score_place() counts them
+    */
+    template<class B>
+    static void add_tile_points(
+            const B& board,
+            Board::Position square,
+            Direction direction,
+            const TileKind& tile,
+            int& word_points,
+            int& word_bonus,
+            int& cross_points);
+
+    // The points of the tile on square, which must have one
+    template<class B>
+    static unsigned short tile_points(const B& board, Board::Position square) {
+        return board.at(square).get_tile_kind().points;
+    }
+
+    // Spells out a word of a PlaceScore, taking letters from the board and from move's tiles
+    template<class B>
+    static std::string span_word(const B& board, const Move& move, const WordSpan& span);
+
+    // Checks if a tile has at least one adjacent tile
+    template<class B>
+    static bool has_adjacent(const B& board, const Board::Position& position);
+
+    // See Board::is_anchor_spot
+    template<class B>
+    static bool is_anchor_spot(const B& board, Board::Position p);
+
+    // See Board::get_anchors. Checks the board square by square.
+    template<class B>
+    static std::vector<Board::Anchor> get_anchors(const B& board);
+
+    /*
+    The same anchors, in the same order, as get_anchors(), computed from the board's occupancy bitboards: row_bits(r)
+    and column_bits(c) give the tiles of a row or column as a bit mask, and the board must be at most 32 squares in
+    each direction.
+
+    The anchors of a row are its empty squares next to a tile in the row itself (the row shifted left and right) or
+    in the rows above and below. An anchor's limit is the run of free squares before it, found from the highest set
+    bit of the occupied-or-anchor squares below it in its row (ACROSS) or column (DOWN).
+    */
+    template<class B>
+    static std::vector<Board::Anchor> get_anchors_from_bits(const B& board);
+
+    /*
+    A cheap guess at how much a move through anchor can score, for searching the promising anchors first: the letter
+    multipliers of the empty squares a move could cover, the points of the tiles among them and of the cross words
+    those squares would join, times the biggest word multiplier of the squares. The squares run from the tiles in
+    front of the anchor's limit to reach empty squares past the limit.
+    */
+    template<class B>
+    static int anchor_promise(const B& board, const Board::Anchor& anchor, size_t reach);
+
+private:
+    static const size_t MAX_BITS = 32;
+
+    // Number of free squares before position `index` in a line whose occupied-or-anchor squares are `blocked`
+    static size_t free_run(uint32_t blocked, size_t index);
+};
+
+template<class B>
+PlaceResult BoardRules::test_place(const B& board, const Move& move) {
+    PlaceScore score = score_place(board, move);
+    if (!score.valid()) {
+        return PlaceResult(place_error_message(score.error));
+    }
+
+    std::vector<std::string> words;
+    for (size_t i = 0; i < score.word_count && i < PlaceScore::MAX_WORDS; i++) {
+        words.push_back(span_word(board, move, score.words[i]));
+    }
+    return PlaceResult(words, score.points);
+}
+
+template<class B>
+PlaceScore BoardRules::score_place(const B& board, const Move& move) {
+    PlaceScore score;
+
+    // Set the starting position
+    Board::Position starting_position(move.row, move.column);
+
+    // Check if the starting position has a tile
+    if (board.in_bounds_and_has_tile(starting_position)) {
+        score.error = PlaceError::START_OCCUPIED;
+        return score;
+    }
+
+    // Check to see if any tiles would be out of bound
+    Board::Position moving_cursor = starting_position;
+    for (size_t i = 0; i < move.tiles.size();) {
+        if (board.in_bounds_and_has_tile(moving_cursor)) {
+            moving_cursor = moving_cursor.translate(move.direction);
+            continue;
+        }
+        if (!board.is_in_bounds(moving_cursor)) {
+            score.error = PlaceError::OUT_OF_BOUNDS;
+            return score;
+        }
+        moving_cursor = moving_cursor.translate(move.direction);
+        i++;
+    }
+
+    // Check if the first move is on the start tile
+    moving_cursor = starting_position;
+    if (board.get_move_index() == 0) {
+        bool on_start = false;
+        for (size_t i = 0; i < move.tiles.size(); i++) {
+            if (moving_cursor == board.start) {
+                on_start = true;
+            }
+            moving_cursor = moving_cursor.translate(move.direction);
+        }
+        if (!on_start) {
+            score.error = PlaceError::NOT_ON_START;
+            return score;
+        }
+    }
+
+    // Check for at least one adjacent tile
+    moving_cursor = starting_position;
+    bool adjacent = false;
+    for (size_t i = 0; i < move.tiles.size(); i++) {
+        if (has_adjacent(board, moving_cursor)) {
+            adjacent = true;
+        }
+        moving_cursor = moving_cursor.translate(move.direction);
+    }
+    if (!adjacent && board.get_move_index() > 0) {
+        score.error = PlaceError::NOT_ADJACENT;
+        return score;
+    }
+
+    // The main word starts at the first tile already on the board in front of the move, if any
+    Direction cross = !move.direction;
+    Board::Position word_start = starting_position;
+    while (board.in_bounds_and_has_tile(word_start.translate(move.direction, -1))) {
+        word_start = word_start.translate(move.direction, -1);
+    }
+
+    // Walk the main word: tiles already on the board count at face value, new tiles get the square's multipliers and
+    // may form a cross word
+    int word_points = 0;
+    int word_bonus = 1;
+    size_t word_length = 0;
+    size_t i = 0;
+    for (moving_cursor = word_start; i < move.tiles.size() || board.in_bounds_and_has_tile(moving_cursor);
+         moving_cursor = moving_cursor.translate(move.direction)) {
+        word_length++;
+        if (board.in_bounds_and_has_tile(moving_cursor)) {
+            word_points += board.at(moving_cursor).get_tile_kind().points;
+            continue;
+        }
+
+        const TileKind& tile = move.tiles[i++];
+        unsigned short letter_multiplier = board.at(moving_cursor).letter_multiplier;
+        unsigned short word_multiplier = board.at(moving_cursor).word_multiplier;
+        word_points += tile.points * letter_multiplier;
+        word_bonus *= word_multiplier;
+
+        // Check if the tile creates an accidental word across the main one
+        if (!board.in_bounds_and_has_tile(moving_cursor.translate(cross, -1))
+            && !board.in_bounds_and_has_tile(moving_cursor.translate(cross, 1))) {
+            continue;
+        }
+        Board::Position running_cursor = moving_cursor;
+        while (board.in_bounds_and_has_tile(running_cursor.translate(cross, -1))) {
+            running_cursor = running_cursor.translate(cross, -1);
+        }
+        WordSpan accident = {running_cursor.row, running_cursor.column, cross, 0};
+        int accident_points = 0;
+        for (; board.in_bounds_and_has_tile(running_cursor) || running_cursor == moving_cursor;
+             running_cursor = running_cursor.translate(cross)) {
+            if (running_cursor == moving_cursor) {
+                accident_points += tile.points * letter_multiplier;
+            } else {
+                accident_points += board.at(running_cursor).get_tile_kind().points;
+            }
+            accident.length++;
+        }
+        score.points += accident_points * word_multiplier;
+        score.add_word(accident);
+    }
+
+    if (word_length > 1) {
+        score.points += word_points * word_bonus;
+        score.add_word(WordSpan{word_start.row, word_start.column, move.direction, word_length});
+    }
+
+    return score;
+}
+
+template<class B, class Extensions>
+void BoardRules::extension_bounds(
+        const B& board,
+        Direction direction,
+        size_t extra_tiles,
+        unsigned short extra_points,
+        const uint32_t* checks,
+        uint32_t letters,
+        Extensions& extensions) {
+    const size_t stride = extra_tiles + 1;
+    extensions.assign(board.rows * board.columns * stride, Extension());
+    Direction cross = !direction;
+    // Backwards through the board, so the square after each one in direction is done before it
+    for (size_t index = board.rows * board.columns; index-- > 0;) {
+        Board::Position square(index / board.columns, index % board.columns);
+        Board::Position next = square.translate(direction);
+        const Extension* after
+                = board.is_in_bounds(next) ? &extensions[(next.row * board.columns + next.column) * stride] : nullptr;
+        Extension* here = &extensions[index * stride];
+        if (board.at(square).has_tile()) {
+            for (size_t count = 0; count <= extra_tiles; count++) {
+                if (after != nullptr) {
+                    here[count] = after[count];
+                }
+                here[count].word_points += board.at(square).get_tile_kind().points;
+            }
+            continue;
+        }
+        if (!(checks[index] & letters)) {
+            continue;
+        }
+
+        int cross_points = 0;
+        bool crossed = false;
+        for (int side = -1; side <= 1; side += 2) {
+            for (Board::Position p = square.translate(cross, side); board.in_bounds_and_has_tile(p);
+                 p = p.translate(cross, side)) {
+                cross_points += board.at(p).get_tile_kind().points;
+                crossed = true;
+            }
+        }
+        int tile_points = extra_points * board.at(square).letter_multiplier;
+        unsigned short word_multiplier = board.at(square).word_multiplier;
+        for (size_t count = 1; count <= extra_tiles; count++) {
+            if (after != nullptr) {
+                here[count] = after[count - 1];
+            }
+            here[count].word_points += tile_points;
+            here[count].word_bonus *= word_multiplier;
+            if (crossed) {
+                here[count].cross_points += (cross_points + tile_points) * word_multiplier;
+            }
+            here[count].tiles++;
+        }
+    }
+}
+
+template<class B>
+void BoardRules::add_tile_points(
+        const B& board,
+        Board::Position square,
+        Direction direction,
+        const TileKind& tile,
+        int& word_points,
+        int& word_bonus,
+        int& cross_points) {
+    Direction cross = !direction;
+    unsigned short letter_multiplier = board.at(square).letter_multiplier;
+    unsigned short word_multiplier = board.at(square).word_multiplier;
+    word_points += tile.points * letter_multiplier;
+    word_bonus *= word_multiplier;
+
+    int cross_word = 0;
+    bool crossed = false;
+    for (int side = -1; side <= 1; side += 2) {
+        for (Board::Position p = square.translate(cross, side); board.in_bounds_and_has_tile(p);
+             p = p.translate(cross, side)) {
+            cross_word += board.at(p).get_tile_kind().points;
+            crossed = true;
+        }
+    }
+    if (crossed) {
+        cross_points += (cross_word + tile.points * letter_multiplier) * word_multiplier;
+    }
+}
+
+template<class B>
+std::string BoardRules::span_word(const B& board, const Move& move, const WordSpan& span) {
+    std::string word;
+    Board::Position cursor(span.row, span.column);
+    for (size_t k = 0; k < span.length; k++, cursor = cursor.translate(span.direction)) {
+        if (board.in_bounds_and_has_tile(cursor)) {
+            word += board.word_letter_at(cursor);
+            continue;
+        }
+
+        // The move's tiles fill the empty squares of its line in order
+        size_t index = 0;
+        Board::Position square(move.row, move.column);
+        for (; square != cursor; square = square.translate(move.direction)) {
+            if (!board.in_bounds_and_has_tile(square)) {
+                index++;
+            }
+        }
+        const TileKind& tile = move.tiles[index];
+        word += tile.letter == TileKind::BLANK_LETTER ? tile.assigned : tile.letter;
+    }
+    return word;
+}
+
+template<class B>
+bool BoardRules::has_adjacent(const B& board, const Board::Position& position) {
+    Board::Position down = position.translate(Direction::DOWN, 1);
+    Board::Position up = position.translate(Direction::DOWN, -1);
+    Board::Position right = position.translate(Direction::ACROSS, 1);
+    Board::Position left = position.translate(Direction::ACROSS, -1);
+    return board.in_bounds_and_has_tile(down) || board.in_bounds_and_has_tile(up)
+           || board.in_bounds_and_has_tile(right) || board.in_bounds_and_has_tile(left);
+}
+
+template<class B>
+bool BoardRules::is_anchor_spot(const B& board, Board::Position p) {
+    if (board.is_in_bounds(p) && !board.at(p).has_tile() && (has_adjacent(board, p) || p == board.start)) {
+        return true;
+    }
+    return false;
+}
+
+template<class B>
+std::vector<Board::Anchor> BoardRules::get_anchors(const B& board) {
+    std::vector<Board::Anchor> anchors;
+
+    // Scan the each square of the board
+    for (size_t i = 0; i < board.rows; i++) {
+        for (size_t j = 0; j < board.columns; j++) {
+            Board::Position current(i, j);
+
+            // If the square has an adjacent square
+            if (is_anchor_spot(board, current)) {
+                // Across anchors
+                size_t limit = 0;
+                while (board.is_in_bounds(current.translate(Direction::ACROSS, -1))
+                       && !board.at(current.translate(Direction::ACROSS, -1)).has_tile()) {
+                    if (is_anchor_spot(board, current.translate(Direction::ACROSS, -1))) {
+                        break;
+                    }
+                    limit++;
+                    current = current.translate(Direction::ACROSS, -1);
+                }
+                current.row = i;
+                current.column = j;
+                Board::Anchor across_anchor(current, Direction::ACROSS, limit);
+                anchors.push_back(across_anchor);
+
+                // Down anchors
+                limit = 0;
+                while (board.is_in_bounds(current.translate(Direction::DOWN, -1))
+                       && !board.at(current.translate(Direction::DOWN, -1)).has_tile()) {
+                    if (is_anchor_spot(board, current.translate(Direction::DOWN, -1))) {
+                        break;
+                    }
+                    limit++;
+                    current = current.translate(Direction::DOWN, -1);
+                }
+                current.row = i;
+                current.column = j;
+                Board::Anchor down_anchor(current, Direction::DOWN, limit);
+                anchors.push_back(down_anchor);
+            }
+        }
+    }
+
+    return anchors;
+}
+
+template<class B>
+std::vector<Board::Anchor> BoardRules::get_anchors_from_bits(const B& board) {
+    const uint32_t row_mask = board.columns == MAX_BITS ? ~uint32_t(0) : (uint32_t(1) << board.columns) - 1;
+    uint32_t anchor_rows[MAX_BITS];
+    uint32_t anchor_columns[MAX_BITS] = {};
+    size_t count = 0;
+
+    for (size_t row = 0; row < board.rows; row++) {
+        uint32_t occupied = board.row_bits(row);
+        uint32_t neighbors = occupied << 1 | occupied >> 1;
+        if (row > 0) {
+            neighbors |= board.row_bits(row - 1);
+        }
+        if (row + 1 < board.rows) {
+            neighbors |= board.row_bits(row + 1);
+        }
+        if (row == board.start.row && board.start.column < board.columns) {
+            neighbors |= uint32_t(1) << board.start.column;
+        }
+        anchor_rows[row] = neighbors & ~occupied & row_mask;
+
+        for (uint32_t left = anchor_rows[row]; left != 0; left &= left - 1) {
+            anchor_columns[__builtin_ctz(left)] |= uint32_t(1) << row;
+            count++;
+        }
+    }
+
+    std::vector<Board::Anchor> anchors;
+    anchors.reserve(2 * count);
+    for (size_t row = 0; row < board.rows; row++) {
+        uint32_t blocked_row = board.row_bits(row) | anchor_rows[row];
+        for (uint32_t left = anchor_rows[row]; left != 0; left &= left - 1) {
+            size_t column = __builtin_ctz(left);
+            uint32_t blocked_column = board.column_bits(column) | anchor_columns[column];
+            Board::Position position(row, column);
+            anchors.push_back(Board::Anchor(position, Direction::ACROSS, free_run(blocked_row, column)));
+            anchors.push_back(Board::Anchor(position, Direction::DOWN, free_run(blocked_column, row)));
+        }
+    }
+
+    return anchors;
+}
+
+template<class B>
+int BoardRules::anchor_promise(const B& board, const Board::Anchor& anchor, size_t reach) {
+    int letters = 0;
+    int word_bonus = 1;
+    Board::Position cursor = anchor.position.translate(anchor.direction, -static_cast<ssize_t>(anchor.limit));
+    while (board.in_bounds_and_has_tile(cursor.translate(anchor.direction, -1))) {
+        cursor = cursor.translate(anchor.direction, -1);
+    }
+    for (size_t empty = 0; empty < anchor.limit + reach && board.is_in_bounds(cursor);
+         cursor = cursor.translate(anchor.direction)) {
+        if (board.at(cursor).has_tile()) {
+            letters += board.at(cursor).get_tile_kind().points;
+            continue;
+        }
+        unsigned short word_multiplier = board.at(cursor).word_multiplier;
+        letters += board.at(cursor).letter_multiplier;
+        // A tile here also scores the cross word it joins
+        for (int side = -1; side <= 1; side += 2) {
+            for (Board::Position p = cursor.translate(!anchor.direction, side); board.in_bounds_and_has_tile(p);
+                 p = p.translate(!anchor.direction, side)) {
+                letters += board.at(p).get_tile_kind().points * word_multiplier;
+            }
+        }
+        word_bonus = word_multiplier > word_bonus ? word_multiplier : word_bonus;
+        empty++;
+    }
+    return letters * word_bonus;
+}
+
+inline size_t BoardRules::free_run(uint32_t blocked, size_t index) {
+    uint32_t before = blocked & ((uint32_t(1) << index) - 1);
+    if (before == 0) {
+        return index;
+    }
+    // __builtin_clz counts leading zeros, so 31 - clz is the position of the nearest blocked square before index
+    return index - 1 - (31 - __builtin_clz(before));
+}
+
+#endif
@@ -0,0 +1,42 @@
+#include "board_snapshot.h"
+
+#include "exceptions.h"
+
+using namespace std;
+
+BoardSnapshot::BoardSnapshot(const char* data, size_t size) : data(reinterpret_cast<const unsigned char*>(data)) {
+    if (size < HEADER_SIZE || size < size_for(get_rows(), get_columns())) {
+        throw FileException("truncated board snapshot!");
+    }
+}
+
+size_t BoardSnapshot::size_for(size_t rows, size_t columns) { return HEADER_SIZE + rows * columns * SQUARE_SIZE; }
+
+size_t BoardSnapshot::get_rows() const { return data[0]; }
+
+size_t BoardSnapshot::get_columns() const { return data[1]; }
+
+size_t BoardSnapshot::get_start_row() const { return data[2]; }
+
+size_t BoardSnapshot::get_start_column() const { return data[3]; }
+
+size_t BoardSnapshot::get_move_index() const { return data[4] | static_cast<size_t>(data[5]) << 8; }
+
+size_t BoardSnapshot::size() const { return size_for(get_rows(), get_columns()); }
+
+unsigned short BoardSnapshot::letter_multiplier(size_t row, size_t column) const {
+    return square(row, column)[0] & 0x0f;
+}
+
+unsigned short BoardSnapshot::word_multiplier(size_t row, size_t column) const { return square(row, column)[0] >> 4; }
+
+bool BoardSnapshot::has_tile(size_t row, size_t column) const { return square(row, column)[1] != 0; }
+
+TileKind BoardSnapshot::get_tile_kind(size_t row, size_t column) const {
+    const unsigned char* bytes = square(row, column);
+    return TileKind(bytes[1], bytes[3], bytes[2]);
+}
+
+const unsigned char* BoardSnapshot::square(size_t row, size_t column) const {
+    return data + HEADER_SIZE + (row * get_columns() + column) * SQUARE_SIZE;
+}
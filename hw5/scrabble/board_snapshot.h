@@ -0,0 +1,49 @@
+#ifndef BOARD_SNAPSHOT_H
+#define BOARD_SNAPSHOT_H
+
+#include "tile_kind.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/*
+ Read-only view of a board written by Board::write_snapshot. The view does not copy the bytes, so it can look at
+ snapshots inside a memory-mapped PositionCorpus directly; the bytes must outlive the view.
+
+ Binary layout:
+     header  u8 rows, u8 columns, u8 start row, u8 start column, u16 move index (little endian), u16 reserved
+     squares row by row, 4 bytes each: u8 letter multiplier | word multiplier << 4, u8 letter (0 when empty),
+             u8 assigned letter, u8 tile points
+*/
+class BoardSnapshot {
+public:
+    static const size_t HEADER_SIZE = 8;
+    static const size_t SQUARE_SIZE = 4;
+
+    // Throws a FileException if data is too short for the board its header describes.
+    BoardSnapshot(const char* data, size_t size);
+
+    // Number of bytes a snapshot of a board with these dimensions takes
+    static size_t size_for(size_t rows, size_t columns);
+
+    size_t get_rows() const;
+    size_t get_columns() const;
+    size_t get_start_row() const;
+    size_t get_start_column() const;
+    size_t get_move_index() const;
+    size_t size() const;
+
+    unsigned short letter_multiplier(size_t row, size_t column) const;
+    unsigned short word_multiplier(size_t row, size_t column) const;
+    bool has_tile(size_t row, size_t column) const;
+
+    // Assumes there is a tile at (row, column)
+    TileKind get_tile_kind(size_t row, size_t column) const;
+
+private:
+    const unsigned char* data;
+
+    const unsigned char* square(size_t row, size_t column) const;
+};
+
+#endif
@@ -1,33 +1,64 @@
 
 #include "computer_player.h"
 
+#include "exchange_evaluator.h"
+#include "fixed_board.h"
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <string>
 
 using namespace std;
 
+template<class B>
 void ComputerPlayer::left_part(
         Board::Position anchor_pos,
-        std::string partial_word,
-        Move partial_move,
-        std::shared_ptr<Dictionary::TrieNode> node,
+        std::string& partial_word,
+        Move& partial_move,
+        const Dictionary::TrieNode* node,
         size_t limit,
         TileCollection& remaining_tiles,
-        std::vector<Move>& legal_moves,
-        const Board& board) const {
+        const B& board,
+        Search& search) const {
+    // The prefix's squares depend on how long it ends up, so it is only pruned once extend_right has placed it
+    if (search.out_of_time()) {
+        return;
+    }
+    PROFILE_ONLY(last_profile.trie_nodes_visited++; last_profile.count_visit(partial_word.size());)
 
     // Call extend_right on empty prefix
-    extend_right(anchor_pos, partial_word, partial_move, node, remaining_tiles, legal_moves, board);
+    if (partial_word.size() >= search.shortest_prefix) {
+        ssize_t prefix = partial_move.tiles.size();
+        Board::Position start = anchor_pos.translate(partial_move.direction, -prefix);
+        partial_move.row = start.row;
+        partial_move.column = start.column;
+        if (search.pruning) {
+            // The prefix fills the free squares in front of the anchor
+            search.word_points = 0;
+            search.word_bonus = 1;
+            search.cross_points = 0;
+            for (size_t i = 0; i < partial_move.tiles.size(); i++) {
+                BoardRules::add_tile_points(
+                        board,
+                        start.translate(partial_move.direction, i),
+                        partial_move.direction,
+                        partial_move.tiles[i],
+                        search.word_points,
+                        search.word_bonus,
+                        search.cross_points);
+            }
+        }
+        extend_right(anchor_pos, partial_word, partial_move, node, remaining_tiles, board, search);
+    }
     // Base case
-    if (limit == 0) {
+    if (limit == 0 || partial_word.size() >= search.longest_prefix) {
         return;
     }
     // Search all edges of root
+    TileKind found('\0', 0);
     for (auto itr = node->nexts.begin(); itr != node->nexts.end(); itr++) {
-        try {
-            // If you one edge matches something in your hand
-            TileKind found = remaining_tiles.lookup_tile(itr->first);
+        // If you one edge matches something in your hand
+        if (remaining_tiles.find_tile(itr->first, found)) {
             remaining_tiles.remove_tile(found);
             partial_word.push_back(found.letter);
             partial_move.tiles.push_back(found);
@@ -39,23 +70,20 @@ void ComputerPlayer::left_part(
                     itr->second,
                     limit - 1,
                     remaining_tiles,
-                    legal_moves,
-                    board);
+                    board,
+                    search);
 
             partial_word.pop_back();
             partial_move.tiles.pop_back();
             remaining_tiles.add_tile(found);
-        } catch (out_of_range& e) {
         }
         // If any children are in your hands
-        try {
-            TileKind found = remaining_tiles.lookup_tile('?');
+        if (remaining_tiles.find_tile(TileKind::BLANK_LETTER, found)) {
             remaining_tiles.remove_tile(found);
 
-            partial_word.push_back(itr->first);   // a
-            partial_move.tiles.push_back(found);  //?
+            partial_word.push_back(itr->first);
+            partial_move.tiles.push_back(TileKind(found.letter, found.points, itr->first));
 
-            // extend_right(anchor_pos, partial_word, partial_move, itr->second, remaining_tiles, legal_moves, board);
             left_part(
                     anchor_pos,
                     partial_word,
@@ -63,177 +91,455 @@ void ComputerPlayer::left_part(
                     itr->second,
                     limit - 1,
                     remaining_tiles,
-                    legal_moves,
-                    board);
+                    board,
+                    search);
 
             partial_word.pop_back();
             partial_move.tiles.pop_back();
 
             remaining_tiles.add_tile(found);
-
-        } catch (out_of_range& e) {
         }
     }
 }
 
+template<class B>
 void ComputerPlayer::extend_right(
         Board::Position square,
-        std::string partial_word,
-        Move partial_move,
-        std::shared_ptr<Dictionary::TrieNode> node,
+        std::string& partial_word,
+        Move& partial_move,
+        const Dictionary::TrieNode* node,
         TileCollection& remaining_tiles,
-        std::vector<Move>& legal_moves,
-        const Board& board) const {
-
-    // Is prefix valid word?
-    if (node->is_final) {
-        //        partial_move.row = square.row;
-        //        partial_move.column = square.column;
-        legal_moves.push_back(partial_move);
+        const B& board,
+        Search& search) const {
+    if (search.out_of_time() || !can_beat_best(partial_move, square, node->longest, board, search)) {
+        return;
+    }
+    PROFILE_ONLY(last_profile.trie_nodes_visited++; last_profile.count_visit(partial_word.size());)
+
+    // Is prefix valid word? It has to have gone past the anchor, so it has placed a tile there, and end before an
+    // empty square. A single tile that makes a word across is only placed ACROSS, so it is not found twice.
+    if (node->is_final && square != search.anchor_square && partial_word.size() > 1
+        && !board.in_bounds_and_has_tile(square)
+        && !(partial_move.direction == Direction::DOWN && partial_move.tiles.size() == 1
+             && (board.in_bounds_and_has_tile(search.anchor_square.translate(Direction::ACROSS, -1))
+                 || board.in_bounds_and_has_tile(search.anchor_square.translate(Direction::ACROSS, 1))))) {
+        add_candidate(partial_move, board, search);
     }
     // Base case
     if (!board.is_in_bounds(square)) {
         return;
     }
 
+    Board::Position next = square.translate(partial_move.direction);
+
     // If square is vacant
     if (!board.in_bounds_and_has_tile(square)) {
-        // Position gets bigger and bigger each recursion
+        const uint32_t* checks = partial_move.direction == Direction::DOWN ? search.down_checks : search.across_checks;
+        uint32_t allowed = checks[square.row * board.columns + square.column];
 
+        TileKind found('\0', 0);
         for (auto itr = node->nexts.begin(); itr != node->nexts.end(); itr++) {
-            try {
-                // If you one edge matches something in your hand
-                TileKind found = remaining_tiles.lookup_tile(itr->first);
+            if (itr->first < 'a' || itr->first > 'z' || !(allowed >> (itr->first - 'a') & 1)) {
+                continue;
+            }
+            // If you one edge matches something in your hand
+            if (remaining_tiles.find_tile(itr->first, found)) {
                 remaining_tiles.remove_tile(found);
                 partial_word.push_back(found.letter);
                 partial_move.tiles.push_back(found);
 
-                if (partial_move.direction == Direction::DOWN) {
-                    square.row += 1;
-                    extend_right(square, partial_word, partial_move, itr->second, remaining_tiles, legal_moves, board);
-                } else {
-                    square.column += 1;
-                    extend_right(square, partial_word, partial_move, itr->second, remaining_tiles, legal_moves, board);
-                }
+                place_and_extend(square, next, partial_word, partial_move, itr->second, remaining_tiles, board, search);
 
                 partial_word.pop_back();
                 partial_move.tiles.pop_back();
                 remaining_tiles.add_tile(found);
-            } catch (out_of_range& e) {
             }
             // If any children are in your hands
-            try {
-                TileKind found = remaining_tiles.lookup_tile('?');
+            if (remaining_tiles.find_tile(TileKind::BLANK_LETTER, found)) {
                 remaining_tiles.remove_tile(found);
 
-                partial_word.push_back(itr->first);   // a
-                partial_move.tiles.push_back(found);  //?
+                partial_word.push_back(itr->first);
+                partial_move.tiles.push_back(TileKind(found.letter, found.points, itr->first));
 
-                if (partial_move.direction == Direction::DOWN) {
-                    square.row += 1;
-                    extend_right(square, partial_word, partial_move, itr->second, remaining_tiles, legal_moves, board);
-                } else {
-                    square.column += 1;
-                    extend_right(square, partial_word, partial_move, itr->second, remaining_tiles, legal_moves, board);
-                }
+                place_and_extend(square, next, partial_word, partial_move, itr->second, remaining_tiles, board, search);
 
                 partial_word.pop_back();
                 partial_move.tiles.pop_back();
 
                 remaining_tiles.add_tile(found);
-
-            } catch (out_of_range& e) {
             }
         }
 
     } else {
-        char letter = board.letter_at(square);
-        if (node->nexts.find(letter) != node->nexts.end()) {
+        char letter = board.word_letter_at(square);
+        auto itr = node->nexts.find(letter);
+        if (itr != node->nexts.end()) {
             partial_word.push_back(letter);
-            if (partial_move.direction == Direction::DOWN) {
-                square.row += 1;
-                extend_right(
-                        square,
-                        partial_word,
-                        partial_move,
-                        node->nexts.find(letter)->second,
-                        remaining_tiles,
-                        legal_moves,
-                        board);
-            } else {
-                square.column += 1;
-                extend_right(
-                        square,
-                        partial_word,
-                        partial_move,
-                        node->nexts.find(letter)->second,
-                        remaining_tiles,
-                        legal_moves,
-                        board);
-            }
+            int word_points = search.word_points;
+            search.word_points += BoardRules::tile_points(board, square);
+            extend_right(next, partial_word, partial_move, itr->second, remaining_tiles, board, search);
+            search.word_points = word_points;
+            partial_word.pop_back();
         }
     }
 }
 
+template<class B>
+void ComputerPlayer::place_and_extend(
+        Board::Position square,
+        Board::Position next,
+        std::string& partial_word,
+        Move& partial_move,
+        const Dictionary::TrieNode* node,
+        TileCollection& remaining_tiles,
+        const B& board,
+        Search& search) const {
+    if (!search.pruning) {
+        extend_right(next, partial_word, partial_move, node, remaining_tiles, board, search);
+        return;
+    }
+    int word_points = search.word_points;
+    int word_bonus = search.word_bonus;
+    int cross_points = search.cross_points;
+    BoardRules::add_tile_points(
+            board,
+            square,
+            partial_move.direction,
+            partial_move.tiles.back(),
+            search.word_points,
+            search.word_bonus,
+            search.cross_points);
+    extend_right(next, partial_word, partial_move, node, remaining_tiles, board, search);
+    search.word_points = word_points;
+    search.word_bonus = word_bonus;
+    search.cross_points = cross_points;
+}
+
 Move ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary) const {
-    std::vector<Move> legal_moves;
-    std::vector<Board::Anchor> anchors = board.get_anchors();
+    return get_move(board, dictionary, Deadline::max()).move;
+}
 
-    for (int i = 0; i < anchors.size(); i++) {
-        if (anchors[i].limit > 0) {
-            Move blank_move({}, anchors[i].position.row, anchors[i].position.column, anchors[i].direction);
-            TileCollection copy_tiles = tiles;
-            left_part(
-                    anchors[i].position,
-                    "",
-                    blank_move,
-                    dictionary.get_root(),
-                    anchors[i].limit,
-                    copy_tiles,
-                    legal_moves,
-                    board);
+ComputerPlayer::SearchResult
+ComputerPlayer::get_move(const Board& board, const Dictionary& dictionary, Deadline deadline) const {
+    PROFILE_ONLY(last_profile = TurnProfile(); last_profile.player = get_name();)
+    PROFILE_ONLY(last_profile.start = TurnProfile::now();)
+
+    Search search;
+    search.rack = tiles;
+    search.partial.kind = MoveKind::PLACE;
+    search.timed = deadline != Deadline::max();
+    search.deadline = deadline;
+    search.pruning = pruning;
+
+    // Boards with the standard layout are searched through the fixed size copy; custom layouts use the Board itself
+    SearchResult result = StandardBoard::matches(board) ? find_move(StandardBoard(board), dictionary, search)
+                                                        : find_move(board, dictionary, search);
+    if (exchanges) {
+        result.move = consider_exchange(board, result.move, result.points);
+        if (result.move.kind != MoveKind::PLACE) {
+            result.points = 0;
         }
-        if (anchors[i].limit == 0) {
-            TileCollection copy_tiles = tiles;
-            string partial_word = "";
-
-            auto moving_cursor = anchors[i].position;
-            while (board.in_bounds_and_has_tile(moving_cursor)) {
-                moving_cursor = moving_cursor.translate(anchors[i].direction, -1);
-                partial_word = board.letter_at(moving_cursor) + partial_word;
-            }
-            Move blank_move({}, anchors[i].position.row, anchors[i].position.column, anchors[i].direction);
+    }
+    return result;
+}
 
-            extend_right(
-                    anchors[i].position,
-                    partial_word,
-                    blank_move,
-                    dictionary.find_prefix(partial_word),
-                    copy_tiles,
-                    legal_moves,
-                    board);
+std::vector<Move> ComputerPlayer::get_moves(const Board& board, const Dictionary& dictionary) const {
+    std::vector<Move> moves;
+    Search search;
+    search.rack = tiles;
+    search.partial.kind = MoveKind::PLACE;
+    search.pruning = false;
+    search.moves = &moves;
+    if (StandardBoard::matches(board)) {
+        find_move(StandardBoard(board), dictionary, search);
+    } else {
+        find_move(board, dictionary, search);
+    }
+    return moves;
+}
+
+void ComputerPlayer::enable_exchanges(const TileBag& full_bag) {
+    distribution = {};
+    for (const auto& kind : full_bag.get_kinds()) {
+        size_t index = LeaveTable::index_of(kind.second.letter);
+        if (index < LeaveTable::KINDS) {
+            distribution[index] += full_bag.count_tiles(kind.second);
         }
     }
-    return get_best_move(legal_moves, board, dictionary);
+    exchanges = true;
+}
+
+Move ComputerPlayer::consider_exchange(const Board& board, const Move& move, unsigned int points) const {
+    vector<TileKind> rack = tiles.list_tiles();
+    if (rack.empty() || rack.size() > ExchangeEvaluator::MAX_TILES) {
+        return move;
+    }
+
+    LeaveTable::Counts unseen = distribution;
+    LeaveTable::Counts seen = LeaveTable::count(rack);
+    for (size_t row = 0; row < board.rows; row++) {
+        for (size_t column = 0; column < board.columns; column++) {
+            Board::Position position(row, column);
+            if (board.in_bounds_and_has_tile(position)) {
+                size_t index = LeaveTable::index_of(board.letter_at(position));
+                if (index < LeaveTable::KINDS) {
+                    seen[index]++;
+                }
+            }
+        }
+    }
+    size_t unseen_total = 0;
+    for (size_t index = 0; index < LeaveTable::KINDS; index++) {
+        unseen[index] = seen[index] < unseen[index] ? unseen[index] - seen[index] : 0;
+        unseen_total += unseen[index];
+    }
+    if (unseen_total < EXCHANGE_RACKS * get_hand_size()) {
+        return move;
+    }
+
+    // A placement is worth its points plus what it keeps and draws; passing keeps everything and draws nothing
+    ExchangeEvaluator evaluator(rack, unseen);
+    uint32_t keep = move.kind == MoveKind::PLACE ? evaluator.keep_after(move.tiles) : evaluator.all();
+    uint32_t exchange = evaluator.best_exchange();
+    if (evaluator.equity(exchange) <= points + evaluator.equity(keep)) {
+        return move;
+    }
+    return Move(evaluator.tiles_outside(exchange));
 }
 
-Move ComputerPlayer::get_best_move(
-        std::vector<Move> legal_moves, const Board& board, const Dictionary& dictionary) const {
-    Move best_move = Move();  // Pass if no move found
+template<class B>
+ComputerPlayer::SearchResult
+ComputerPlayer::find_move(const B& board, const Dictionary& dictionary, Search& search) const {
+    PROFILE_ONLY(last_profile.begin(last_profile.anchors_start);)
+    std::vector<Board::Anchor> anchors = board.get_anchors();
+    ScratchVector<uint32_t> across_checks = cross_checks(board, dictionary, Direction::ACROSS, search.scratch);
+    ScratchVector<uint32_t> down_checks = cross_checks(board, dictionary, Direction::DOWN, search.scratch);
+    search.across_checks = across_checks.data();
+    search.down_checks = down_checks.data();
+
+    // The order only matters when a good move found early saves work, by pruning or before the deadline
+    ScratchVector<size_t> order(ArenaAllocator<size_t>(search.scratch));
+    if (search.pruning || search.timed) {
+        order = order_anchors(board, anchors, search.scratch);
+    } else {
+        for (size_t i = 0; i < anchors.size(); i++) {
+            order.push_back(i);
+        }
+    }
 
-    int max_points = 0;
-    for (int i = 0; i < legal_moves.size(); i++) {
+    ScratchVector<BoardRules::Extension> across_extensions(ArenaAllocator<BoardRules::Extension>(search.scratch));
+    ScratchVector<BoardRules::Extension> down_extensions(ArenaAllocator<BoardRules::Extension>(search.scratch));
+    if (search.pruning) {
+        // Any tile left on the rack is worth at most the rack's best and is one of its letters
+        search.rack_size = search.rack.count_tiles();
+        unsigned short points = search.rack.max_points();
+        uint32_t letters = search.rack.letter_mask();
+        BoardRules::extension_bounds(
+                board, Direction::ACROSS, search.rack_size, points, search.across_checks, letters, across_extensions);
+        BoardRules::extension_bounds(
+                board, Direction::DOWN, search.rack_size, points, search.down_checks, letters, down_extensions);
+        search.across_extensions = across_extensions.data();
+        search.down_extensions = down_extensions.data();
+    }
+    PROFILE_ONLY(last_profile.end(last_profile.anchors_start, last_profile.anchors_time);)
+    PROFILE_ONLY(last_profile.anchors = anchors.size(); last_profile.begin(last_profile.search_start);)
+
+    SearchResult result;
+    result.anchors = anchors.size();
+    result.anchors_searched = 0;
+    // Untimed searches go through each anchor once. Timed ones go through all anchors with the cheap short prefixes
+    // before any long ones, since the cost of an anchor grows quickly with the prefixes it tries.
+    const size_t passes = search.timed ? PREFIX_PASSES : 1;
+    for (size_t pass = 0; pass < passes && !search.expired; pass++) {
+        if (search.timed) {
+            search.shortest_prefix = pass == 0 ? 0 : PASS_PREFIX[pass - 1] + 1;
+            search.longest_prefix = pass + 1 == passes ? SIZE_MAX : PASS_PREFIX[pass];
+        }
+        for (size_t i : order) {
+            const Board::Anchor& anchor = anchors[i];
+            if (search.shortest_prefix > anchor.limit) {
+                continue;
+            }
+            if (search.timed && (search.expired || std::chrono::steady_clock::now() >= search.deadline)) {
+                search.expired = true;
+                break;
+            }
+            search.anchor = i;
+            search.anchor_square = anchor.position;
+            search_anchor(anchor, dictionary, board, search);
+            if (!search.expired && anchor.limit <= search.longest_prefix) {
+                result.anchors_searched++;
+            }
+        }
+    }
+    PROFILE_ONLY(last_profile.end(last_profile.search_start, last_profile.search_time);)
+    PROFILE_ONLY(last_profile.search_time -= last_profile.scoring_time;)
+
+    result.complete = result.anchors_searched == anchors.size();
+    result.move = search.has_best ? search.best : Move();  // Pass if no move found
+    result.points = search.has_best ? search.best_points : 0;
+    result.nodes = search.nodes;
+    result.pruned = search.pruned;
+    return result;
+}
 
-        PlaceResult result = board.test_place(legal_moves[i]);
-        // If you used all 7 tiles, you get a bonus 50 points
-        if (legal_moves[i].tiles.size() == get_hand_size()) {
-            result.points += 50;
+template<class B>
+void ComputerPlayer::search_anchor(
+        const Board::Anchor& anchor, const Dictionary& dictionary, const B& board, Search& search) const {
+    // The partial word and move start out empty for every anchor; left_part and extend_right leave them that way
+    search.partial.row = anchor.position.row;
+    search.partial.column = anchor.position.column;
+    search.partial.direction = anchor.direction;
+    if (anchor.limit > 0) {
+        left_part(
+                anchor.position,
+                search.word,
+                search.partial,
+                dictionary.root_node(),
+                anchor.limit,
+                search.rack,
+                board,
+                search);
+    }
+    if (anchor.limit == 0) {
+        // The word starts with the tiles already on the board in front of the anchor, if there are any
+        auto moving_cursor = anchor.position.translate(anchor.direction, -1);
+        search.word_points = 0;
+        search.word_bonus = 1;
+        search.cross_points = 0;
+        while (board.in_bounds_and_has_tile(moving_cursor)) {
+            search.word_points += BoardRules::tile_points(board, moving_cursor);
+            search.word.insert(search.word.begin(), board.word_letter_at(moving_cursor));
+            moving_cursor = moving_cursor.translate(anchor.direction, -1);
         }
-        if (result.points >= max_points) {
-            max_points = result.points;
-            best_move = legal_moves[i];
+        const Dictionary::TrieNode* node = dictionary.find_node(search.word);
+
+        if (node != nullptr) {
+            extend_right(anchor.position, search.word, search.partial, node, search.rack, board, search);
         }
+        search.word.clear();
     }
+}
 
-    return best_move;
+template<class B>
+ComputerPlayer::ScratchVector<uint32_t>
+ComputerPlayer::cross_checks(const B& board, const Dictionary& dictionary, Direction direction, Arena& scratch) const {
+    const uint32_t all_letters = (uint32_t(1) << 26) - 1;
+    Direction cross = !direction;
+    ScratchVector<uint32_t> checks(board.rows * board.columns, all_letters, ArenaAllocator<uint32_t>(scratch));
+    std::string before;
+    for (size_t row = 0; row < board.rows; row++) {
+        for (size_t column = 0; column < board.columns; column++) {
+            Board::Position square(row, column);
+            uint32_t& allowed = checks[row * board.columns + column];
+            if (board.in_bounds_and_has_tile(square)) {
+                allowed = 0;
+                continue;
+            }
+            Board::Position after = square.translate(cross, 1);
+            if (!board.in_bounds_and_has_tile(square.translate(cross, -1)) && !board.in_bounds_and_has_tile(after)) {
+                continue;
+            }
+
+            // Follow the tiles before the square down the trie, then try each letter with the tiles after it
+            before.clear();
+            for (Board::Position p = square.translate(cross, -1); board.in_bounds_and_has_tile(p);
+                 p = p.translate(cross, -1)) {
+                before.insert(before.begin(), board.word_letter_at(p));
+            }
+            allowed = 0;
+            const Dictionary::TrieNode* node = dictionary.find_node(before);
+            if (node == nullptr) {
+                continue;
+            }
+            for (const auto& edge : node->nexts) {
+                if (edge.first < 'a' || edge.first > 'z') {
+                    continue;
+                }
+                const Dictionary::TrieNode* word = edge.second;
+                for (Board::Position p = after; word != nullptr && board.in_bounds_and_has_tile(p);
+                     p = p.translate(cross)) {
+                    auto next = word->nexts.find(board.word_letter_at(p));
+                    word = next == word->nexts.end() ? nullptr : next->second;
+                }
+                if (word != nullptr && word->is_final) {
+                    allowed |= uint32_t(1) << (edge.first - 'a');
+                }
+            }
+        }
+    }
+    return checks;
+}
+
+template<class B>
+ComputerPlayer::ScratchVector<size_t>
+ComputerPlayer::order_anchors(const B& board, const std::vector<Board::Anchor>& anchors, Arena& scratch) const {
+    ScratchVector<int> promise(anchors.size(), ArenaAllocator<int>(scratch));
+    ScratchVector<size_t> order(anchors.size(), ArenaAllocator<size_t>(scratch));
+    for (size_t i = 0; i < anchors.size(); i++) {
+        promise[i] = BoardRules::anchor_promise(board, anchors[i], count_tiles());
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return promise[a] > promise[b]; });
+    return order;
+}
+
+template<class B>
+void ComputerPlayer::add_candidate(const Move& move, const B& board, Search& search) const {
+    PROFILE_ONLY(last_profile.candidates++;)
+
+    // Only validity and points are needed here, so skip building the words
+    PROFILE_ONLY(double scoring_start = TurnProfile::now();)
+    PlaceScore result = board.score_place(move);
+    PROFILE_ONLY(last_profile.add(scoring_start, last_profile.scoring_start, last_profile.scoring_time);)
+    if (!result.valid()) {
+        PROFILE_ONLY(last_profile.rejected++;)
+        return;
+    }
+    // If you used all 7 tiles, you get a bonus 50 points
+    if (move.tiles.size() == get_hand_size()) {
+        result.points += 50;
+    }
+    if (search.moves != nullptr) {
+        search.moves->push_back(move);
+    }
+    // An exhaustive search over the anchors in board order keeps the last of the highest scoring moves
+    if (!search.has_best || result.points > search.best_points
+        || (result.points == search.best_points && search.anchor >= search.best_anchor)) {
+        search.has_best = true;
+        search.best = move;
+        search.best_points = result.points;
+        search.best_anchor = search.anchor;
+    }
+}
+
+template<class B>
+bool ComputerPlayer::can_beat_best(
+        const Move& partial_move, Board::Position square, size_t max_tiles, const B& board, Search& search) const {
+    if (!search.pruning || !search.has_best) {
+        return true;
+    }
+    // Past the edge of the board nothing more fits
+    BoardRules::Extension rest;
+    if (board.is_in_bounds(square)) {
+        const BoardRules::Extension* extensions
+                = partial_move.direction == Direction::DOWN ? search.down_extensions : search.across_extensions;
+        size_t index = square.row * board.columns + square.column;
+        size_t count = std::min(search.rack_size - partial_move.tiles.size(), max_tiles);
+        rest = extensions[index * (search.rack_size + 1) + count];
+    }
+    int bound = search.cross_points + rest.cross_points
+                + (search.word_points + rest.word_points) * search.word_bonus * rest.word_bonus;
+    // The bonus needs the whole rack, with room for it before the cross checks stop the extension
+    if (partial_move.tiles.size() + rest.tiles >= get_hand_size()) {
+        bound += 50;
+    }
+    // Moves from earlier anchors lose ties, moves found later from the same anchor or later ones win them
+    if (bound > static_cast<int>(search.best_points)
+        || (bound == static_cast<int>(search.best_points) && search.anchor >= search.best_anchor)) {
+        return true;
+    }
+    search.pruned++;
+    PROFILE_ONLY(last_profile.pruned++;)
+    return false;
 }
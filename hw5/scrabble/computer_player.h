@@ -1,12 +1,32 @@
 #ifndef COMPUTER_PLAYER_H
 #define COMPUTER_PLAYER_H
 
+#include "arena.h"
+#include "board_rules.h"
+#include "leave_table.h"
 #include "move.h"
 #include "player.h"
+#include "tile_bag.h"
+#include "turn_profile.h"
+#include <chrono>
+#include <cstdint>
 #include <memory>
 
 class ComputerPlayer : public Player {
 public:
+    typedef std::chrono::steady_clock::time_point Deadline;
+
+    // What a get_move() with a deadline found
+    struct SearchResult {
+        Move move;
+        unsigned int points;      // What move scores
+        bool complete;            // Whether every anchor was searched before the deadline
+        size_t anchors_searched;  // Anchors searched to the end
+        size_t anchors;
+        size_t nodes;   // Calls of left_part and extend_right
+        size_t pruned;  // Of those, the ones cut because their moves could not beat the best move so far
+    };
+
     /* HW5: DECLARE AND IMPLEMENT THIS
     Should have one parameterized constructor that takes a string name (const reference) and a size_t hand size.
     */
@@ -17,78 +37,255 @@ public:
         https://www.cs.cmu.edu/afs/cs/academic/class/15451-s06/www/lectures/scrabble.pdf
 
     See assignment for more details.
+
+    The anchors are searched most promising first (see BoardRules::anchor_promise) and partial moves that cannot score
+    more than the best move found so far are not extended (see BoardRules::extension_bounds). Neither changes the
+    result: it is the move an exhaustive search picks, the last of the highest scoring ones in board order.
     */
     Move get_move(const Board& board, const Dictionary& dictionary) const override;  // Used For Testing
 
+    /*
+    The same search, stopped at deadline; a deadline of Deadline::max() searches exactly like get_move(board,
+    dictionary). Otherwise every anchor is first searched with short prefixes, which are cheap, then with longer ones,
+    so the best move found so far comes from as much of the board as possible. It is returned, or a pass if there is
+    none.
+
+    When the search completes, the move scores the same as get_move(board, dictionary), though ties between equal
+    scoring moves may be broken differently since each anchor is searched in several passes.
+    */
+    SearchResult get_move(const Board& board, const Dictionary& dictionary, Deadline deadline) const;
+
+    /*
+    Every valid placement of the rack's tiles, each exactly once: no two of the moves are equal (see operator== for
+    Move). The search makes every placement from only one anchor, its first one in reading order, and a one tile
+    placement in only one direction, ACROSS if it makes a word across and DOWN otherwise.
+    */
+    std::vector<Move> get_moves(const Board& board, const Dictionary& dictionary) const;
+
+    /*
+    Lets get_move() exchange tiles when keeping part of the rack and drawing the rest is worth more than its best
+    placement, or than passing when there is none (see ExchangeEvaluator). full_bag is the game's bag before any tiles
+    were drawn; with the board and the rack it tells which tiles are unseen.
+    */
+    void enable_exchanges(const TileBag& full_bag);
+
+    // Turns the pruning of get_move() off to search exhaustively, in board order, for checking and benchmarking it
+    void set_pruning(bool enabled) { pruning = enabled; }
+
     bool is_human() const { return false; }
 
+#ifdef SCRABBLE_PROFILE
+    // Counters and phase times of the latest get_move() call
+    const TurnProfile& get_last_profile() const { return last_profile; }
+#endif
+
     //~ComputerPlayer(){};
 
 private:
+#ifdef SCRABBLE_PROFILE
+    mutable TurnProfile last_profile;
+#endif
+
+    bool pruning = true;
+
+    template<class T>
+    using ScratchVector = std::vector<T, ArenaAllocator<T>>;
+
+    // Tiles of each kind in the whole game, once exchanges are enabled
+    bool exchanges = false;
+    LeaveTable::Counts distribution = {};
+
+    // The bag cannot be seen, so exchanging needs enough unseen tiles for this many racks: an opponent's and a full one
+    // in the bag
+    static constexpr size_t EXCHANGE_RACKS = 2;
+
+    // A timed search makes one pass over the anchors per prefix length band: the longest prefix of each pass but the
+    // last, which takes the rest
+    static constexpr size_t PASS_PREFIX[] = {0, 2};
+    static constexpr size_t PREFIX_PASSES = 3;
+
+    // The state of one search: when to stop, and the best move so far. A default Search never runs out of time.
+    struct Search {
+        // Trie nodes between looks at the clock
+        static const unsigned CHECK_INTERVAL = 16;
+
+        // Scratch space for the search's tables, freed with it, so concurrent get_move() calls share nothing
+        Arena scratch;
+
+        bool timed = false;
+        Deadline deadline;
+        bool expired = false;
+
+        // left_part only extends prefixes of this many tiles, for searching short prefixes of every anchor first
+        size_t shortest_prefix = 0;
+        size_t longest_prefix = SIZE_MAX;
+
+        bool pruning = true;
+
+        // The rack and the partial word and move that left_part and extend_right work on, shared by all anchors
+        TileCollection rack;
+        std::string word;
+        Move partial;
+
+        size_t anchor = 0;  // Board order index of the anchor being searched, which breaks ties between moves
+        Board::Position anchor_square = Board::Position(0, 0);
+
+        // The letters each square allows, from cross_checks(), for moves ACROSS and DOWN
+        const uint32_t* across_checks = nullptr;
+        const uint32_t* down_checks = nullptr;
+
+        // When pruning, the bounds on extending a move from each square with up to rack_size tiles, from
+        // BoardRules::extension_bounds(), for moves ACROSS and DOWN
+        size_t rack_size = 0;
+        const BoardRules::Extension* across_extensions = nullptr;
+        const BoardRules::Extension* down_extensions = nullptr;
+
+        // What the tiles of the partial move have scored up to the square extend_right is at, as score_place()
+        // counts it, kept up to date as tiles are placed and taken back when pruning
+        int word_points = 0;
+        int word_bonus = 1;
+        int cross_points = 0;
+
+        // When set, every valid move found is added here as well
+        std::vector<Move>* moves = nullptr;
+
+        bool has_best = false;
+        Move best;
+        unsigned int best_points = 0;
+        size_t best_anchor = 0;
+
+        size_t nodes = 0;
+        size_t pruned = 0;
+
+        // Counts a node, looking at the clock every CHECK_INTERVAL of them
+        bool out_of_time() {
+            if (++nodes % CHECK_INTERVAL == 0 && timed && !expired) {
+                expired = std::chrono::steady_clock::now() >= deadline;
+            }
+            return expired;
+        }
+    };
+
     // The following functions may be modified in any way.
     // e.g. You may decide you'd prefer to pass in a Dictionary reference rather than
     // std::shared_ptr<Dictionary::TrieNode>
 
     /*
-    Searches all possible prefixes of size up to limit and calls extend_right for each one
+    Searches all possible prefixes of size up to limit and calls extend_right for each one. A prefix of k tiles goes on
+    the k squares before the anchor, which are neither anchors nor next to any tile, so it makes no cross words.
 
     anchor: The board position for the anchor square
     partial_word: the partial word that has already been searched
     partial_move: the Move object associated with the partial word (has tiles for each letter in partial_word)
+        partial_word and partial_move are passed by reference like remaining_tiles and are left as they were found
     node: The node in the Dictionary associated with partial_word
     limit: The max prefix size to consider
     remaining_tiles: The tiles that can still be used to form a move
         Passed by reference
         Tiles should be removed when every searching forward on that tile
         Tiles should be put back in remaining_tiles when backtracking
-    legal_moves: A vector that accumulates Moves that create a valid word
-        Note: Does not necessarily need to check perpendicular words while searching
-              but it can if you prefer.
     board: a reference to the scrabble board
+    search: keeps the best move found, and stops the search once it runs out of time
     */
     // call recursive with limit = limit -1
+    // The board functions are templates so they can run on a FixedBoard as well as a Board.
+    template<class B>
     void left_part(
             Board::Position anchor_pos,
-            std::string partial_word,  // ""
-            Move partial_move,         // move = anchor_pos
-            std::shared_ptr<Dictionary::TrieNode> node,
+            std::string& partial_word,  // ""
+            Move& partial_move,         // move = anchor_pos
+            const Dictionary::TrieNode* node,
             size_t limit,
             TileCollection& remaining_tiles,  // hand
-            std::vector<Move>& legal_moves,
-            const Board& board) const;
+            const B& board,
+            Search& search) const;
 
     /*
     Given a square (not necessarily an anchor square) and a prefix finds all legal ways to extend the word to make valid
-    words.
+    words. Tiles only go where the cross checks allow them, and a word only counts once it covers the anchor, has at
+    least two letters and ends on an empty square.
 
     square: The board position to search from
     partial_word: the partial word that has already been formed
     partial_move: the Move object associated with the partial word
         (has tiles for each letter in partial_word, unless that tile was already on the board)
+        partial_word and partial_move are passed by reference like remaining_tiles and are left as they were found
     node: The node in the Dictionary associated with partial_word
     remaining_tiles: The tiles that can still be used to form a move
         Passed by reference
         Tiles should be removed when every searching forward on that tile
         Tiles should be put back in remaining_tiles when backtracking
-    legal_moves: A vector that accumulates Moves that create a valid word
-        Note: Does not necessarily need to check perpendicular words while searching
-              but it can if you prefer.
     board: a reference to the scrabble board
+    search: keeps the best move found, and stops the search once it runs out of time
     */
+    template<class B>
     void extend_right(
             Board::Position square,
-            std::string partial_word,
-            Move partial_move,
-            std::shared_ptr<Dictionary::TrieNode> node,
+            std::string& partial_word,
+            Move& partial_move,
+            const Dictionary::TrieNode* node,
+            TileCollection& remaining_tiles,
+            const B& board,
+            Search& search) const;
+
+    /*
+    For each square of the board, by row * columns + column, the letters that can go there in a move in direction:
+    bit letter - 'a' is set when the word the letter would make across the move is in the dictionary, or when there
+    is no such word. Squares with a tile allow nothing.
+    */
+    template<class B>
+    ScratchVector<uint32_t>
+    cross_checks(const B& board, const Dictionary& dictionary, Direction direction, Arena& scratch) const;
+
+    /*
+    Scores a move the search found and keeps it if it is the best so far: the highest scoring valid move, ties going
+    to the move from the later anchor in board order, or the later one from the same anchor
+    */
+    template<class B>
+    void add_candidate(const Move& move, const B& board, Search& search) const;
+
+    // extend_right() from next after the last tile of partial_move was placed on square, keeping the score so far
+    template<class B>
+    void place_and_extend(
+            Board::Position square,
+            Board::Position next,
+            std::string& partial_word,
+            Move& partial_move,
+            const Dictionary::TrieNode* node,
             TileCollection& remaining_tiles,
-            std::vector<Move>& legal_moves,
-            const Board& board) const;
+            const B& board,
+            Search& search) const;
 
     /*
-    Searches the vector of legal moves for the highest scoring move
-    Ties broken arbitrarily
+    Whether some move extending partial_move from square on with at most max_tiles more tiles, such as the letters
+    the dictionary has left after the partial word, might still become the best move
     */
-    Move get_best_move(std::vector<Move> legal_moves, const Board& board, const Dictionary& dictionary) const;
+    template<class B>
+    bool can_beat_best(
+            const Move& partial_move, Board::Position square, size_t max_tiles, const B& board, Search& search) const;
+
+    /*
+    get_move() for a board of type B, after get_move() has picked the fastest board type for the layout. A timed
+    search also stops between or inside anchors when it runs out of time.
+    */
+    template<class B>
+    SearchResult find_move(const B& board, const Dictionary& dictionary, Search& search) const;
+
+    // The best placement found, which scores points, or an exchange if that is worth more
+    Move consider_exchange(const Board& board, const Move& move, unsigned int points) const;
+
+    // Runs left_part or extend_right from one anchor
+    template<class B>
+    void search_anchor(
+            const Board::Anchor& anchor,
+            const Dictionary& dictionary,
+            const B& board,
+            Search& search) const;
+
+    // The order to search the anchors in, most promising first
+    template<class B>
+    ScratchVector<size_t>
+    order_anchors(const B& board, const std::vector<Board::Anchor>& anchors, Arena& scratch) const;
 };
 
 #endif
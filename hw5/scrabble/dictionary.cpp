@@ -9,6 +9,9 @@
 
 using namespace std;
 
+// The trie of a full dictionary takes tens of megabytes, so it is carved out of large blocks
+static const size_t TRIE_BLOCK_SIZE = 1024 * 1024;
+
 
 string lower(string str) {
     transform(str.cbegin(), str.cend(), str.begin(), ::tolower);
@@ -24,7 +27,8 @@ Dictionary Dictionary::read(const std::string& file_path) {
     }
     std::string word;
     Dictionary dictionary;
-    dictionary.root = make_shared<TrieNode>();
+    dictionary.arena = make_shared<Arena>(TRIE_BLOCK_SIZE);
+    dictionary.root = dictionary.arena->make<TrieNode>(*dictionary.arena);
 
     while (!file.eof()) {
         file >> word;
@@ -40,7 +44,7 @@ Dictionary Dictionary::read(const std::string& file_path) {
 
 
 bool Dictionary::is_word(const string& word) const {
-    shared_ptr<TrieNode> cur = find_prefix(word);
+    const TrieNode* cur = find_node(word);
     if (cur == nullptr)
         return false;
     // HW5: IMPLEMENT HERE
@@ -53,8 +57,17 @@ bool Dictionary::is_word(const string& word) const {
 }
 
 
-shared_ptr<Dictionary::TrieNode> Dictionary::find_prefix(const string& prefix) const { //bat
-    shared_ptr<TrieNode> cur = root;
+shared_ptr<Dictionary::TrieNode> Dictionary::find_prefix(const string& prefix) const {
+    const TrieNode* node = find_node(prefix);
+    if (node == nullptr) {
+        return nullptr;
+    }
+    return shared_ptr<TrieNode>(arena, const_cast<TrieNode*>(node));
+}
+
+
+const Dictionary::TrieNode* Dictionary::find_node(const string& prefix) const { //bat
+    const TrieNode* cur = root;
     // This is a for each loop in C++. It is equivalent to the following:
     // for (int i = 0; i < prefix.length(); i++) {
     //      char letter = prefix[i];
@@ -74,10 +87,12 @@ shared_ptr<Dictionary::TrieNode> Dictionary::find_prefix(const string& prefix) c
 
 // Implemented for you to build the dictionary trie
 void Dictionary::add_word(const string& word) {
-    shared_ptr<TrieNode> cur = root;
+    TrieNode* cur = root;
+    size_t remaining = word.size();
     for (char letter : word) {
+        cur->longest = std::max<size_t>(cur->longest, remaining--);
         if (cur->nexts.find(letter) == cur->nexts.end()) {
-            cur->nexts.insert({letter, make_shared<TrieNode>()});
+            cur->nexts.insert({letter, arena->make<TrieNode>(*arena)});
         }
         cur = cur->nexts.find(letter)->second;
     }
@@ -86,7 +101,7 @@ void Dictionary::add_word(const string& word) {
 
 
 vector<char> Dictionary::next_letters(const std::string& prefix) const { //act
-    shared_ptr<TrieNode> cur = find_prefix(prefix); //t
+    const TrieNode* cur = find_node(prefix); //t
     vector<char> nexts;
     if (cur == nullptr)
         return nexts;
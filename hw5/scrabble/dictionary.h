@@ -1,6 +1,7 @@
 #ifndef DICTIONARY_H
 #define DICTIONARY_H
 
+#include "arena.h"
 #include <unordered_set>
 #include <string>
 #include <map>
@@ -11,12 +12,19 @@
 
 class Dictionary {
 public:
+    // The nodes and their maps live in the dictionary's arena and are freed with it, all at once
     struct TrieNode {
+        typedef std::map<char, TrieNode*, std::less<char>, ArenaAllocator<std::pair<const char, TrieNode*>>> Nexts;
+
+        explicit TrieNode(Arena& arena) : nexts(Nexts::allocator_type(arena)) {}
+
         // when a node in trie is created 
         // initialized to not be for a valid word
         // in the dictionary
         bool is_final = false;
-        std::map<char, std::shared_ptr<TrieNode>> nexts;
+        // Letters the longest word through this node has after it, which bounds how far a move can extend it
+        unsigned short longest = 0;
+        Nexts nexts;
     };
 
     /*
@@ -41,7 +49,10 @@ public:
     /*
     Returns root
     */
-    std::shared_ptr<TrieNode> get_root() const {return root;}; // Used for testing
+    std::shared_ptr<TrieNode> get_root() const {return std::shared_ptr<TrieNode>(arena, root);}; // Used for testing
+
+    // The root without shared ownership, for searches that walk the trie many times a turn
+    const TrieNode* root_node() const { return root; }
 
     /*
     This function returns the node associated with prefix.
@@ -55,8 +66,13 @@ public:
     */
     std::shared_ptr<TrieNode> find_prefix(const std::string& prefix) const; // Used for testing
 
+    // find_prefix() without shared ownership
+    const TrieNode* find_node(const std::string& prefix) const;
+
 private:
-    std::shared_ptr<TrieNode> root;
+    // Shared by copies of the dictionary, which all use the same trie
+    std::shared_ptr<Arena> arena;
+    TrieNode* root = nullptr;
 
     void add_word(const std::string& word);
 };
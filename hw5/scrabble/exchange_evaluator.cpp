@@ -0,0 +1,139 @@
+#include "exchange_evaluator.h"
+
+#include <cmath>
+#include <stdexcept>
+
+using namespace std;
+
+ExchangeEvaluator::ExchangeEvaluator(const vector<TileKind>& rack, const LeaveTable::Counts& unseen) : rack(rack) {
+    if (rack.size() > MAX_TILES) {
+        throw invalid_argument("rack too large to evaluate exchanges");
+    }
+    const size_t masks = size_t(1) << rack.size();
+    const size_t kinds = LeaveTable::KINDS;
+
+    vector<size_t> index(rack.size());
+    for (size_t i = 0; i < rack.size(); i++) {
+        index[i] = LeaveTable::index_of(rack[i].letter);
+    }
+
+    // Each unseen kind's share of the draws, and the share of vowels among the drawn vowels and consonants
+    vector<size_t> drawable;
+    vector<double> share;
+    size_t unseen_total = 0;
+    size_t unseen_vowels = 0;
+    size_t unseen_consonants = 0;
+    for (size_t kind = 0; kind < kinds; kind++) {
+        unseen_total += unseen[kind];
+        unseen_vowels += LeaveTable::is_vowel(kind) ? unseen[kind] : 0;
+        unseen_consonants += LeaveTable::is_consonant(kind) ? unseen[kind] : 0;
+    }
+    for (size_t kind = 0; kind < kinds && unseen_total > 0; kind++) {
+        if (unseen[kind] > 0) {
+            drawable.push_back(kind);
+            share.push_back(static_cast<double>(unseen[kind]) / unseen_total);
+        }
+    }
+    double vowel_share = unseen_vowels + unseen_consonants > 0
+                                 ? static_cast<double>(unseen_vowels) / (unseen_vowels + unseen_consonants)
+                                 : 0;
+
+    // How many of n draws come up with a kind, or a vowel: binomial[n][i][x] is the chance that x of n draws are the
+    // i-th drawable kind, the last entry standing for vowels. Drawing with replacement is close enough for a bag.
+    const size_t n_max = rack.size();
+    vector<vector<vector<double>>> binomial(n_max + 1, vector<vector<double>>(drawable.size() + 1));
+    for (size_t n = 0; n <= n_max; n++) {
+        for (size_t i = 0; i <= drawable.size(); i++) {
+            double p = i < drawable.size() ? share[i] : vowel_share;
+            vector<double>& chances = binomial[n][i];
+            chances.assign(n + 1, 0);
+            if (p >= 1) {
+                chances[n] = 1;
+                continue;
+            }
+            chances[0] = pow(1 - p, n);
+            for (size_t x = 0; x < n; x++) {
+                chances[x + 1] = chances[x] * (n - x) / (x + 1) * p / (1 - p);
+            }
+        }
+    }
+
+    // Per mask: the tiles of each kind it keeps, the sum of their kind values, and its vowels and consonants
+    vector<LeaveTable::Counts> counts(masks);
+    vector<double> kind_sums(masks);
+    vector<uint8_t> vowels(masks);
+    vector<uint8_t> consonants(masks);
+    counts[0] = {};
+    kind_sums[0] = 0;
+    vowels[0] = 0;
+    consonants[0] = 0;
+    leaves.resize(masks);
+    draws.resize(masks);
+    for (uint32_t mask = 0; mask < masks; mask++) {
+        if (mask != 0) {
+            size_t tile = __builtin_ctz(mask);
+            uint32_t rest = mask & (mask - 1);
+            size_t kind = index[tile];
+            counts[mask] = counts[rest];
+            kind_sums[mask] = kind_sums[rest];
+            vowels[mask] = vowels[rest];
+            consonants[mask] = consonants[rest];
+            if (kind < kinds) {
+                kind_sums[mask] += LeaveTable::kind_value(kind, counts[mask][kind] + 1)
+                                   - LeaveTable::kind_value(kind, counts[mask][kind]);
+                counts[mask][kind]++;
+                vowels[mask] += LeaveTable::is_vowel(kind);
+                consonants[mask] += LeaveTable::is_consonant(kind);
+            }
+        }
+        double balance = LeaveTable::balance_value(vowels[mask], consonants[mask]);
+        leaves[mask] = kind_sums[mask] + balance;
+
+        // The expected change in each kind's value and in the balance once the drawn tiles join the kept ones
+        size_t drawn = rack.size() - __builtin_popcount(mask);
+        double gain = 0;
+        for (size_t i = 0; i < drawable.size() && drawn > 0; i++) {
+            size_t kind = drawable[i];
+            size_t held = counts[mask][kind];
+            const vector<double>& chances = binomial[drawn][i];
+            for (size_t x = 1; x <= drawn; x++) {
+                gain += chances[x] * (LeaveTable::kind_value(kind, held + x) - LeaveTable::kind_value(kind, held));
+            }
+        }
+        if (drawn > 0 && unseen_vowels + unseen_consonants > 0) {
+            const vector<double>& chances = binomial[drawn][drawable.size()];
+            for (size_t x = 0; x <= drawn; x++) {
+                gain += chances[x]
+                        * (LeaveTable::balance_value(vowels[mask] + x, consonants[mask] + drawn - x) - balance);
+            }
+        }
+        draws[mask] = gain;
+
+        if (mask != all() && equity(mask) > equity(best)) {
+            best = mask;
+        }
+    }
+}
+
+vector<TileKind> ExchangeEvaluator::tiles_outside(uint32_t keep) const {
+    vector<TileKind> tiles;
+    for (size_t i = 0; i < rack.size(); i++) {
+        if (!(keep & (uint32_t(1) << i))) {
+            tiles.push_back(rack[i]);
+        }
+    }
+    return tiles;
+}
+
+uint32_t ExchangeEvaluator::keep_after(const vector<TileKind>& tiles) const {
+    uint32_t keep = all();
+    for (const TileKind& tile : tiles) {
+        for (size_t i = 0; i < rack.size(); i++) {
+            if ((keep & (uint32_t(1) << i)) && rack[i].letter == tile.letter) {
+                keep &= ~(uint32_t(1) << i);
+                break;
+            }
+        }
+    }
+    return keep;
+}
@@ -0,0 +1,55 @@
+#ifndef EXCHANGE_EVALUATOR_H
+#define EXCHANGE_EVALUATOR_H
+
+#include "leave_table.h"
+#include "tile_kind.h"
+#include <cstdint>
+#include <vector>
+
+/*
+ Weighs keeping each subset of a rack and drawing the rest from the unseen tiles, for deciding between exchanging and
+ placing. A subset is a bitmask over the rack's tiles (bit i keeps the i-th tile), so a rack of 7 has 128 of them.
+
+ The constructor fills in the LeaveTable value of every subset in one pass over the masks, each from the mask without
+ its lowest tile, and the expected change in value from drawing the rest: for each unseen kind, and for vowels against
+ consonants, binomial tables of how many the draw brings, computed once per draw size. Later queries are lookups.
+*/
+class ExchangeEvaluator {
+public:
+    // Racks with more tiles than this are not evaluated; their tables would not be small
+    static const size_t MAX_TILES = 12;
+
+    /*
+    rack: the tiles to choose from, at most MAX_TILES of them
+    unseen: the tiles of each kind the player has not seen, which the draws come from
+    */
+    ExchangeEvaluator(const std::vector<TileKind>& rack, const LeaveTable::Counts& unseen);
+
+    // The mask that keeps every tile
+    uint32_t all() const { return (uint32_t(1) << rack.size()) - 1; }
+
+    // LeaveTable value of the tiles in keep
+    double leave_value(uint32_t keep) const { return leaves[keep]; }
+
+    // Expected change in value from refilling keep to the full rack
+    double draw_value(uint32_t keep) const { return draws[keep]; }
+
+    double equity(uint32_t keep) const { return leaves[keep] + draws[keep]; }
+
+    // The subset that is worth the most to keep while exchanging at least one tile
+    uint32_t best_exchange() const { return best; }
+
+    // The tiles not in keep, which go back to the bag
+    std::vector<TileKind> tiles_outside(uint32_t keep) const;
+
+    // The mask of the tiles left on the rack after playing tiles, matched by letter
+    uint32_t keep_after(const std::vector<TileKind>& tiles) const;
+
+private:
+    std::vector<TileKind> rack;
+    std::vector<double> leaves;
+    std::vector<double> draws;
+    uint32_t best = 0;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#ifndef FIXED_BOARD_H
+#define FIXED_BOARD_H
+
+#include "board.h"
+#include "board_rules.h"
+#include "move.h"
+#include "place_result.h"
+#include "tile_kind.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ Multiplier layouts known at compile time, in the same characters as the board files: '.' plain, '2' and '3' letter
+ multipliers, 'd' and 't' word multipliers. Only specialized for the sizes that have a layout.
+*/
+template<size_t R, size_t C>
+struct FixedLayout;
+
+// config/standard-board.txt
+template<>
+struct FixedLayout<15, 15> {
+    static constexpr size_t start_row = 7;
+    static constexpr size_t start_column = 7;
+    static constexpr char squares[15][16] = {
+            "t..2...t...2..t",
+            ".d...3...3...d.",
+            "..d...2.2...d..",
+            "...d.......d...",
+            "....d.....d....",
+            ".3...3...3...3.",
+            "..2...2.2...2..",
+            "t.............t",
+            "..2...2.2...2..",
+            ".3...3...3...3.",
+            "....d.....d....",
+            "...d.......d...",
+            "..d...2.2...d..",
+            ".d...3...3...d.",
+            "t..2...t...2..t",
+    };
+};
+
+/*
+ A board whose size and multiplier layout are fixed at compile time, so bounds checks and square lookups are plain
+ arithmetic on constants instead of going through Board's nested vectors. It only holds the tiles; multipliers come
+ from FixedLayout<R, C>.
+
+ It answers the read-only queries move generation and scoring make, with the same rules as Board (see BoardRules),
+ and keeps the same occupancy bitboards for get_anchors().
+ ComputerPlayer copies a Board into one when FixedBoard<R, C>::matches() says the layouts agree.
+*/
+template<size_t R, size_t C>
+class FixedBoard {
+    static_assert(R <= 32 && C <= 32, "FixedBoard keeps its occupancy in 32 bit rows and columns");
+
+public:
+    typedef FixedLayout<R, C> Layout;
+
+    static constexpr size_t rows = R;
+    static constexpr size_t columns = C;
+
+    Board::Position start;
+
+    // Copies the tiles of board, which must match() this layout.
+    explicit FixedBoard(const Board& board);
+
+    // Returns whether board has the size, start square and multipliers of this layout
+    static bool matches(const Board& board);
+
+    size_t get_move_index() const { return move_index; }
+
+    PlaceResult test_place(const Move& move) const { return BoardRules::test_place(*this, move); }
+
+    PlaceScore score_place(const Move& move) const { return BoardRules::score_place(*this, move); }
+
+    bool is_in_bounds(const Board::Position& position) const { return position.row < R && position.column < C; }
+
+    bool in_bounds_and_has_tile(const Board::Position& position) const {
+        return is_in_bounds(position) && cell(position).letter != '\0';
+    }
+
+    // Assumes there is a tile at p
+    char letter_at(Board::Position p) const { return cell(p).letter; }
+
+    char word_letter_at(Board::Position p) const {
+        return cell(p).letter == TileKind::BLANK_LETTER ? cell(p).assigned : cell(p).letter;
+    }
+
+    bool is_anchor_spot(Board::Position p) const { return BoardRules::is_anchor_spot(*this, p); }
+
+    std::vector<Board::Anchor> get_anchors() const { return BoardRules::get_anchors_from_bits(*this); }
+
+private:
+    friend struct BoardRules;
+
+    struct Cell {
+        char letter = '\0';  // '\0' when the square is empty
+        char assigned = '\0';
+        unsigned short points = 0;
+    };
+
+    // The view of one square BoardRules works with, shaped like BoardSquare
+    struct Square {
+        unsigned short letter_multiplier;
+        unsigned short word_multiplier;
+        const Cell& tile;
+
+        bool has_tile() const { return tile.letter != '\0'; }
+        TileKind get_tile_kind() const { return TileKind(tile.letter, tile.points, tile.assigned); }
+    };
+
+    std::array<Cell, R * C> cells;
+    size_t move_index;
+
+    // Occupancy bitboards, as in Board
+    std::array<uint32_t, R> row_tiles = {};
+    std::array<uint32_t, C> column_tiles = {};
+
+    uint32_t row_bits(size_t row) const { return row_tiles[row]; }
+    uint32_t column_bits(size_t column) const { return column_tiles[column]; }
+
+    static constexpr unsigned short letter_multiplier(char square) {
+        return square == '2' ? 2 : square == '3' ? 3 : 1;
+    }
+
+    static constexpr unsigned short word_multiplier(char square) { return square == 'd' ? 2 : square == 't' ? 3 : 1; }
+
+    const Cell& cell(const Board::Position& position) const { return cells[position.row * C + position.column]; }
+
+    Square at(const Board::Position& position) const {
+        char square = Layout::squares[position.row][position.column];
+        return Square{letter_multiplier(square), word_multiplier(square), cell(position)};
+    }
+};
+
+// The layout almost every game uses
+typedef FixedBoard<15, 15> StandardBoard;
+
+template<size_t R, size_t C>
+FixedBoard<R, C>::FixedBoard(const Board& board)
+        : start(Layout::start_row, Layout::start_column), move_index(board.get_move_index()) {
+    for (size_t row = 0; row < R; row++) {
+        for (size_t column = 0; column < C; column++) {
+            const BoardSquare& square = board.at(Board::Position(row, column));
+            if (square.has_tile()) {
+                TileKind tile = square.get_tile_kind();
+                Cell& target = cells[row * C + column];
+                target.letter = tile.letter;
+                target.assigned = tile.assigned;
+                target.points = tile.points;
+                row_tiles[row] |= uint32_t(1) << column;
+                column_tiles[column] |= uint32_t(1) << row;
+            }
+        }
+    }
+}
+
+template<size_t R, size_t C>
+bool FixedBoard<R, C>::matches(const Board& board) {
+    if (board.rows != R || board.columns != C || board.start != Board::Position(Layout::start_row, Layout::start_column)
+        || board.squares.size() < R) {
+        return false;
+    }
+    for (size_t row = 0; row < R; row++) {
+        if (board.squares[row].size() != C) {
+            return false;
+        }
+        for (size_t column = 0; column < C; column++) {
+            const BoardSquare& square = board.squares[row][column];
+            char expected = Layout::squares[row][column];
+            if (square.letter_multiplier != letter_multiplier(expected)
+                || square.word_multiplier != word_multiplier(expected)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#endif
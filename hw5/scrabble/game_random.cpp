@@ -0,0 +1,26 @@
+#include "game_random.h"
+
+static const uint64_t GOLDEN_GAMMA = 0x9e3779b97f4a7c15;
+
+// SplitMix64 finalizer
+static uint64_t mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+GameRandom::GameRandom(uint64_t seed, uint64_t game) : key(mix(mix(seed) + game * GOLDEN_GAMMA)) {}
+
+uint64_t GameRandom::at(uint64_t n) const { return mix(key + (n + 1) * GOLDEN_GAMMA); }
+
+uint64_t GameRandom::next() { return at(counter++); }
+
+uint64_t GameRandom::below(uint64_t bound) {
+    // Reject the top partial block of 2^64 so every value is equally likely
+    uint64_t limit = UINT64_MAX - UINT64_MAX % bound;
+    uint64_t value;
+    do {
+        value = next();
+    } while (value >= limit);
+    return value % bound;
+}
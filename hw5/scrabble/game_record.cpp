@@ -0,0 +1,215 @@
+#include "game_record.h"
+
+#include "exceptions.h"
+#include <fstream>
+
+using namespace std;
+
+static const char MAGIC[4] = {'S', 'C', 'R', 'B'};
+
+// Little endian helpers
+
+static void put_u8(string& out, size_t value) {
+    if (value > 0xff) {
+        throw out_of_range("value does not fit in a game record");
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+static void put_u16(string& out, size_t value) {
+    if (value > 0xffff) {
+        throw out_of_range("value does not fit in a game record");
+    }
+    out.push_back(static_cast<char>(value & 0xff));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+static void put_u32(string& out, uint64_t value) {
+    if (value > 0xffffffff) {
+        throw out_of_range("value does not fit in a game record");
+    }
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+static void put_u64(string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+// Reads little endian integers out of a byte buffer, throwing if it runs past the end
+class ByteReader {
+public:
+    ByteReader(const string& bytes) : bytes(bytes) {}
+
+    uint64_t get(size_t width) {
+        if (position + width > bytes.size()) {
+            throw FileException("truncated game record!");
+        }
+        uint64_t value = 0;
+        for (size_t i = 0; i < width; i++) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[position++])) << (8 * i);
+        }
+        return value;
+    }
+
+private:
+    const string& bytes;
+    size_t position = 0;
+};
+
+static string read_bytes(istream& in, size_t count) {
+    string bytes(count, '\0');
+    if (count > 0 && !in.read(&bytes[0], count)) {
+        throw FileException("truncated game record!");
+    }
+    return bytes;
+}
+
+void GameRecord::write(ostream& out) const {
+    string bytes(MAGIC, sizeof(MAGIC));
+    put_u8(bytes, VERSION);
+    put_u32(bytes, seed);
+    put_u64(bytes, game);
+    put_u8(bytes, players.size());
+    for (const string& name : players) {
+        put_u8(bytes, name.size());
+        bytes += name;
+    }
+
+    string payload;
+    for (const Turn& turn : turns) {
+        const Move& move = turn.move;
+        bool placed = move.kind == MoveKind::PLACE;
+
+        payload.clear();
+        put_u8(payload, turn.player);
+        put_u8(payload, static_cast<size_t>(move.kind));
+        put_u8(payload, placed ? move.row : 0);
+        put_u8(payload, placed ? move.column : 0);
+        put_u8(payload, placed ? static_cast<size_t>(move.direction) : static_cast<size_t>(Direction::NONE));
+        put_u16(payload, turn.points);
+        put_u32(payload, turn.score);
+        put_u8(payload, move.tiles.size());
+        for (const TileKind& tile : move.tiles) {
+            put_u8(payload, static_cast<unsigned char>(tile.letter));
+            put_u8(payload, static_cast<unsigned char>(tile.assigned));
+            put_u8(payload, tile.points);
+        }
+
+        put_u16(bytes, payload.size());
+        bytes += payload;
+    }
+
+    out.write(bytes.data(), bytes.size());
+}
+
+void GameRecord::write(const string& file_path) const {
+    ofstream file(file_path, ios::binary);
+    if (!file) {
+        throw FileException("cannot open game record file!");
+    }
+    write(file);
+}
+
+GameRecord GameRecord::read(istream& in) {
+    GameRecord record;
+
+    string header = read_bytes(in, sizeof(MAGIC) + 1);
+    if (header.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0) {
+        throw FileException("not a game record!");
+    }
+    size_t version = static_cast<unsigned char>(header[sizeof(MAGIC)]);
+    if (version < 1 || version > VERSION) {
+        throw FileException("unsupported game record version!");
+    }
+    string fields = read_bytes(in, version == 1 ? 5 : 13);
+    ByteReader header_reader(fields);
+    record.seed = header_reader.get(4);
+    if (version >= 2) {
+        record.game = header_reader.get(8);
+    }
+    size_t player_count = header_reader.get(1);
+    for (size_t i = 0; i < player_count; i++) {
+        size_t length = static_cast<unsigned char>(read_bytes(in, 1)[0]);
+        record.players.push_back(read_bytes(in, length));
+    }
+
+    char length_bytes[2];
+    while (in.read(length_bytes, sizeof(length_bytes))) {
+        size_t length = static_cast<unsigned char>(length_bytes[0])
+                        | static_cast<size_t>(static_cast<unsigned char>(length_bytes[1])) << 8;
+        string payload = read_bytes(in, length);
+        ByteReader reader(payload);
+
+        size_t player = reader.get(1);
+        MoveKind kind = static_cast<MoveKind>(reader.get(1));
+        size_t row = reader.get(1);
+        size_t column = reader.get(1);
+        Direction direction = static_cast<Direction>(reader.get(1));
+        unsigned int points = reader.get(2);
+        size_t score = reader.get(4);
+
+        vector<TileKind> tiles;
+        size_t tile_count = reader.get(1);
+        for (size_t i = 0; i < tile_count; i++) {
+            char letter = reader.get(1);
+            char assigned = reader.get(1);
+            unsigned short tile_points = reader.get(1);
+            tiles.push_back(TileKind(letter, tile_points, assigned));
+        }
+
+        Move move;
+        if (kind == MoveKind::PLACE) {
+            move = Move(tiles, row, column, direction);
+        } else if (kind == MoveKind::EXCHANGE) {
+            move = Move(tiles);
+        }
+        record.turns.push_back(Turn(player, move, points, score));
+    }
+    if (in.gcount() != 0) {
+        throw FileException("truncated game record!");
+    }
+
+    return record;
+}
+
+GameRecord GameRecord::read(const string& file_path) {
+    ifstream file(file_path, ios::binary);
+    if (!file) {
+        throw FileException("cannot open game record file!");
+    }
+    return read(file);
+}
+
+bool GameReplay::step() {
+    if (turn >= record.turns.size()) {
+        return false;
+    }
+    const Move& move = record.turns[turn].move;
+    if (move.kind == MoveKind::PLACE) {
+        board.place_unchecked(move);
+    }
+    turn++;
+    return true;
+}
+
+void GameReplay::seek(size_t target) {
+    if (target < turn) {
+        board = initial;
+        turn = 0;
+    }
+    while (turn < target && step()) {
+    }
+}
+
+Board GameReplay::board_at(size_t target) {
+    seek(target);
+    return board;
+}
+
+const Board& GameReplay::get_board() const { return board; }
+
+size_t GameReplay::get_turn() const { return turn; }
@@ -0,0 +1,77 @@
+#ifndef GAME_RECORD_H
+#define GAME_RECORD_H
+
+#include "board.h"
+#include "move.h"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ Compact log of a finished (or running) game: the bag seed and game id, the players and every turn with its score.
+
+ Binary layout, all integers little endian:
+     header   "SCRB", u8 version, u32 seed, u64 game id (from version 2), u8 player count, then per player u8 name
+              length and the name bytes
+     turns    repeated until end of file: u16 payload length, then the payload
+     payload  u8 player, u8 kind, u8 row, u8 column, u8 direction, u16 points, u32 score,
+              u8 tile count, then per tile u8 letter, u8 assigned letter, u8 points
+
+ Readers skip any payload bytes past the fields they know about, so later versions can append fields to a turn.
+*/
+struct GameRecord {
+    struct Turn {
+        size_t player;
+        Move move;
+        unsigned int points;  // Points gained this turn, including the empty hand bonus
+        size_t score;         // The player's total after this turn
+
+        Turn(size_t player, const Move& move, unsigned int points, size_t score)
+                : player(player), move(move), points(points), score(score) {}
+    };
+
+    static const uint8_t VERSION = 2;
+
+    uint32_t seed = 0;
+    uint64_t game = 0;  // Together with seed, picks the tile draws; see GameRandom
+    std::vector<std::string> players;
+    std::vector<Turn> turns;
+
+    void write(std::ostream& out) const;
+    void write(const std::string& file_path) const;
+
+    // Throws a FileException if the data is not a game record. Version 1 records read with game id 0.
+    static GameRecord read(std::istream& in);
+    static GameRecord read(const std::string& file_path);
+};
+
+/*
+ Rebuilds the board of a recorded game at any turn by putting the recorded moves back on a copy of the starting board.
+ Moves are trusted, so they are neither re-scored nor checked against a dictionary. The record must outlive the replay.
+*/
+class GameReplay {
+public:
+    GameReplay(const Board& initial, const GameRecord& record) : initial(initial), board(initial), record(record) {}
+
+    // Applies the next turn. Returns false if every turn has already been applied.
+    bool step();
+
+    // Moves to the board as it was after the first `turn` turns, rewinding to the start if needed.
+    void seek(size_t turn);
+
+    // Returns a copy of the board as it was after the first `turn` turns.
+    Board board_at(size_t turn);
+
+    const Board& get_board() const;
+    size_t get_turn() const;
+
+private:
+    const Board initial;
+    Board board;
+    const GameRecord& record;
+    size_t turn = 0;
+};
+
+#endif
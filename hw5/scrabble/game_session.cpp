@@ -0,0 +1,131 @@
+#include "game_session.h"
+
+#include "exceptions.h"
+#include "place_result.h"
+
+using namespace std;
+
+GameSession::GameSession(
+        shared_ptr<const Dictionary> dictionary,
+        const Board& board,
+        const TileBag& tile_bag,
+        size_t hand_size,
+        uint32_t seed,
+        uint64_t game)
+        : dictionary(dictionary), board(board), tile_bag(tile_bag), hand_size(hand_size) {
+    this->tile_bag.reseed(seed, game);
+    record.seed = seed;
+    record.game = game;
+}
+
+void GameSession::add_player(shared_ptr<Player> player) {
+    players.push_back(player);
+    record.players.push_back(player->get_name());
+    refill(*player, hand_size);
+}
+
+void GameSession::add_player(shared_ptr<Player> player, const vector<TileKind>& hand) {
+    players.push_back(player);
+    record.players.push_back(player->get_name());
+    player->add_tiles(hand);
+}
+
+void GameSession::check_move(const Move& move) const {
+    if (move.kind != MoveKind::PLACE) {
+        return;
+    }
+
+    PlaceResult result = board.test_place(move);
+    if (!result.valid) {
+        throw MoveException(result.error);
+    }
+    for (size_t i = 0; i < result.words.size(); i++) {
+        if (!dictionary->is_word(result.words[i])) {
+            throw MoveException("Invalid word created: " + result.words[i]);
+        }
+    }
+}
+
+GameSession::TurnResult GameSession::apply_move(const Move& move) {
+    Player& player = *players[current_player];
+    TurnResult result{current_player, move.kind, 0, false};
+
+    // If the move was PLACE
+    if (move.kind == MoveKind::PLACE) {
+        consecutive_passes = 0;
+
+        // Place the move and add the points from it
+        PlaceResult place_result = board.place(move);
+        result.points = place_result.valid ? place_result.points : 0;
+        if (move.tiles.size() == hand_size) {
+            result.points += EMPTY_HAND_BONUS;
+        }
+        player.add_points(result.points);
+
+        // Swap the placed tiles for new ones
+        player.remove_tiles(move.tiles);
+        refill(player, move.tiles.size());
+    }
+
+    // If the move was EXCHANGE
+    if (move.kind == MoveKind::EXCHANGE) {
+        consecutive_passes = 0;
+
+        // Return exchanged tiles to the bag, then draw the same number
+        player.remove_tiles(move.tiles);
+        for (size_t i = 0; i < move.tiles.size(); i++) {
+            tile_bag.add_tile(move.tiles[i]);
+        }
+        refill(player, move.tiles.size());
+    }
+
+    // If the move was PASS
+    if (move.kind == MoveKind::PASS) {
+        consecutive_passes++;
+    }
+
+    // Check game over conditions
+    if (player.count_tiles() == 0 && tile_bag.count_tiles() == 0) {
+        game_over = true;
+    }
+    if (consecutive_passes == players.size()) {
+        game_over = true;
+    }
+
+    record.turns.push_back(GameRecord::Turn(current_player, move, result.points, player.get_points()));
+
+    current_player = (current_player + 1) % players.size();
+    result.game_over = game_over;
+    return result;
+}
+
+GameSession::TurnResult GameSession::play_turn() {
+    Move move = players[current_player]->get_move(board, *dictionary);
+    return apply_move(move);
+}
+
+// If the bag has fewer tiles than requested, give the player the rest of the bag
+void GameSession::refill(Player& player, size_t count) {
+    if (tile_bag.count_tiles() < count) {
+        count = tile_bag.count_tiles();
+    }
+    player.add_tiles(tile_bag.remove_random_tiles(count));
+}
+
+bool GameSession::is_over() const { return game_over; }
+
+size_t GameSession::get_current_player() const { return current_player; }
+
+size_t GameSession::get_hand_size() const { return hand_size; }
+
+const Board& GameSession::get_board() const { return board; }
+
+const Dictionary& GameSession::get_dictionary() const { return *dictionary; }
+
+const TileBag& GameSession::get_tile_bag() const { return tile_bag; }
+
+const GameRecord& GameSession::get_record() const { return record; }
+
+vector<shared_ptr<Player>>& GameSession::get_players() { return players; }
+
+const vector<shared_ptr<Player>>& GameSession::get_players() const { return players; }
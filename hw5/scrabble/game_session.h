@@ -0,0 +1,94 @@
+#ifndef GAME_SESSION_H
+#define GAME_SESSION_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "game_record.h"
+#include "move.h"
+#include "player.h"
+#include "tile_bag.h"
+#include <memory>
+#include <vector>
+
+/*
+ The state and turn rules of a single game, without any terminal interaction.
+
+ Scrabble drives one of these from stdin/stdout, and SessionManager hosts many of them in one process. The dictionary
+ is shared between games; the board and tile bag are copies owned by the session.
+*/
+class GameSession {
+public:
+    struct TurnResult {
+        size_t player_index;
+        MoveKind kind;
+        unsigned int points;  // Points gained this turn, including the empty hand bonus
+        bool game_over;
+    };
+
+    static const size_t EMPTY_HAND_BONUS = 50;
+
+    /*
+    The tile bag is reseeded with (seed, game), so games started from the same bag template draw different tiles, and
+    a game can be played again from just its seed and id.
+    */
+    GameSession(
+            std::shared_ptr<const Dictionary> dictionary,
+            const Board& board,
+            const TileBag& tile_bag,
+            size_t hand_size,
+            uint32_t seed,
+            uint64_t game = 0);
+
+    // Adds a player to the end of the turn order and deals them a starting hand.
+    void add_player(std::shared_ptr<Player> player);
+
+    // Adds a player holding hand instead of dealing them one, for a game picked up from a position
+    void add_player(std::shared_ptr<Player> player, const std::vector<TileKind>& hand);
+
+    /*
+    Checks that move is something the current player may play: a PLACE must be valid on the board and every word it
+    forms must be in the dictionary. Throws a MoveException describing the problem otherwise.
+    This is the check HumanPlayer::get_move does interactively, for moves that arrive from elsewhere.
+    */
+    void check_move(const Move& move) const;
+
+    /*
+    Executes move for the current player (scoring, refilling the hand, returning exchanged tiles to the bag) and passes
+    the turn on. The move is not checked against the dictionary; see check_move().
+    */
+    TurnResult apply_move(const Move& move);
+
+    // Asks the current player for a move and applies it.
+    TurnResult play_turn();
+
+    bool is_over() const;
+    size_t get_current_player() const;
+    size_t get_hand_size() const;
+
+    const Board& get_board() const;
+    const Dictionary& get_dictionary() const;
+    const TileBag& get_tile_bag() const;
+
+    // Every turn played so far, ready to be written out with GameRecord::write
+    const GameRecord& get_record() const;
+
+    std::vector<std::shared_ptr<Player>>& get_players();
+    const std::vector<std::shared_ptr<Player>>& get_players() const;
+
+private:
+    std::shared_ptr<const Dictionary> dictionary;
+    Board board;
+    TileBag tile_bag;
+    size_t hand_size;
+    std::vector<std::shared_ptr<Player>> players;
+    GameRecord record;
+
+    size_t current_player = 0;
+    size_t consecutive_passes = 0;
+    bool game_over = false;
+
+    // Draws up to count tiles from the bag into the player's hand
+    void refill(Player& player, size_t count);
+};
+
+#endif
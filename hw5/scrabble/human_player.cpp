@@ -147,6 +147,8 @@ Move HumanPlayer::parse_move(string& move_string) const {
     if (move_kind == "PASS") {
         return Move();
     }
+
+    throw CommandException("Unknown command!");
 }
 
 // This function is fully implemented.
@@ -15,8 +15,11 @@ public:
 
     bool is_human() const { return true; }
 
-private:
+    // Parses an upper case command such as "PLACE - 8 8 HELLO" against this player's hand.
+    // Public so that moves can also arrive from somewhere other than stdin (see server.cpp).
     Move parse_move(std::string& move_string) const;
+
+private:
     std::vector<TileKind> parse_tiles(std::string& letters) const;
     void print_hand(std::ostream& out) const;
 };
@@ -0,0 +1,61 @@
+#include "leave_table.h"
+
+#include <cctype>
+
+using namespace std;
+
+// Worth of keeping one tile of each kind, 'a' to 'z' and the blank
+static const double SINGLE_VALUES[LeaveTable::KINDS] = {
+        1.0, -2.0, 0.5, 0.0, 1.5, -2.0, -2.0, 1.0, -0.5, -1.5, -1.0, -0.5, 0.5,
+        0.5, -1.0, -0.5, -7.0, 1.5, 7.5, 0.5, -3.0, -5.0, -3.5, 3.0, -0.5, 2.0, 25.0};
+static const double DUPLICATE_PENALTY = 3.0;
+static const double BALANCE_PENALTY = 1.5;
+
+size_t LeaveTable::index_of(char letter) {
+    if (letter == TileKind::BLANK_LETTER) {
+        return KINDS - 1;
+    }
+    letter = tolower(letter);
+    return letter >= 'a' && letter <= 'z' ? letter - 'a' : KINDS;
+}
+
+LeaveTable::Counts LeaveTable::count(const vector<TileKind>& tiles) {
+    Counts counts = {};
+    for (const TileKind& tile : tiles) {
+        size_t index = index_of(tile.letter);
+        if (index < KINDS) {
+            counts[index]++;
+        }
+    }
+    return counts;
+}
+
+double LeaveTable::kind_value(size_t index, size_t copies) {
+    return copies == 0 ? 0 : SINGLE_VALUES[index] * copies - DUPLICATE_PENALTY * (copies - 1);
+}
+
+bool LeaveTable::is_vowel(size_t index) {
+    return index == 'a' - 'a' || index == 'e' - 'a' || index == 'i' - 'a' || index == 'o' - 'a' || index == 'u' - 'a';
+}
+
+bool LeaveTable::is_consonant(size_t index) { return index < KINDS - 1 && !is_vowel(index); }
+
+double LeaveTable::balance_value(size_t vowels, size_t consonants) {
+    size_t imbalance = vowels > consonants ? vowels - consonants : consonants - vowels;
+    return imbalance > 1 ? -BALANCE_PENALTY * (imbalance - 1) : 0;
+}
+
+double LeaveTable::value(const Counts& tiles) {
+    double value = 0;
+    size_t vowels = 0;
+    size_t consonants = 0;
+    for (size_t index = 0; index < KINDS; index++) {
+        value += kind_value(index, tiles[index]);
+        if (is_vowel(index)) {
+            vowels += tiles[index];
+        } else if (is_consonant(index)) {
+            consonants += tiles[index];
+        }
+    }
+    return value + balance_value(vowels, consonants);
+}
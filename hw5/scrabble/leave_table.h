@@ -0,0 +1,41 @@
+#ifndef LEAVE_TABLE_H
+#define LEAVE_TABLE_H
+
+#include "tile_kind.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+ Rough equity of the tiles a player keeps, in points of future score: good letters and the blank add, clunky ones,
+ duplicates and racks heavy in vowels or consonants subtract. The numbers are hand tuned in the spirit of published
+ single tile leave values rather than fitted to games.
+
+ A value is a sum over kinds of kind_value() plus balance_value() of the vowel and consonant counts, so it can be
+ updated one tile at a time.
+*/
+class LeaveTable {
+public:
+    static const size_t KINDS = 27;  // 'a' to 'z', then the blank
+
+    typedef std::array<uint8_t, KINDS> Counts;
+
+    // The index of letter in Counts, or KINDS for letters that are not tracked
+    static size_t index_of(char letter);
+
+    static Counts count(const std::vector<TileKind>& tiles);
+
+    // Worth of keeping copies tiles of the kind at index
+    static double kind_value(size_t index, size_t copies);
+
+    // Whether the kind at index is a vowel; the blank is neither a vowel nor a consonant
+    static bool is_vowel(size_t index);
+    static bool is_consonant(size_t index);
+
+    static double balance_value(size_t vowels, size_t consonants);
+
+    static double value(const Counts& tiles);
+};
+
+#endif
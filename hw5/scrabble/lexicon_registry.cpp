@@ -0,0 +1,64 @@
+#include "lexicon_registry.h"
+
+#include <stdexcept>
+
+using namespace std;
+
+size_t LexiconRegistry::load(const string& name, const string& file_path) {
+    // Parse outside of the lock, this is the slow part
+    Lexicon lexicon = make_shared<const Dictionary>(Dictionary::read(file_path));
+    return publish(name, lexicon);
+}
+
+size_t LexiconRegistry::publish(const string& name, Lexicon lexicon) {
+    Lexicon replaced;
+    size_t version;
+    {
+        lock_guard<mutex> lock(this->entries_mutex);
+        Snapshot& entry = this->entries[name];
+        replaced = entry.lexicon;
+        entry.lexicon = lexicon;
+        version = ++entry.version;
+    }
+    // If nobody else holds the old version it is freed here, after the lock is released
+    return version;
+}
+
+LexiconRegistry::Lexicon LexiconRegistry::get(const string& name) const { return get_snapshot(name).lexicon; }
+
+LexiconRegistry::Snapshot LexiconRegistry::get_snapshot(const string& name) const {
+    lock_guard<mutex> lock(this->entries_mutex);
+    auto it = this->entries.find(name);
+    if (it == this->entries.end()) {
+        throw out_of_range("no lexicon named " + name);
+    }
+    return it->second;
+}
+
+bool LexiconRegistry::contains(const string& name) const {
+    lock_guard<mutex> lock(this->entries_mutex);
+    return this->entries.find(name) != this->entries.end();
+}
+
+void LexiconRegistry::remove(const string& name) {
+    Lexicon removed;
+    {
+        lock_guard<mutex> lock(this->entries_mutex);
+        auto it = this->entries.find(name);
+        if (it == this->entries.end()) {
+            return;
+        }
+        removed = it->second.lexicon;
+        this->entries.erase(it);
+    }
+    // As in publish(), the lexicon is released outside of the lock
+}
+
+vector<string> LexiconRegistry::names() const {
+    lock_guard<mutex> lock(this->entries_mutex);
+    vector<string> result;
+    for (auto it = this->entries.begin(); it != this->entries.end(); ++it) {
+        result.push_back(it->first);
+    }
+    return result;
+}
@@ -0,0 +1,66 @@
+#ifndef LEXICON_REGISTRY_H
+#define LEXICON_REGISTRY_H
+
+#include "dictionary.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ Shared store of named, immutable dictionaries.
+
+ Games ask the registry for a lexicon once and hold on to the returned shared_ptr for as long as they run, so
+ publishing a new version of a word list never changes the words an in-flight game is checked against. The old
+ version stays in memory until the last game holding it lets go of its snapshot.
+*/
+class LexiconRegistry {
+public:
+    typedef std::shared_ptr<const Dictionary> Lexicon;
+
+    struct Snapshot {
+        Lexicon lexicon;
+        size_t version;
+    };
+
+    /*
+     Reads a dictionary file and publishes it under `name`. The file is parsed before the registry is touched, so
+     readers keep getting the previous version until the new one is complete.
+     Returns the version number of the newly published lexicon.
+     */
+    size_t load(const std::string& name, const std::string& file_path);
+
+    /*
+     Atomically replaces the lexicon stored under `name`, creating the entry if needed.
+     Returns the version number of the newly published lexicon (versions start at 1).
+     */
+    size_t publish(const std::string& name, Lexicon lexicon);
+
+    /*
+     Returns the current lexicon stored under `name`.
+     Throws std::out_of_range if no lexicon with this name has been published.
+     */
+    Lexicon get(const std::string& name) const;
+
+    /*
+     Returns the current lexicon together with its version number.
+     Throws std::out_of_range if no lexicon with this name has been published.
+     */
+    Snapshot get_snapshot(const std::string& name) const;
+
+    bool contains(const std::string& name) const;
+
+    /*
+     Removes `name` from the registry. Games that already hold the lexicon keep using it.
+     */
+    void remove(const std::string& name);
+
+    std::vector<std::string> names() const;
+
+private:
+    mutable std::mutex entries_mutex;
+    std::map<std::string, Snapshot> entries;
+};
+
+#endif
@@ -1,6 +1,65 @@
 #include "move.h"
 
+#include <algorithm>
+#include <utility>
+
+using namespace std;
 
 Direction operator!(Direction direction) {
     return direction == Direction::ACROSS ? Direction::DOWN : Direction::ACROSS;
 }
+
+// A one tile placement reads the same either way, so it counts as ACROSS
+static Direction placement_direction(const Move& move) {
+    return move.tiles.size() <= 1 ? Direction::ACROSS : move.direction;
+}
+
+// Each tile's letter and the letter assigned to it if it is a blank, in placement order or sorted for an exchange
+static vector<pair<char, char>> tile_letters(const Move& move) {
+    vector<pair<char, char>> letters;
+    for (const TileKind& tile : move.tiles) {
+        letters.emplace_back(tile.letter, tile.letter == TileKind::BLANK_LETTER ? tile.assigned : '\0');
+    }
+    if (move.kind == MoveKind::EXCHANGE) {
+        sort(letters.begin(), letters.end());
+    }
+    return letters;
+}
+
+bool operator==(const Move& lhs, const Move& rhs) {
+    if (lhs.kind != rhs.kind) {
+        return false;
+    }
+    if (lhs.kind == MoveKind::PASS) {
+        return true;
+    }
+    if (lhs.kind == MoveKind::PLACE
+        && (lhs.row != rhs.row || lhs.column != rhs.column || placement_direction(lhs) != placement_direction(rhs))) {
+        return false;
+    }
+    return tile_letters(lhs) == tile_letters(rhs);
+}
+
+bool operator!=(const Move& lhs, const Move& rhs) { return !(lhs == rhs); }
+
+size_t MoveHash::operator()(const Move& move) const {
+    // FNV-1a over the fields operator== compares
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ull;
+    };
+    mix(static_cast<uint64_t>(move.kind));
+    if (move.kind == MoveKind::PASS) {
+        return hash;
+    }
+    if (move.kind == MoveKind::PLACE) {
+        mix(move.row);
+        mix(move.column);
+        mix(static_cast<uint64_t>(placement_direction(move)));
+    }
+    for (const pair<char, char>& letters : tile_letters(move)) {
+        mix(static_cast<unsigned char>(letters.first) | static_cast<unsigned char>(letters.second) << 8);
+    }
+    return hash;
+}
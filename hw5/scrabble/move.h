@@ -2,6 +2,7 @@
 #define MOVE_H
 
 #include "tile_kind.h"
+#include <cstdint>
 #include <stdlib.h>
 #include <vector>
 
@@ -32,4 +33,17 @@ struct Move {
             : kind(MoveKind::PLACE), tiles(tiles), row(row), column(column), direction(direction) {}
 };
 
+/*
+Moves are equal when they do the same thing: two passes, two exchanges of the same tiles in any order, or two
+placements of the same tiles, with the same letters assigned to blanks, starting on the same square. A one tile
+placement is the same ACROSS or DOWN.
+*/
+bool operator==(const Move& lhs, const Move& rhs);
+bool operator!=(const Move& lhs, const Move& rhs);
+
+// A hash that agrees with operator==, for keeping moves in unordered containers
+struct MoveHash {
+    size_t operator()(const Move& move) const;
+};
+
 #endif
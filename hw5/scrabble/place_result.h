@@ -1,6 +1,8 @@
 #ifndef PLACE_RESULT_H
 #define PLACE_RESULT_H
 
+#include "move.h"
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -16,4 +18,61 @@ struct PlaceResult {
             : valid(true), words(words), points(points) {}
 };
 
+// Why a move cannot be placed, as found by Board::score_place
+enum class PlaceError {
+    NONE,
+    START_OCCUPIED,
+    OUT_OF_BOUNDS,
+    NOT_ON_START,
+    NOT_ADJACENT,
+};
+
+// The message test_place() reports for an error
+inline const char* place_error_message(PlaceError error) {
+    switch (error) {
+    case PlaceError::START_OCCUPIED:
+        return "Your starting position already has a tile on it!";
+    case PlaceError::OUT_OF_BOUNDS:
+        return "One or more tiles is out of bounds!";
+    case PlaceError::NOT_ON_START:
+        return "The first move must contain the start square!";
+    case PlaceError::NOT_ADJACENT:
+        return "At least one tile must be adjacent to a previously placed tile!";
+    default:
+        return "";
+    }
+}
+
+// A word a move would form: length squares from (row, column) going in direction, counting the move's own tiles
+struct WordSpan {
+    size_t row;
+    size_t column;
+    Direction direction;
+    size_t length;
+};
+
+/*
+ The allocation-free counterpart of PlaceResult, for callers that score many moves and only need validity and
+ points. Words are spans into the board rather than strings; Board::test_place turns them into a PlaceResult.
+ Cross words come first in the order of the tiles that form them, then the main word, as in PlaceResult::words.
+*/
+struct PlaceScore {
+    // One cross word per tile plus the main word. Only moves of more than 31 tiles could form more.
+    static const size_t MAX_WORDS = 32;
+
+    PlaceError error = PlaceError::NONE;
+    unsigned int points = 0;
+    size_t word_count = 0;  // Number of words formed; spans past MAX_WORDS are counted but not kept
+    WordSpan words[MAX_WORDS];
+
+    bool valid() const { return error == PlaceError::NONE; }
+
+    void add_word(const WordSpan& span) {
+        if (word_count < MAX_WORDS) {
+            words[word_count] = span;
+        }
+        word_count++;
+    }
+};
+
 #endif
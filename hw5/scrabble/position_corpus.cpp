@@ -0,0 +1,144 @@
+#include "position_corpus.h"
+
+#include "exceptions.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char MAGIC[4] = {'S', 'C', 'P', 'C'};
+static const size_t HEADER_SIZE = 16;
+
+static void put_u32(string& out, uint32_t value) {
+    for (int shift = 0; shift < 32; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+static void put_u64(string& out, uint64_t value) {
+    for (int shift = 0; shift < 64; shift += 8) {
+        out.push_back(static_cast<char>((value >> shift) & 0xff));
+    }
+}
+
+static uint64_t get_u64(const char* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+    }
+    return value;
+}
+
+PositionCorpusWriter::PositionCorpusWriter(const string& file_path) : file(file_path, ios::binary) {
+    if (!file) {
+        throw FileException("cannot open position corpus file!");
+    }
+    string header(MAGIC, sizeof(MAGIC));
+    put_u32(header, PositionCorpus::VERSION);
+    put_u64(header, 0);  // Filled in by finish()
+    file.write(header.data(), header.size());
+    offsets.push_back(HEADER_SIZE);
+}
+
+PositionCorpusWriter::~PositionCorpusWriter() {
+    try {
+        finish();
+    } catch (const exception& e) {
+        // A destructor cannot report it; the file is left without an index and will fail to open
+    }
+}
+
+void PositionCorpusWriter::add(const Board& board) {
+    if (finished) {
+        throw logic_error("position corpus is already finished");
+    }
+    buffer.clear();
+    board.write_snapshot(buffer);
+    file.write(buffer.data(), buffer.size());
+    offsets.push_back(offsets.back() + buffer.size());
+}
+
+void PositionCorpusWriter::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+
+    buffer.clear();
+    for (uint64_t offset : offsets) {
+        put_u64(buffer, offset);
+    }
+    file.write(buffer.data(), buffer.size());
+
+    buffer.clear();
+    put_u64(buffer, size());
+    file.seekp(sizeof(MAGIC) + 4);
+    file.write(buffer.data(), buffer.size());
+
+    file.close();
+    if (!file) {
+        throw FileException("cannot write position corpus file!");
+    }
+}
+
+size_t PositionCorpusWriter::size() const { return offsets.size() - 1; }
+
+PositionCorpus::PositionCorpus(const string& file_path) {
+    int fd = open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FileException("cannot open position corpus file!");
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < HEADER_SIZE) {
+        close(fd);
+        throw FileException("not a position corpus!");
+    }
+    length = info.st_size;
+    void* mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        throw FileException("cannot map position corpus file!");
+    }
+    data = static_cast<const char*>(mapping);
+    madvise(mapping, length, MADV_SEQUENTIAL);
+
+    // Check the header and that the index describes back to back positions inside the file, so that operator[] can
+    // trust it without further checks
+    bool valid = string(data, sizeof(MAGIC)) == string(MAGIC, sizeof(MAGIC))
+                 && (get_u64(data + sizeof(MAGIC)) & 0xffffffff) == VERSION;
+    count = get_u64(data + sizeof(MAGIC) + 4);
+    valid = valid && count < (length - HEADER_SIZE) / 8;
+    if (valid) {
+        index = data + length - (count + 1) * 8;
+        valid = offset(0) == HEADER_SIZE && offset(count) == static_cast<uint64_t>(index - data);
+        for (size_t i = 0; valid && i < count; i++) {
+            valid = offset(i) + BoardSnapshot::HEADER_SIZE <= offset(i + 1);
+        }
+    }
+    if (!valid) {
+        munmap(const_cast<char*>(data), length);
+        throw FileException("not a position corpus!");
+    }
+}
+
+PositionCorpus::~PositionCorpus() { munmap(const_cast<char*>(data), length); }
+
+size_t PositionCorpus::size() const { return count; }
+
+BoardSnapshot PositionCorpus::operator[](size_t position) const {
+    uint64_t begin = offset(position);
+    return BoardSnapshot(data + begin, offset(position + 1) - begin);
+}
+
+BoardSnapshot PositionCorpus::at(size_t position) const {
+    if (position >= count) {
+        throw out_of_range("no such position in corpus");
+    }
+    return (*this)[position];
+}
+
+Board PositionCorpus::board(size_t position) const { return Board::read_snapshot(at(position)); }
+
+uint64_t PositionCorpus::offset(size_t position) const { return get_u64(index + position * 8); }
@@ -0,0 +1,79 @@
+#ifndef POSITION_CORPUS_H
+#define POSITION_CORPUS_H
+
+#include "board.h"
+#include "board_snapshot.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/*
+ A file of board snapshots with an index, for jobs that look at many positions (benchmarks, training data) without
+ replaying the games they came from.
+
+ File layout, all integers little endian:
+     header    "SCPC", u32 version, u64 position count
+     positions the snapshots written by Board::write_snapshot, back to back
+     index     u64 offset of each position from the start of the file, then one more u64 for the end of the last one
+*/
+class PositionCorpusWriter {
+public:
+    // Throws a FileException if the file cannot be created.
+    explicit PositionCorpusWriter(const std::string& file_path);
+
+    // Finishes the file if finish() has not been called yet
+    ~PositionCorpusWriter();
+
+    PositionCorpusWriter(const PositionCorpusWriter&) = delete;
+    PositionCorpusWriter& operator=(const PositionCorpusWriter&) = delete;
+
+    void add(const Board& board);
+
+    // Writes the index and position count. Nothing may be added afterwards.
+    void finish();
+
+    size_t size() const;
+
+private:
+    std::ofstream file;
+    std::vector<uint64_t> offsets;
+    std::string buffer;
+    bool finished = false;
+};
+
+/*
+ Memory-maps a corpus written by PositionCorpusWriter. Positions are handed out as BoardSnapshot views straight into
+ the mapping, so iterating the corpus does not copy or allocate; the views are only valid while the corpus is open.
+*/
+class PositionCorpus {
+public:
+    static const uint32_t VERSION = 1;
+
+    // Throws a FileException if the file cannot be opened or is not a position corpus.
+    explicit PositionCorpus(const std::string& file_path);
+    ~PositionCorpus();
+
+    PositionCorpus(const PositionCorpus&) = delete;
+    PositionCorpus& operator=(const PositionCorpus&) = delete;
+
+    size_t size() const;
+
+    BoardSnapshot operator[](size_t index) const;
+
+    // Throws std::out_of_range if index is not less than size()
+    BoardSnapshot at(size_t index) const;
+
+    // Copies a position into a full Board
+    Board board(size_t index) const;
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    size_t count = 0;
+    const char* index = nullptr;
+
+    uint64_t offset(size_t position) const;
+};
+
+#endif
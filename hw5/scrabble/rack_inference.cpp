@@ -0,0 +1,327 @@
+#include "rack_inference.h"
+
+#include <cmath>
+
+using namespace std;
+
+RackInference::RackInference(
+        const TileBag& full_bag,
+        const Board& board,
+        const vector<TileKind>& own_rack,
+        size_t hand_size,
+        uint32_t seed,
+        size_t particle_count)
+        : kinds(KINDS, TileKind('\0', 0)), hand_size(hand_size), random(seed, 0) {
+    for (const auto& entry : full_bag.get_kinds()) {
+        size_t index = LeaveTable::index_of(entry.second.letter);
+        if (index < KINDS) {
+            kinds[index] = entry.second;
+            unseen[index] += full_bag.count_tiles(entry.second);
+        }
+    }
+    for (size_t index = 0; index < KINDS; index++) {
+        unseen_total += unseen[index];
+    }
+
+    Counts seen = LeaveTable::count(own_rack);
+    for (size_t row = 0; row < board.rows; row++) {
+        for (size_t column = 0; column < board.columns; column++) {
+            Board::Position position(row, column);
+            if (board.in_bounds_and_has_tile(position)) {
+                size_t index = LeaveTable::index_of(board.letter_at(position));
+                if (index < KINDS) {
+                    seen[index]++;
+                }
+            }
+        }
+    }
+    for (size_t index = 0; index < KINDS; index++) {
+        uint8_t taken = seen[index] < unseen[index] ? seen[index] : unseen[index];
+        unseen[index] -= taken;
+        unseen_total -= taken;
+    }
+
+    rack_size = hand_size < unseen_total ? hand_size : unseen_total;
+    particles.resize(particle_count);
+    for (Particle& particle : particles) {
+        Counts pool = unseen;
+        particle.rack = {};
+        particle.weight = 1.0 / particle_count;
+        draw(pool, unseen_total, rack_size, particle.rack);
+    }
+}
+
+void RackInference::set_keep_weight(double weight) { keep_weight = weight; }
+
+void RackInference::observe_own_draw(const vector<TileKind>& tiles) {
+    if (!tiles.empty()) {
+        remove_seen(LeaveTable::count(tiles));
+    }
+}
+
+void RackInference::observe_own_return(const vector<TileKind>& tiles) {
+    Counts returned = LeaveTable::count(tiles);
+    for (size_t index = 0; index < KINDS; index++) {
+        unseen[index] += returned[index];
+        unseen_total += returned[index];
+    }
+}
+
+void RackInference::observe_opponent(const Move& move) {
+    if (move.kind == MoveKind::PASS) {
+        return;
+    }
+
+    if (move.kind == MoveKind::EXCHANGE) {
+        size_t exchanged = move.tiles.size() < rack_size ? move.tiles.size() : rack_size;
+        for (Particle& particle : particles) {
+            // Players exchange racks they do not want to keep, and keep the best part of them
+            particle.weight *= exp(-keep_weight * LeaveTable::value(particle.rack));
+            for (size_t i = 0; i < exchanged; i++) {
+                size_t worst = KINDS;
+                double best_value = 0;
+                for (size_t index = 0; index < KINDS; index++) {
+                    if (particle.rack[index] == 0) {
+                        continue;
+                    }
+                    particle.rack[index]--;
+                    double value = LeaveTable::value(particle.rack);
+                    particle.rack[index]++;
+                    if (worst == KINDS || value > best_value) {
+                        worst = index;
+                        best_value = value;
+                    }
+                }
+                particle.rack[worst]--;
+            }
+            Counts pool = unseen;
+            for (size_t index = 0; index < KINDS; index++) {
+                pool[index] -= particle.rack[index];
+            }
+            draw(pool, unseen_total - (rack_size - exchanged), exchanged, particle.rack);
+        }
+    } else {
+        Counts played = LeaveTable::count(move.tiles);
+        size_t played_count = 0;
+        for (size_t index = 0; index < KINDS; index++) {
+            played[index] = played[index] < unseen[index] ? played[index] : unseen[index];
+            played_count += played[index];
+        }
+        size_t kept = rack_size > played_count ? rack_size - played_count : 0;
+
+        for (Particle& particle : particles) {
+            // The leave: what the particle has beyond the played tiles. A particle missing some of them gets a fresh
+            // leave from the other unseen tiles instead; what is left of its own rack would be short of the played
+            // letters, since it was drawn without them.
+            Counts leave = {};
+            size_t leave_count = 0;
+            for (size_t index = 0; index < KINDS; index++) {
+                if (particle.rack[index] > played[index]) {
+                    leave[index] = particle.rack[index] - played[index];
+                    leave_count += leave[index];
+                }
+            }
+            if (leave_count > kept) {
+                size_t missing = leave_count - kept;
+                particle.weight *= pow(REPAIR_PENALTY, static_cast<double>(missing));
+                Counts pool = unseen;
+                for (size_t index = 0; index < KINDS; index++) {
+                    pool[index] -= played[index];
+                }
+                leave = {};
+                draw(pool, unseen_total - played_count, kept, leave);
+            }
+            particle.weight *= exp(keep_weight * LeaveTable::value(leave));
+            particle.rack = leave;
+        }
+
+        for (size_t index = 0; index < KINDS; index++) {
+            unseen[index] -= played[index];
+        }
+        unseen_total -= played_count;
+
+        // The opponent refills from the bag, which is whatever of the unseen tiles each particle does not hold
+        size_t bag = unseen_total - kept;
+        size_t drawn = played_count < bag ? played_count : bag;
+        for (Particle& particle : particles) {
+            Counts pool = unseen;
+            for (size_t index = 0; index < KINDS; index++) {
+                pool[index] -= particle.rack[index];
+            }
+            draw(pool, bag, drawn, particle.rack);
+        }
+        rack_size = kept + drawn;
+    }
+
+    normalize();
+    if (effective_particles() < particles.size() / 2.0) {
+        resample();
+    }
+}
+
+const RackInference::Counts& RackInference::get_unseen() const { return unseen; }
+
+size_t RackInference::count_unseen() const { return unseen_total; }
+
+size_t RackInference::get_opponent_rack_size() const { return rack_size; }
+
+double RackInference::expected_count(char letter) const {
+    size_t index = LeaveTable::index_of(letter);
+    double expected = 0;
+    for (const Particle& particle : particles) {
+        expected += particle.weight * (index < KINDS ? particle.rack[index] : 0);
+    }
+    return expected;
+}
+
+double RackInference::probability_of(char letter) const {
+    size_t index = LeaveTable::index_of(letter);
+    double probability = 0;
+    for (const Particle& particle : particles) {
+        if (index < KINDS && particle.rack[index] > 0) {
+            probability += particle.weight;
+        }
+    }
+    return probability;
+}
+
+vector<TileKind> RackInference::sample_rack() {
+    const Counts& rack = particles[pick_particle()].rack;
+    vector<TileKind> tiles;
+    for (size_t index = 0; index < KINDS; index++) {
+        tiles.insert(tiles.end(), rack[index], kinds[index]);
+    }
+    return tiles;
+}
+
+void RackInference::sample_deal(vector<TileKind>& rack, vector<TileKind>& bag) {
+    rack = sample_rack();
+    Counts pool = unseen;
+    for (const TileKind& tile : rack) {
+        pool[LeaveTable::index_of(tile.letter)]--;
+    }
+    size_t total = unseen_total - rack.size();
+    bag.clear();
+    for (; total > 0; total--) {
+        Counts one = {};
+        draw(pool, total, 1, one);
+        for (size_t index = 0; index < KINDS; index++) {
+            if (one[index] > 0) {
+                bag.push_back(kinds[index]);
+            }
+        }
+    }
+}
+
+double RackInference::effective_particles() const {
+    double squares = 0;
+    for (const Particle& particle : particles) {
+        squares += particle.weight * particle.weight;
+    }
+    return squares > 0 ? 1 / squares : 0;
+}
+
+void RackInference::draw(Counts& pool, size_t total, size_t count, Counts& rack) {
+    for (size_t i = 0; i < count && total > 0; i++, total--) {
+        size_t pick = random.below(total);
+        size_t index = 0;
+        while (pick >= pool[index]) {
+            pick -= pool[index++];
+        }
+        pool[index]--;
+        rack[index]++;
+    }
+}
+
+double RackInference::uniform() { return (random.next() >> 11) * (1.0 / (uint64_t(1) << 53)); }
+
+void RackInference::remove_seen(const Counts& seen) {
+    // The draw is likelier from particles whose bag had more of the drawn tiles: weigh each by the number of ways its
+    // bag could have given them. Particles holding tiles the bag must have had are repaired, at a penalty.
+    for (Particle& particle : particles) {
+        for (size_t index = 0; index < KINDS; index++) {
+            int available = unseen[index] - particle.rack[index];
+            for (int i = 0; i < seen[index]; i++) {
+                particle.weight *= available - i > 0 ? available - i : REPAIR_PENALTY;
+            }
+        }
+    }
+
+    for (size_t index = 0; index < KINDS; index++) {
+        uint8_t taken = seen[index] < unseen[index] ? seen[index] : unseen[index];
+        unseen[index] -= taken;
+        unseen_total -= taken;
+    }
+    if (rack_size > unseen_total) {
+        rack_size = unseen_total;
+    }
+
+    for (Particle& particle : particles) {
+        // Tiles the particle held that turned out to be in the bag are swapped for others from its bag
+        size_t held = 0;
+        for (size_t index = 0; index < KINDS; index++) {
+            if (particle.rack[index] > unseen[index]) {
+                particle.rack[index] = unseen[index];
+            }
+            held += particle.rack[index];
+        }
+        if (held > rack_size) {
+            Counts dropped = {};
+            draw(particle.rack, held, held - rack_size, dropped);
+            held = rack_size;
+        }
+        Counts pool = unseen;
+        for (size_t index = 0; index < KINDS; index++) {
+            pool[index] -= particle.rack[index];
+        }
+        draw(pool, unseen_total - held, rack_size - held, particle.rack);
+    }
+
+    normalize();
+    if (effective_particles() < particles.size() / 2.0) {
+        resample();
+    }
+}
+
+void RackInference::normalize() {
+    double total = 0;
+    for (const Particle& particle : particles) {
+        total += particle.weight;
+    }
+    for (Particle& particle : particles) {
+        particle.weight = total > 0 ? particle.weight / total : 1.0 / particles.size();
+    }
+}
+
+void RackInference::resample() {
+    // Systematic resampling: one random offset, then evenly spaced picks along the cumulative weights
+    vector<Particle> resampled;
+    resampled.reserve(particles.size());
+    double step = 1.0 / particles.size();
+    double target = uniform() * step;
+    double cumulative = 0;
+    size_t i = 0;
+    for (const Particle& particle : particles) {
+        cumulative += particle.weight;
+        while (target < cumulative && i < particles.size()) {
+            resampled.push_back(Particle{particle.rack, step});
+            target += step;
+            i++;
+        }
+    }
+    while (resampled.size() < particles.size()) {
+        resampled.push_back(Particle{particles.back().rack, step});
+    }
+    particles.swap(resampled);
+}
+
+size_t RackInference::pick_particle() {
+    double target = uniform();
+    for (size_t i = 0; i < particles.size(); i++) {
+        target -= particles[i].weight;
+        if (target < 0) {
+            return i;
+        }
+    }
+    return particles.size() - 1;
+}
@@ -0,0 +1,124 @@
+#ifndef RACK_INFERENCE_H
+#define RACK_INFERENCE_H
+
+#include "board.h"
+#include "game_random.h"
+#include "leave_table.h"
+#include "move.h"
+#include "tile_bag.h"
+#include "tile_kind.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+/*
+ Estimates what one opponent holds, from the point of view of one player in a two player game.
+
+ The tiles that player has not seen are the full bag minus the board and their own rack; the opponent's rack is some
+ of those and the bag is the rest. The estimate is a set of particles, each a possible opponent rack with a weight.
+ Every observed opponent move reweights them by how well it fits:
+     PLACE     the played tiles must have been on the rack (particles missing some are redrawn, at a penalty), and
+               racks whose leave is worth keeping fit better
+     EXCHANGE  only the number of tiles is visible; poor racks are the ones that get exchanged
+     PASS      tells nothing
+ after which each particle draws the opponent's new tiles from its own view of the bag. The particles are resampled
+ when their weights get too uneven.
+
+ An update costs a few passes over the particles with 27 counts each, so it can run every turn of a live game.
+*/
+class RackInference {
+public:
+    static const size_t KINDS = LeaveTable::KINDS;
+    static const size_t DEFAULT_PARTICLES = 1000;
+
+    typedef LeaveTable::Counts Counts;
+
+    /*
+    full_bag: the bag as read, before any tiles were drawn
+    board: the board now
+    own_rack: the observing player's tiles
+    */
+    RackInference(
+            const TileBag& full_bag,
+            const Board& board,
+            const std::vector<TileKind>& own_rack,
+            size_t hand_size,
+            uint32_t seed,
+            size_t particle_count = DEFAULT_PARTICLES);
+
+    /*
+    How strongly the value of a leave sways the weights (see LeaveTable). Opponents that keep good tiles on purpose
+    are modeled by the default; 0 suits ones that only chase points, such as ComputerPlayer, whose leaves tell nothing.
+    */
+    void set_keep_weight(double weight);
+
+    // The observing player drew these tiles
+    void observe_own_draw(const std::vector<TileKind>& tiles);
+
+    // The observing player put these tiles back in the bag
+    void observe_own_return(const std::vector<TileKind>& tiles);
+
+    // The opponent played move and drew their new tiles
+    void observe_opponent(const Move& move);
+
+    // Tiles of each kind the observing player has not seen, in the opponent's rack or the bag
+    const Counts& get_unseen() const;
+    size_t count_unseen() const;
+
+    size_t get_opponent_rack_size() const;
+
+    // The expected number of letter ('?' for the blank) on the opponent's rack
+    double expected_count(char letter) const;
+
+    // The probability the opponent has at least one letter
+    double probability_of(char letter) const;
+
+    // A rack drawn from the estimate, for simulating the opponent's next moves
+    std::vector<TileKind> sample_rack();
+
+    /*
+    A rack drawn from the estimate and the bag that goes with it, in the order the tiles would be drawn. Together they
+    are one way the hidden tiles could be dealt, for playing the game out (see Simulation::play_deal).
+    */
+    void sample_deal(std::vector<TileKind>& rack, std::vector<TileKind>& bag);
+
+    // 1 / sum of squared weights: the number of particles that effectively carry the estimate
+    double effective_particles() const;
+
+    static size_t index_of(char letter) { return LeaveTable::index_of(letter); }
+
+private:
+    struct Particle {
+        Counts rack;
+        double weight;
+    };
+
+    static constexpr double DEFAULT_KEEP_WEIGHT = 0.1;
+
+    // Weight factor per played tile a particle did not have
+    static constexpr double REPAIR_PENALTY = 0.05;
+
+    std::vector<TileKind> kinds;  // By index, for turning counts back into tiles
+    double keep_weight = DEFAULT_KEEP_WEIGHT;
+    Counts unseen = {};
+    size_t unseen_total = 0;
+    size_t hand_size;
+    size_t rack_size;
+    std::vector<Particle> particles;
+    GameRandom random;
+
+    // Draws count tiles from pool, which has total tiles, into rack and out of pool
+    void draw(Counts& pool, size_t total, size_t count, Counts& rack);
+
+    // A uniformly distributed number in [0, 1)
+    double uniform();
+
+    // Takes tiles the observing player drew out of the unseen ones, reweighing particles by how likely the draw was
+    void remove_seen(const Counts& seen);
+
+    void normalize();
+    void resample();
+    size_t pick_particle();
+};
+
+#endif
@@ -9,11 +9,17 @@ using namespace std;
 
 // Given to you. this does not need to be changed
 Scrabble::Scrabble(const ScrabbleConfig& config)
+        : Scrabble(config, std::make_shared<const Dictionary>(Dictionary::read(config.dictionary_file_path))) {}
+
+Scrabble::Scrabble(const ScrabbleConfig& config, shared_ptr<const Dictionary> dictionary)
         : hand_size(config.hand_size),
           minimum_word_length(config.minimum_word_length),
-          tile_bag(TileBag::read(config.tile_bag_file_path, config.seed)),
-          board(Board::read(config.board_file_path)),
-          dictionary(Dictionary::read(config.dictionary_file_path)) {}
+          session(dictionary,
+                  Board::read(config.board_file_path),
+                  TileBag::read(config.tile_bag_file_path, config.seed),
+                  config.hand_size,
+                  config.seed),
+          record_file_path(config.record_file_path) {}
 
 // Adds players to the scrabble game
 void Scrabble::add_players() {
@@ -30,6 +36,9 @@ void Scrabble::add_players() {
     // Confirm to user the number of players
     cout << num_players << " players confirmed." << endl;
 
+    // Computer players work out the unseen tiles from the bag as it was before anyone drew
+    const TileBag full_bag = session.get_tile_bag();
+
     // Query each player for name, create the player, give player initial tiles, confirm player added
     for (int i = 0; i < num_players; i++) {
         cout << "Please enter name for player " << i + 1 << ": ";
@@ -42,15 +51,15 @@ void Scrabble::add_players() {
 
         shared_ptr<Player> new_player; //nullptr
         if (is_computer == "y"){
-            new_player = make_shared<ComputerPlayer>(player_name, hand_size); // calls constructor
+            shared_ptr<ComputerPlayer> computer = make_shared<ComputerPlayer>(player_name, hand_size);
+            computer->enable_exchanges(full_bag);
+            new_player = computer;
         } else {
             new_player = make_shared<HumanPlayer>(player_name, hand_size);
             num_human_players++;
         }
 
-        players.push_back(new_player);
-        auto new_player_tiles = tile_bag.remove_random_tiles(hand_size);
-        players[i]->add_tiles(new_player_tiles);
+        session.add_player(new_player);
         cout << "Player " << i + 1 << ", named \"" << player_name << "\" has been added." << endl;
     }
 }
@@ -58,98 +67,24 @@ void Scrabble::add_players() {
 // Game Loop should cycle through players and get and execute that players move
 // until the game is over.
 void Scrabble::game_loop() {
-    bool game_over = false;
-    int consecutive_passes = 0;
-    while (game_over == false) {
-
-        // Plays scrabbles looping through all the players
-        for (int i = 0; i < players.size(); i++) {
-            if (game_over == true) {
-                break;
-            }
-
-            // Show player current state of the board
-            board.print(cout);
-
-            // Query player for turn
-            Move player_move = players[i]->get_move(board, dictionary);
-
-            // If the move was PLACE
-            if (player_move.kind == MoveKind::PLACE) {
-                consecutive_passes = 0;
-
-                // Place the move
-                auto place_results = board.place(player_move);
-
-                // Add the points from the move
-                int new_points = 0;
-                players[i]->add_points(place_results.points);
-                new_points += place_results.points;
-                if (player_move.tiles.size() == hand_size) {
-                    players[i]->add_points(50);
-                    new_points += 50;
-                }
-
-                // Show player the points
-                cout << "You gained " << SCORE_COLOR << new_points << rang::style::reset << " points!" << endl;
-
-                // Remove the placed tiles
-                players[i]->remove_tiles(player_move.tiles);
-
-                // Give the player new tiles
-                // If the tile bag has more tiles than the placed tiles give new tiles equal to placed tiles, otherwise
-                // give the rest of tiles
-                if (tile_bag.count_tiles() > player_move.tiles.size()) {
-                    auto new_tiles = tile_bag.remove_random_tiles(player_move.tiles.size());
-                    players[i]->add_tiles(new_tiles);
-                } else {
-                    auto new_tiles = tile_bag.remove_random_tiles(tile_bag.count_tiles());
-                    players[i]->add_tiles(new_tiles);
-                }
-            }
-
-            // If the move was EXCHANGE
-            if (player_move.kind == MoveKind::EXCHANGE) {
-                consecutive_passes = 0;
-
-                // Remove exchanged tiles
-                players[i]->remove_tiles(player_move.tiles);
-
-                // Add exchanged tiles to tile bag
-                for (int j = 0; j < player_move.tiles.size(); j++) {
-                    tile_bag.add_tile(player_move.tiles[j]);
-                }
-
-                // Give the player new tiles
-                // If the tile bag has more tiles than the exchanged tiles give new tiles equal to exchanged tiles,
-                // otherwise give the rest of tiles
-                if (tile_bag.count_tiles() > player_move.tiles.size()) {
-                    auto new_tiles = tile_bag.remove_random_tiles(player_move.tiles.size());
-                    players[i]->add_tiles(new_tiles);
-                } else {
-                    auto new_tiles = tile_bag.remove_random_tiles(tile_bag.count_tiles());
-                    players[i]->add_tiles(new_tiles);
-                }
-            }
-
-            // If the move was PASS
-            if (player_move.kind == MoveKind::PASS && players[i]->is_human() == true) {
-                consecutive_passes++;
-            }
-
-            // Show the current score and wait for enter
-            cout << "Your current score: " << SCORE_COLOR << players[i]->get_points() << rang::style::reset << endl;
-            cout << endl << "Press [enter] to continue.";
-            cin.ignore();
-
-            // Check game over conditions
-            if (players[i]->count_tiles() == 0 && tile_bag.count_tiles() == 0) {
-                game_over = true;
-            }
-            if (consecutive_passes == num_players) {
-                game_over = true;
-            }
+    vector<shared_ptr<Player>>& players = session.get_players();
+    while (!session.is_over()) {
+        // Show player current state of the board
+        session.get_board().print(cout);
+
+        // Query player for turn and execute it
+        GameSession::TurnResult result = session.play_turn();
+
+        // Show player the points
+        if (result.kind == MoveKind::PLACE) {
+            cout << "You gained " << SCORE_COLOR << result.points << rang::style::reset << " points!" << endl;
         }
+
+        // Show the current score and wait for enter
+        cout << "Your current score: " << SCORE_COLOR << players[result.player_index]->get_points()
+             << rang::style::reset << endl;
+        cout << endl << "Press [enter] to continue.";
+        cin.ignore();
     }
 }
 
@@ -178,7 +113,7 @@ void Scrabble::final_subtraction(vector<shared_ptr<Player>>& plrs) {
 void Scrabble::print_result() {
     // Determine highest score
     size_t max_points = 0;
-    for (auto player : this->players) {
+    for (auto player : session.get_players()) {
         if (player->get_points() > max_points) {
             max_points = player->get_points();
         }
@@ -186,7 +121,7 @@ void Scrabble::print_result() {
 
     // Determine the winner(s) indexes
     vector<shared_ptr<Player>> winners;
-    for (auto player : this->players) {
+    for (auto player : session.get_players()) {
         if (player->get_points() >= max_points) {
             winners.push_back(player);
         }
@@ -205,7 +140,7 @@ void Scrabble::print_result() {
     // Justify all integers printed to have the same amount of character as the high score, left-padding with spaces
     cout << setw(static_cast<uint32_t>(floor(log10(max_points) + 1)));
 
-    for (auto player : this->players) {
+    for (auto player : session.get_players()) {
         cout << SCORE_COLOR << player->get_points() << rang::style::reset << " | " << PLAYER_NAME_COLOR
              << player->get_name() << rang::style::reset << endl;
     }
@@ -215,6 +150,9 @@ void Scrabble::print_result() {
 void Scrabble::main() {
     add_players();
     game_loop();
-    final_subtraction(this->players);
+    final_subtraction(session.get_players());
     print_result();
+    if (!record_file_path.empty()) {
+        session.get_record().write(record_file_path);
+    }
 }
@@ -11,6 +11,7 @@
 #include "rang.h"
 #include "move.h"
 #include "colors.h"
+#include "game_session.h"
 #include <cmath>
 #include <memory>
 
@@ -19,9 +20,13 @@ class Scrabble {
 public:
     Scrabble(const ScrabbleConfig& config);
 
+    // Plays with a lexicon shared with other games (e.g. one taken from a LexiconRegistry) instead of reading
+    // config.dictionary_file_path. The game keeps this snapshot for its whole lifetime.
+    Scrabble(const ScrabbleConfig& config, std::shared_ptr<const Dictionary> dictionary);
+
     void main();
 
-    static const size_t EMPTY_HAND_BONUS = 50;
+    static const size_t EMPTY_HAND_BONUS = GameSession::EMPTY_HAND_BONUS;
 
     static void final_subtraction(std::vector<std::shared_ptr<Player>>& players); // public for testing
 
@@ -32,10 +37,9 @@ private:
     size_t hand_size;
     size_t minimum_word_length;
 
-    TileBag tile_bag;
-    Board board;
-    Dictionary dictionary;
-    std::vector<std::shared_ptr<Player>> players;
+    // Board, tile bag, dictionary and players live in the session
+    GameSession session;
+    std::string record_file_path;  // Where to save the game record, empty for none
 
     void add_players();
     void game_loop();
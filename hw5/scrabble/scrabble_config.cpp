@@ -65,6 +65,8 @@ ScrabbleConfig ScrabbleConfig::read(string file_path) {
                     config.tile_bag_file_path = value_buffer;
                 } else if (key_buffer == "DICTIONARY") {
                     config.dictionary_file_path = value_buffer;
+                } else if (key_buffer == "RECORD") {
+                    config.record_file_path = value_buffer;
                 }
                 state = ParserState::LOOKING_FOR_KEY;
             } else {
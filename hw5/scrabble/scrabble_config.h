@@ -13,6 +13,7 @@ public:
     std::string board_file_path;
     std::string tile_bag_file_path;
     std::string dictionary_file_path;
+    std::string record_file_path;  // Optional, the finished game is saved here as a GameRecord
 
     static ScrabbleConfig read(std::string file_path);
 };
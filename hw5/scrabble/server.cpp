@@ -0,0 +1,203 @@
+#include "computer_player.h"
+#include "exceptions.h"
+#include "human_player.h"
+#include "lexicon_registry.h"
+#include "scrabble.h"
+#include "scrabble_config.h"
+#include "session_manager.h"
+#include <algorithm>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+// Hosts many games in one process, multiplexed over stdin/stdout with one command per line:
+//
+//     new <name> [<name> ...]               start a game, names ending in '*' are computer players
+//     <game> place <-|> <row> <column> <tiles>
+//     <game> exchange <tiles>
+//     <game> pass
+//     <game> board
+//     <game> close
+//     quit
+//
+// Every reply starts with the id of the game it is about. Computer players move as soon as it is their turn.
+
+mutex output_mutex;
+
+void say(size_t game, const string& message) {
+    lock_guard<mutex> lock(output_mutex);
+    cout << game << ' ' << message << endl;
+}
+
+void report(size_t game, GameSession& session, const GameSession::TurnResult& result) {
+    const Player& player = *session.get_players()[result.player_index];
+    ostringstream out;
+    out << player.get_name() << ' ';
+    if (result.kind == MoveKind::PLACE) {
+        out << "place +" << result.points;
+    } else if (result.kind == MoveKind::EXCHANGE) {
+        out << "exchange";
+    } else {
+        out << "pass";
+    }
+    out << " score " << player.get_points();
+    say(game, out.str());
+
+    if (result.game_over) {
+        Scrabble::final_subtraction(session.get_players());
+        ostringstream scores;
+        scores << "over";
+        for (auto p : session.get_players()) {
+            scores << ' ' << p->get_name() << '=' << p->get_points();
+        }
+        say(game, scores.str());
+    }
+}
+
+// Plays computer turns until it is a human's turn or the game ends
+void play_computers(size_t game, GameSession& session) {
+    while (!session.is_over() && !session.get_players()[session.get_current_player()]->is_human()) {
+        report(game, session, session.play_turn());
+    }
+    if (!session.is_over()) {
+        say(game, "turn " + session.get_players()[session.get_current_player()]->get_name());
+    }
+}
+
+void play_human(size_t game, GameSession& session, string command) {
+    if (session.is_over()) {
+        say(game, "error game is over");
+        return;
+    }
+
+    auto human = dynamic_pointer_cast<HumanPlayer>(session.get_players()[session.get_current_player()]);
+    transform(command.begin(), command.end(), command.begin(), ::toupper);
+    try {
+        Move move = human->parse_move(command);
+        session.check_move(move);
+        report(game, session, session.apply_move(move));
+    } catch (const CommandException& e) {
+        say(game, string("error ") + e.what());
+        return;
+    } catch (const MoveException& e) {
+        say(game, string("error ") + e.what());
+        return;
+    }
+    play_computers(game, session);
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 3) {
+        cerr << "Usage: " << argv[0] << " <configuration file> [worker threads]" << endl;
+        return 1;
+    }
+
+    ScrabbleConfig config;
+    LexiconRegistry lexicons;
+    try {
+        config = ScrabbleConfig::read(argv[1]);
+        lexicons.load("default", config.dictionary_file_path);
+    } catch (const FileException& e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    size_t worker_count = thread::hardware_concurrency();
+    if (argc == 3) {
+        try {
+            worker_count = stoul(argv[2]);
+        } catch (const exception& e) {
+            cerr << "Usage: " << argv[0] << " <configuration file> [worker threads]" << endl;
+            return 1;
+        }
+    }
+    SessionManager manager(worker_count);
+
+    string line;
+    while (getline(cin, line)) {
+        istringstream ss(line);
+        string first;
+        if (!(ss >> first)) {
+            continue;
+        }
+
+        if (first == "quit") {
+            break;
+        }
+
+        if (first == "new") {
+            vector<string> names;
+            string name;
+            while (ss >> name) {
+                names.push_back(name);
+            }
+            if (names.empty()) {
+                cerr << "new needs at least one player" << endl;
+                continue;
+            }
+
+            // Every game draws its own tiles, keyed by its id
+            size_t game = manager.create_session(config, lexicons.get("default"));
+            manager.submit(game, [game, names](GameSession& session) {
+                const TileBag full_bag = session.get_tile_bag();
+                for (string name : names) {
+                    size_t hand_size = session.get_hand_size();
+                    if (name.back() == '*') {
+                        name.pop_back();
+                        shared_ptr<ComputerPlayer> computer = make_shared<ComputerPlayer>(name, hand_size);
+                        computer->enable_exchanges(full_bag);
+                        session.add_player(computer);
+                    } else {
+                        session.add_player(make_shared<HumanPlayer>(name, hand_size));
+                    }
+                }
+                say(game, "created");
+                play_computers(game, session);
+            });
+            continue;
+        }
+
+        size_t game;
+        string command;
+        try {
+            game = stoul(first);
+        } catch (const exception& e) {
+            cerr << "unknown command: " << line << endl;
+            continue;
+        }
+        ss >> command;
+        string rest;
+        getline(ss, rest);
+
+        try {
+            if (command == "board") {
+                manager.submit(game, [game](GameSession& session) {
+                    // Every line of the board gets the id, so boards of different games can be told apart
+                    ostringstream board;
+                    session.get_board().print(board);
+                    istringstream lines(board.str());
+                    lock_guard<mutex> lock(output_mutex);
+                    for (string row; getline(lines, row);) {
+                        cout << game << ' ' << row << '\n';
+                    }
+                    cout.flush();
+                });
+            } else if (command == "close") {
+                manager.close_session(game);
+            } else {
+                manager.submit(game, [game, command, rest](GameSession& session) {
+                    play_human(game, session, command + rest);
+                });
+            }
+        } catch (const out_of_range& e) {
+            say(game, "error no such game");
+        }
+    }
+
+    manager.wait_idle();
+    return 0;
+}
@@ -0,0 +1,156 @@
+#include "session_manager.h"
+
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+SessionManager::SessionManager(size_t worker_count) {
+    if (worker_count == 0) {
+        worker_count = 1;
+    }
+    for (size_t i = 0; i < worker_count; i++) {
+        workers.emplace_back(&SessionManager::work, this);
+    }
+}
+
+SessionManager::~SessionManager() {
+    wait_idle();
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        stopping = true;
+    }
+    queue_ready.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+}
+
+size_t SessionManager::create_session(const ScrabbleConfig& config, shared_ptr<const Dictionary> dictionary) {
+    size_t id;
+    {
+        lock_guard<mutex> lock(sessions_mutex);
+        id = next_id++;
+    }
+
+    shared_ptr<Entry> entry;
+    {
+        // Parse each layout and bag file once, later games copy the parsed version
+        lock_guard<mutex> lock(templates_mutex);
+        auto board = boards.find(config.board_file_path);
+        if (board == boards.end()) {
+            board = boards.emplace(config.board_file_path, Board::read(config.board_file_path)).first;
+        }
+        auto tile_bag = tile_bags.find(config.tile_bag_file_path);
+        if (tile_bag == tile_bags.end()) {
+            TileBag parsed = TileBag::read(config.tile_bag_file_path, config.seed);
+            tile_bag = tile_bags.emplace(config.tile_bag_file_path, parsed).first;
+        }
+        entry = make_shared<Entry>(
+                GameSession(dictionary, board->second, tile_bag->second, config.hand_size, config.seed, id));
+    }
+
+    lock_guard<mutex> lock(sessions_mutex);
+    sessions.emplace(id, entry);
+    return id;
+}
+
+void SessionManager::submit(size_t session_id, Task task) {
+    shared_ptr<Entry> entry;
+    {
+        lock_guard<mutex> lock(sessions_mutex);
+        auto it = sessions.find(session_id);
+        if (it == sessions.end()) {
+            throw out_of_range("no such game");
+        }
+        entry = it->second;
+    }
+
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        outstanding++;
+    }
+
+    bool needs_worker;
+    {
+        lock_guard<mutex> lock(entry->mutex);
+        entry->pending.push_back(task);
+        needs_worker = !entry->scheduled;
+        entry->scheduled = true;
+    }
+    // If a worker already has this game it picks the new task up when it is done with the current ones
+    if (needs_worker) {
+        schedule(entry);
+    }
+}
+
+void SessionManager::close_session(size_t session_id) {
+    lock_guard<mutex> lock(sessions_mutex);
+    sessions.erase(session_id);
+}
+
+size_t SessionManager::count_sessions() const {
+    lock_guard<mutex> lock(sessions_mutex);
+    return sessions.size();
+}
+
+void SessionManager::wait_idle() {
+    unique_lock<mutex> lock(queue_mutex);
+    queue_idle.wait(lock, [this] { return outstanding == 0; });
+}
+
+void SessionManager::schedule(shared_ptr<Entry> entry) {
+    {
+        lock_guard<mutex> lock(queue_mutex);
+        ready.push_back(entry);
+    }
+    queue_ready.notify_one();
+}
+
+void SessionManager::work() {
+    while (true) {
+        shared_ptr<Entry> entry;
+        {
+            unique_lock<mutex> lock(queue_mutex);
+            queue_ready.wait(lock, [this] { return stopping || !ready.empty(); });
+            if (ready.empty()) {
+                return;
+            }
+            entry = ready.front();
+            ready.pop_front();
+        }
+
+        // Only this worker holds the game until scheduled is cleared, so its tasks run one at a time
+        vector<Task> batch;
+        {
+            lock_guard<mutex> lock(entry->mutex);
+            batch.swap(entry->pending);
+        }
+        for (size_t i = 0; i < batch.size(); i++) {
+            try {
+                batch[i](entry->session);
+            } catch (const exception& e) {
+                cerr << "game task failed: " << e.what() << endl;
+            }
+        }
+
+        // Tasks submitted while the batch ran go to the back of the queue so other games get a turn
+        bool more;
+        {
+            lock_guard<mutex> lock(entry->mutex);
+            more = !entry->pending.empty();
+            entry->scheduled = more;
+        }
+        if (more) {
+            schedule(entry);
+        }
+
+        {
+            lock_guard<mutex> lock(queue_mutex);
+            outstanding -= batch.size();
+            if (outstanding == 0) {
+                queue_idle.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#ifndef SESSION_MANAGER_H
+#define SESSION_MANAGER_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "game_session.h"
+#include "scrabble_config.h"
+#include "tile_bag.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ Hosts many concurrent games in one process.
+
+ Work for a game is submitted as a task. A fixed pool of worker threads runs the tasks; tasks for the same game run one
+ at a time and in the order they were submitted, while different games run in parallel. Games share their dictionary
+ and the parsed board and tile bag files, so an idle game only costs its own board, bag and hands.
+*/
+class SessionManager {
+public:
+    typedef std::function<void(GameSession&)> Task;
+
+    explicit SessionManager(size_t worker_count);
+    ~SessionManager();
+
+    SessionManager(const SessionManager&) = delete;
+    SessionManager& operator=(const SessionManager&) = delete;
+
+    /*
+    Creates a game with no players. The board and tile bag files named in config are read the first time they are
+    seen and copied for every later game; the game's copy of the bag draws from (config.seed, game id).
+    Returns the id of the new game.
+    */
+    size_t create_session(const ScrabbleConfig& config, std::shared_ptr<const Dictionary> dictionary);
+
+    /*
+    Queues task to run against a game.
+    Throws std::out_of_range if there is no game with this id.
+    */
+    void submit(size_t session_id, Task task);
+
+    // Forgets a game. Tasks already queued for it still run.
+    void close_session(size_t session_id);
+
+    size_t count_sessions() const;
+
+    // Blocks until every task submitted so far has run.
+    void wait_idle();
+
+private:
+    struct Entry {
+        GameSession session;
+        std::mutex mutex;
+        std::vector<Task> pending;
+        bool scheduled = false;  // Queued for, or held by, a worker
+
+        Entry(const GameSession& session) : session(session) {}
+    };
+
+    mutable std::mutex sessions_mutex;
+    std::map<size_t, std::shared_ptr<Entry>> sessions;
+    size_t next_id = 0;
+
+    std::mutex templates_mutex;
+    std::map<std::string, Board> boards;
+    std::map<std::string, TileBag> tile_bags;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_ready;
+    std::condition_variable queue_idle;
+    std::deque<std::shared_ptr<Entry>> ready;
+    size_t outstanding = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    void work();
+    void schedule(std::shared_ptr<Entry> entry);
+};
+
+#endif
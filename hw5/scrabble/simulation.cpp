@@ -0,0 +1,115 @@
+#include "simulation.h"
+
+#include "computer_player.h"
+#include "game_session.h"
+#include "scrabble.h"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+Simulation::Simulation(
+        shared_ptr<const Dictionary> dictionary,
+        const Board& board,
+        const TileBag& tile_bag,
+        size_t hand_size,
+        size_t player_count,
+        uint32_t seed)
+        : dictionary(dictionary),
+          board(board),
+          tile_bag(tile_bag),
+          hand_size(hand_size),
+          player_count(player_count),
+          seed(seed) {}
+
+Simulation::Result Simulation::play_game(uint64_t game) const {
+    GameSession session(dictionary, board, tile_bag, hand_size, seed, game);
+    for (size_t i = 0; i < player_count; i++) {
+        shared_ptr<ComputerPlayer> player = make_shared<ComputerPlayer>("cpu" + to_string(i + 1), hand_size);
+        player->enable_exchanges(tile_bag);
+        session.add_player(player);
+    }
+    return play_out(session, game, SIZE_MAX);
+}
+
+Simulation::Result Simulation::play_from(
+        const Board& board,
+        const vector<vector<TileKind>>& racks,
+        const vector<TileKind>& bag,
+        uint64_t game,
+        size_t max_turns) const {
+    TileBag dealt = tile_bag;
+    dealt.stack(bag);
+    GameSession session(dictionary, board, dealt, hand_size, seed, game);
+    for (size_t i = 0; i < racks.size(); i++) {
+        shared_ptr<ComputerPlayer> player = make_shared<ComputerPlayer>("cpu" + to_string(i + 1), hand_size);
+        player->enable_exchanges(tile_bag);
+        session.add_player(player, racks[i]);
+    }
+    return play_out(session, game, max_turns);
+}
+
+Simulation::Result Simulation::play_deal(
+        const Board& board,
+        const vector<TileKind>& own_rack,
+        RackInference& inference,
+        uint64_t game,
+        size_t max_turns) const {
+    vector<vector<TileKind>> racks(2);
+    vector<TileKind> bag;
+    inference.sample_deal(racks[0], bag);
+    racks[1] = own_rack;
+    return play_from(board, racks, bag, game, max_turns);
+}
+
+vector<Simulation::Result> Simulation::play_games(uint64_t first_game, size_t count, size_t thread_count) const {
+    vector<Result> results(count);
+    // Threads take the next unplayed game; each result goes to its game's slot, so the order of play does not matter
+    atomic<size_t> next(0);
+    mutex error_mutex;
+    exception_ptr error;
+    auto work = [&]() {
+        try {
+            for (size_t i = next++; i < count; i = next++) {
+                results[i] = play_game(first_game + i);
+            }
+        } catch (...) {
+            lock_guard<mutex> lock(error_mutex);
+            error = current_exception();
+            next = count;
+        }
+    };
+
+    vector<thread> threads;
+    for (size_t i = 1; i < thread_count; i++) {
+        threads.push_back(thread(work));
+    }
+    work();
+    for (thread& t : threads) {
+        t.join();
+    }
+    if (error) {
+        rethrow_exception(error);
+    }
+    return results;
+}
+
+Simulation::Result Simulation::play_out(GameSession& session, uint64_t game, size_t max_turns) const {
+    while (!session.is_over() && session.get_record().turns.size() < max_turns) {
+        session.play_turn();
+    }
+    if (session.is_over()) {
+        Scrabble::final_subtraction(session.get_players());
+    }
+
+    Result result;
+    result.game = game;
+    result.turns = session.get_record().turns.size();
+    for (auto player : session.get_players()) {
+        result.scores.push_back(player->get_points());
+    }
+    return result;
+}
@@ -0,0 +1,82 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "board.h"
+#include "dictionary.h"
+#include "rack_inference.h"
+#include "tile_bag.h"
+#include "tile_kind.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class GameSession;
+
+/*
+ Plays computer-only games for bulk experiments.
+
+ Game n of a batch draws its tiles from (seed, n) (see GameRandom) and computer players have no randomness of their
+ own, so a game's result depends only on its id: play_games() gives identical results for any thread count or
+ scheduling, and any one game of a batch can be played again alone with play_game().
+*/
+class Simulation {
+public:
+    struct Result {
+        uint64_t game;
+        std::vector<size_t> scores;  // Final scores, after the end of game subtraction
+        size_t turns;
+    };
+
+    Simulation(
+            std::shared_ptr<const Dictionary> dictionary,
+            const Board& board,
+            const TileBag& tile_bag,
+            size_t hand_size,
+            size_t player_count,
+            uint32_t seed);
+
+    Result play_game(uint64_t game) const;
+
+    /*
+    Plays on from a game in progress instead of a new one: racks are in turn order from the player to move, and bag
+    is drawn in order (see TileBag::stack), so the game depends only on these and game, which seeds the draws after
+    exchanges. There are racks.size() players. Stops after max_turns turns; the scores are the points made from board
+    on, less the end of game subtraction if the game ended.
+    */
+    Result play_from(
+            const Board& board,
+            const std::vector<std::vector<TileKind>>& racks,
+            const std::vector<TileKind>& bag,
+            uint64_t game,
+            size_t max_turns = SIZE_MAX) const;
+
+    /*
+    play_from() one way inference deals the tiles its player has not seen (see RackInference::sample_deal): the
+    opponent moves first with the sampled rack, then the player with own_rack.
+    */
+    Result play_deal(
+            const Board& board,
+            const std::vector<TileKind>& own_rack,
+            RackInference& inference,
+            uint64_t game,
+            size_t max_turns = SIZE_MAX) const;
+
+    /*
+    Plays games first_game to first_game + count - 1 on thread_count threads. Results are in game order.
+    If a game throws, the other threads stop taking new games and the exception is rethrown here.
+    */
+    std::vector<Result> play_games(uint64_t first_game, size_t count, size_t thread_count) const;
+
+private:
+    std::shared_ptr<const Dictionary> dictionary;
+    Board board;
+    TileBag tile_bag;
+    size_t hand_size;
+    size_t player_count;
+    uint32_t seed;
+
+    // Plays session's turns until the game ends or max_turns have been played in all
+    Result play_out(GameSession& session, uint64_t game, size_t max_turns) const;
+};
+
+#endif
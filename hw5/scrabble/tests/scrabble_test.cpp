@@ -2,6 +2,8 @@
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <sstream>
+#include <chrono>
 
 #include "scrabble_config.h"
 #include "board.h"
@@ -9,6 +11,20 @@
 #include "tile_kind.h"
 #include "human_player.h"
 #include "computer_player.h"
+#include "lexicon_registry.h"
+#include "session_manager.h"
+#include "game_record.h"
+#include "position_corpus.h"
+#include "fixed_board.h"
+#include "board_rules.h"
+#include "simulation.h"
+#include "turn_profile.h"
+#include "rack_inference.h"
+#include "exchange_evaluator.h"
+#include "arena.h"
+#include <random>
+#include <thread>
+#include <unordered_set>
 
 #define DICT_PATH "config/english-dictionary.txt"
 
@@ -104,6 +120,446 @@ TEST_F(DictionaryTest, find_prefix_null) {
 }
 
 
+class LexiconRegistryTest : public testing::Test {
+protected:
+	LexiconRegistryTest() {}
+	virtual ~LexiconRegistryTest() {}
+	LexiconRegistry registry;
+	Dictionary d = Dictionary::read(DICT_PATH);
+};
+
+TEST_F(LexiconRegistryTest, publish_and_get) {
+	EXPECT_FALSE(registry.contains("en"));
+	EXPECT_EQ(registry.publish("en", make_shared<const Dictionary>(d)), 1);
+	EXPECT_TRUE(registry.contains("en"));
+	EXPECT_TRUE(registry.get("en")->is_word("hello"));
+	EXPECT_THROW(registry.get("fr"), std::out_of_range);
+}
+
+TEST_F(LexiconRegistryTest, in_flight_snapshot_survives_publish) {
+	registry.publish("en", make_shared<const Dictionary>(d));
+	LexiconRegistry::Lexicon in_flight = registry.get("en");
+	weak_ptr<const Dictionary> old_version = in_flight;
+
+	EXPECT_EQ(registry.publish("en", make_shared<const Dictionary>(d)), 2);
+	EXPECT_EQ(registry.get_snapshot("en").version, 2);
+	EXPECT_NE(registry.get("en"), in_flight);
+	EXPECT_FALSE(old_version.expired());
+	EXPECT_TRUE(in_flight->is_word("hi"));
+
+	// Old version is freed once the last game holding it lets go
+	in_flight.reset();
+	EXPECT_TRUE(old_version.expired());
+}
+
+TEST_F(LexiconRegistryTest, remove_keeps_readers) {
+	registry.publish("en", make_shared<const Dictionary>(d));
+	LexiconRegistry::Lexicon in_flight = registry.get("en");
+	registry.remove("en");
+	EXPECT_FALSE(registry.contains("en"));
+	EXPECT_TRUE(in_flight->is_word("hello"));
+}
+
+class GameSessionTest : public testing::Test {
+protected:
+	GameSessionTest() {}
+	virtual ~GameSessionTest() {}
+	ScrabbleConfig config = ScrabbleConfig::read("config/small-config.txt");
+	shared_ptr<const Dictionary> d = make_shared<const Dictionary>(Dictionary::read(DICT_PATH));
+};
+
+TEST_F(GameSessionTest, everyone_passing_ends_game) {
+	GameSession session(d, Board::read(config.board_file_path), TileBag::read(config.tile_bag_file_path, config.seed), 3, config.seed);
+	size_t bag_size = session.get_tile_bag().count_tiles();
+	session.add_player(make_shared<HumanPlayer>("a", 3));
+	session.add_player(make_shared<HumanPlayer>("b", 3));
+	EXPECT_EQ(session.get_players()[0]->count_tiles(), 3);
+	EXPECT_EQ(session.get_tile_bag().count_tiles(), bag_size - 6);
+
+	GameSession::TurnResult first = session.apply_move(Move());
+	EXPECT_EQ(first.player_index, 0);
+	EXPECT_FALSE(first.game_over);
+	EXPECT_EQ(session.get_current_player(), 1);
+
+	GameSession::TurnResult second = session.apply_move(Move());
+	EXPECT_EQ(second.player_index, 1);
+	EXPECT_TRUE(second.game_over);
+	EXPECT_TRUE(session.is_over());
+
+	EXPECT_EQ(session.get_record().seed, config.seed);
+	EXPECT_EQ(session.get_record().players.size(), 2);
+	EXPECT_EQ(session.get_record().turns.size(), 2);
+}
+
+TEST_F(GameSessionTest, check_move_rejects_non_words) {
+	GameSession session(d, Board::read(config.board_file_path), TileBag::read(config.tile_bag_file_path, config.seed), 3, config.seed);
+	session.add_player(make_shared<HumanPlayer>("a", 3));
+
+	vector<TileKind> t;
+	t.push_back(TileKind('Z', 10));
+	t.push_back(TileKind('Q', 10));
+	EXPECT_THROW(session.check_move(Move(t, 3, 3, Direction::ACROSS)), MoveException);
+	// Does not touch the start square
+	EXPECT_THROW(session.check_move(Move(t, 0, 0, Direction::ACROSS)), MoveException);
+
+	vector<TileKind> hi;
+	hi.push_back(TileKind('H', 4));
+	hi.push_back(TileKind('I', 1));
+	EXPECT_NO_THROW(session.check_move(Move(hi, 3, 3, Direction::ACROSS)));
+}
+
+TEST_F(GameSessionTest, manager_runs_one_game_in_order) {
+	SessionManager manager(4);
+	vector<vector<int>> seen(3);
+	for (size_t i = 0; i < seen.size(); ++i) {
+		EXPECT_EQ(manager.create_session(config, d), i);
+	}
+	EXPECT_EQ(manager.count_sessions(), 3);
+
+	for (int step = 0; step < 300; ++step) {
+		for (size_t game = 0; game < seen.size(); ++game) {
+			vector<int>* out = &seen[game];
+			manager.submit(game, [out, step](GameSession&) { out->push_back(step); });
+		}
+	}
+	manager.wait_idle();
+
+	for (size_t game = 0; game < seen.size(); ++game) {
+		ASSERT_EQ(seen[game].size(), 300);
+		for (int step = 0; step < 300; ++step) {
+			EXPECT_EQ(seen[game][step], step);
+		}
+	}
+
+	manager.close_session(1);
+	EXPECT_EQ(manager.count_sessions(), 2);
+	EXPECT_THROW(manager.submit(1, [](GameSession&) {}), std::out_of_range);
+}
+
+TEST_F(GameSessionTest, draws_depend_only_on_seed_and_game) {
+	GameRandom random(config.seed, 12);
+	GameRandom same(config.seed, 12);
+	GameRandom other(config.seed, 13);
+	EXPECT_EQ(random.at(5), same.at(5));
+	for (size_t i = 0; i < 5; i++) {
+		random.next();
+	}
+	EXPECT_EQ(random.next(), same.at(5));
+	EXPECT_NE(other.at(5), same.at(5));
+	for (size_t i = 0; i < 1000; i++) {
+		EXPECT_LT(random.below(7), 7);
+	}
+
+	TileBag bag = TileBag::read(config.tile_bag_file_path, config.seed);
+	TileBag first = bag;
+	TileBag second = bag;
+	first.reseed(config.seed, 3);
+	second.reseed(config.seed, 3);
+	vector<TileKind> a = first.remove_random_tiles(6);
+	vector<TileKind> b = second.remove_random_tiles(6);
+	ASSERT_EQ(a.size(), b.size());
+	for (size_t i = 0; i < a.size(); i++) {
+		EXPECT_EQ(a[i].letter, b[i].letter);
+	}
+}
+
+TEST_F(GameSessionTest, simulation_independent_of_threads) {
+	Simulation simulation(
+			d, Board::read(config.board_file_path), TileBag::read(config.tile_bag_file_path, 0), 3, 2, config.seed);
+	vector<Simulation::Result> serial = simulation.play_games(100, 4, 1);
+	vector<Simulation::Result> parallel = simulation.play_games(100, 4, 3);
+	ASSERT_EQ(serial.size(), 4);
+	ASSERT_EQ(parallel.size(), 4);
+	for (size_t i = 0; i < serial.size(); i++) {
+		EXPECT_EQ(parallel[i].game, 100 + i);
+		EXPECT_EQ(parallel[i].scores, serial[i].scores);
+		EXPECT_EQ(parallel[i].turns, serial[i].turns);
+	}
+
+	// Any game of the batch can be played again on its own
+	Simulation::Result again = simulation.play_game(102);
+	EXPECT_GT(again.turns, 0);
+	EXPECT_EQ(again.scores, serial[2].scores);
+	EXPECT_EQ(again.turns, serial[2].turns);
+}
+
+TEST_F(GameSessionTest, simulation_from_sampled_deal) {
+	Board board = Board::read("config/standard-board.txt");
+	TileBag full_bag = TileBag::read("config/english-tile-bag.txt", config.seed);
+	TileBag bag = full_bag;
+	vector<TileKind> own = bag.remove_random_tiles(7);
+	Simulation simulation(d, board, full_bag, 7, 2, config.seed);
+
+	// The same estimate deals the same tiles, which the opponent plays the same way
+	RackInference first(full_bag, board, own, 7, 5, 100);
+	RackInference second(full_bag, board, own, 7, 5, 100);
+	Simulation::Result reply = simulation.play_deal(board, own, first, 9, 1);
+	Simulation::Result again = simulation.play_deal(board, own, second, 9, 1);
+	EXPECT_EQ(reply.turns, 1);
+	EXPECT_EQ(reply.scores, again.scores);
+	EXPECT_EQ(reply.scores[1], 0);
+
+	// That reply is the move of a player holding the sampled rack
+	RackInference third(full_bag, board, own, 7, 5, 100);
+	vector<TileKind> rack;
+	vector<TileKind> rest;
+	third.sample_deal(rack, rest);
+	ComputerPlayer cpu("cpu", 7);
+	cpu.enable_exchanges(full_bag);
+	cpu.add_tiles(rack);
+	Move move = cpu.get_move(board, *d);
+	size_t points = 0;
+	if (move.kind == MoveKind::PLACE) {
+		points = board.test_place(move).points + (move.tiles.size() == 7 ? GameSession::EMPTY_HAND_BONUS : 0);
+	}
+	EXPECT_EQ(reply.scores[0], points);
+
+	// The rest of the deal is drawn in order, and the whole game plays out the same way again
+	TileBag stacked = full_bag;
+	stacked.stack(rest);
+	EXPECT_EQ(stacked.count_tiles(), rest.size());
+	vector<TileKind> drawn = stacked.remove_random_tiles(3);
+	ASSERT_EQ(drawn.size(), 3);
+	for (size_t i = 0; i < drawn.size(); i++) {
+		EXPECT_EQ(drawn[i].letter, rest[i].letter);
+	}
+	vector<vector<TileKind>> racks = {rack, own};
+	Simulation::Result game = simulation.play_from(board, racks, rest, 9);
+	EXPECT_GT(game.turns, 1);
+	EXPECT_EQ(simulation.play_from(board, racks, rest, 9).scores, game.scores);
+}
+
+class GameRecordTest : public testing::Test {
+protected:
+	GameRecordTest() {}
+	virtual ~GameRecordTest() {}
+	GameRecord sample();
+};
+
+GameRecord GameRecordTest::sample() {
+	GameRecord record;
+	record.seed = 71543;
+	record.game = 9000000001;
+	record.players.push_back("alice");
+	record.players.push_back("bob");
+
+	vector<TileKind> hi;
+	hi.push_back(TileKind('H', 4));
+	hi.push_back(TileKind('I', 1));
+	record.turns.push_back(GameRecord::Turn(0, Move(hi, 7, 7, Direction::ACROSS), 10, 10));
+
+	vector<TileKind> swap;
+	swap.push_back(TileKind('Q', 10));
+	record.turns.push_back(GameRecord::Turn(1, Move(swap), 0, 0));
+
+	vector<TileKind> blank;
+	blank.push_back(TileKind('?', 0, 'a'));
+	blank.push_back(TileKind('T', 1));
+	record.turns.push_back(GameRecord::Turn(0, Move(blank, 8, 7, Direction::DOWN), 3, 13));
+
+	record.turns.push_back(GameRecord::Turn(1, Move(), 0, 0));
+	return record;
+}
+
+TEST_F(GameRecordTest, round_trip) {
+	GameRecord record = sample();
+	stringstream bytes;
+	record.write(bytes);
+	GameRecord back = GameRecord::read(bytes);
+
+	EXPECT_EQ(back.seed, 71543);
+	EXPECT_EQ(back.game, 9000000001);
+	ASSERT_EQ(back.players.size(), 2);
+	EXPECT_EQ(back.players[1], "bob");
+	ASSERT_EQ(back.turns.size(), 4);
+
+	const GameRecord::Turn& place = back.turns[2];
+	EXPECT_EQ(place.player, 0);
+	EXPECT_EQ(place.points, 3);
+	EXPECT_EQ(place.score, 13);
+	EXPECT_TRUE(place.move.kind == MoveKind::PLACE);
+	EXPECT_EQ(place.move.row, 8);
+	EXPECT_EQ(place.move.column, 7);
+	EXPECT_TRUE(place.move.direction == Direction::DOWN);
+	ASSERT_EQ(place.move.tiles.size(), 2);
+	EXPECT_EQ(place.move.tiles[0].letter, '?');
+	EXPECT_EQ(place.move.tiles[0].assigned, 'a');
+	EXPECT_EQ(place.move.tiles[1].points, 1);
+
+	EXPECT_TRUE(back.turns[1].move.kind == MoveKind::EXCHANGE);
+	EXPECT_EQ(back.turns[1].move.tiles[0].letter, 'q');
+	EXPECT_TRUE(back.turns[3].move.kind == MoveKind::PASS);
+}
+
+TEST_F(GameRecordTest, rejects_bad_data) {
+	stringstream not_a_record("hello there");
+	EXPECT_THROW(GameRecord::read(not_a_record), FileException);
+
+	stringstream bytes;
+	sample().write(bytes);
+	string data = bytes.str();
+	stringstream truncated(data.substr(0, data.size() - 3));
+	EXPECT_THROW(GameRecord::read(truncated), FileException);
+}
+
+TEST_F(GameRecordTest, replay_boards) {
+	GameRecord record = sample();
+	GameReplay replay(Board::read("config/standard-board.txt"), record);
+
+	Board after_first = replay.board_at(1);
+	EXPECT_EQ(after_first.get_move_index(), 1);
+	EXPECT_EQ(after_first.letter_at(Board::Position(7, 8)), 'i');
+	EXPECT_FALSE(after_first.in_bounds_and_has_tile(Board::Position(8, 7)));
+
+	Board last = replay.board_at(4);
+	EXPECT_EQ(last.get_move_index(), 2);
+	EXPECT_EQ(last.letter_at(Board::Position(8, 7)), '?');
+	EXPECT_EQ(last.letter_at(Board::Position(9, 7)), 't');
+
+	// Seeking backwards starts over from the empty board
+	EXPECT_EQ(replay.board_at(0).get_move_index(), 0);
+	EXPECT_FALSE(replay.step() && replay.step() && replay.step() && replay.step() && replay.step());
+	EXPECT_EQ(replay.get_turn(), 4);
+}
+
+class BoardSnapshotTest : public testing::Test {
+protected:
+	BoardSnapshotTest() {}
+	virtual ~BoardSnapshotTest() {}
+};
+
+// Every square, multiplier and tile of two boards match
+void expect_same_board(const Board& expected, const Board& actual) {
+	ASSERT_EQ(actual.rows, expected.rows);
+	ASSERT_EQ(actual.columns, expected.columns);
+	EXPECT_EQ(actual.start, expected.start);
+	EXPECT_EQ(actual.get_move_index(), expected.get_move_index());
+	for (size_t i = 0; i < expected.rows; i++) {
+		for (size_t j = 0; j < expected.columns; j++) {
+			Board::Position p(i, j);
+			ASSERT_EQ(actual.in_bounds_and_has_tile(p), expected.in_bounds_and_has_tile(p));
+			if (expected.in_bounds_and_has_tile(p)) {
+				EXPECT_EQ(actual.letter_at(p), expected.letter_at(p));
+			}
+		}
+	}
+}
+
+TEST_F(BoardSnapshotTest, round_trip) {
+	Board board = Board::read("config/standard-board.txt");
+	vector<TileKind> tiles;
+	tiles.push_back(TileKind('?', 0, 'c'));
+	tiles.push_back(TileKind('A', 1));
+	tiles.push_back(TileKind('T', 1));
+	board.place(Move(tiles, 7, 6, Direction::ACROSS));
+
+	string bytes;
+	board.write_snapshot(bytes);
+	EXPECT_EQ(bytes.size(), BoardSnapshot::size_for(15, 15));
+
+	BoardSnapshot snapshot(bytes.data(), bytes.size());
+	EXPECT_EQ(snapshot.get_start_row(), 7);
+	EXPECT_EQ(snapshot.word_multiplier(0, 0), 3);
+	EXPECT_EQ(snapshot.letter_multiplier(1, 5), 3);
+	EXPECT_EQ(snapshot.get_tile_kind(7, 6).assigned, 'c');
+
+	Board copy = Board::read_snapshot(snapshot);
+	expect_same_board(board, copy);
+
+	// The copy keeps its multipliers and start square, so it scores a move the same as the original
+	vector<TileKind> more;
+	more.push_back(TileKind('S', 1));
+	Move plural(more, 7, 9, Direction::ACROSS);
+	EXPECT_EQ(copy.test_place(plural).points, board.test_place(plural).points);
+
+	EXPECT_THROW(BoardSnapshot(bytes.data(), bytes.size() - 1), FileException);
+}
+
+TEST_F(BoardSnapshotTest, corpus) {
+	const string path = "corpus-test.bin";
+	Board board = Board::read("config/standard-board.txt");
+	vector<Board> boards;
+	{
+		PositionCorpusWriter writer(path);
+		for (size_t i = 0; i < 10; i++) {
+			vector<TileKind> tiles;
+			tiles.push_back(TileKind('A' + i, 1));
+			board.place_unchecked(Move(tiles, i, i, Direction::ACROSS));
+			writer.add(board);
+			boards.push_back(board);
+		}
+		EXPECT_EQ(writer.size(), 10);
+	}
+
+	PositionCorpus corpus(path);
+	ASSERT_EQ(corpus.size(), 10);
+	for (size_t i = 0; i < corpus.size(); i++) {
+		EXPECT_EQ(corpus[i].get_move_index(), i + 1);
+		EXPECT_TRUE(corpus[i].has_tile(i, i));
+		expect_same_board(boards[i], corpus.board(i));
+	}
+	EXPECT_THROW(corpus.at(10), out_of_range);
+
+	EXPECT_THROW(PositionCorpus("config/standard-board.txt"), FileException);
+	remove(path.c_str());
+}
+
+class FixedBoardTest : public testing::Test {
+protected:
+	FixedBoardTest() {}
+	virtual ~FixedBoardTest() {}
+};
+
+TEST_F(FixedBoardTest, matches_standard_layout_only) {
+	EXPECT_TRUE(StandardBoard::matches(Board::read("config/standard-board.txt")));
+	EXPECT_FALSE(StandardBoard::matches(Board::read("config/small-board.txt")));
+	EXPECT_FALSE(StandardBoard::matches(Board::read("config/board-tl-start.txt")));
+}
+
+TEST_F(FixedBoardTest, same_rules_as_board) {
+	Board b = Board::read("config/standard-board.txt");
+	vector<TileKind> t;
+	t.push_back(TileKind('H', 4));
+	t.push_back(TileKind('E', 1));
+	t.push_back(TileKind('L', 1));
+	t.push_back(TileKind('L', 1));
+	t.push_back(TileKind('O', 1));
+	b.place(Move(t, 7, 5, Direction::ACROSS));
+	vector<TileKind> down;
+	down.push_back(TileKind('?', 0, 'a'));
+	down.push_back(TileKind('X', 8));
+	b.place(Move(down, 6, 8, Direction::DOWN));
+
+	StandardBoard fixed(b);
+	EXPECT_EQ(fixed.get_move_index(), b.get_move_index());
+
+	vector<Board::Anchor> expected = b.get_anchors();
+	vector<Board::Anchor> actual = fixed.get_anchors();
+	ASSERT_EQ(actual.size(), expected.size());
+	for (size_t i = 0; i < expected.size(); i++) {
+		EXPECT_EQ(actual[i].position, expected[i].position);
+		EXPECT_EQ(actual[i].direction, expected[i].direction);
+		EXPECT_EQ(actual[i].limit, expected[i].limit);
+	}
+
+	// Every two letter move from every anchor scores and fails the same way on both
+	for (const Board::Anchor& anchor : expected) {
+		vector<TileKind> tiles;
+		tiles.push_back(TileKind('Q', 10));
+		tiles.push_back(TileKind('I', 1));
+		Move move(tiles, anchor.position.row, anchor.position.column, anchor.direction);
+		PlaceResult board_result = b.test_place(move);
+		PlaceResult fixed_result = fixed.test_place(move);
+		ASSERT_EQ(fixed_result.valid, board_result.valid);
+		if (board_result.valid) {
+			EXPECT_EQ(fixed_result.points, board_result.points);
+			EXPECT_EQ(fixed_result.words, board_result.words);
+		} else {
+			EXPECT_EQ(fixed_result.error, board_result.error);
+		}
+	}
+}
+
 // Helper functions for placing words in get_anchors() and get_move() tests
 void print_words(PlaceResult res, Move m){
 	std::cout << m.row + 1 << ' ' << m.column + 1 << ' ';
@@ -314,6 +770,32 @@ TEST_F(AnchorTest, two_words_1) {
 	EXPECT_TRUE(anchor_lookup(a, Board::Anchor(Board::Position(5,6), Direction::DOWN, 5)));
 }
 
+TEST_F(AnchorTest, bitboards_match_square_scan) {
+	const char* layouts[] = {"config/standard-board.txt", "config/small-board.txt", "config/board-weird-start.txt"};
+	std::mt19937 random(31);
+	for (const char* layout : layouts) {
+		Board b = Board::read(layout);
+		// Scatter single tiles one at a time and compare after each
+		for (size_t i = 0; i < 40; i++) {
+			vector<Board::Anchor> expected = BoardRules::get_anchors(b);
+			vector<Board::Anchor> a = b.get_anchors();
+			ASSERT_EQ(a.size(), expected.size()) << layout << " after " << i << " tiles";
+			for (size_t j = 0; j < a.size(); j++) {
+				EXPECT_EQ(a[j].position, expected[j].position);
+				EXPECT_EQ(a[j].direction, expected[j].direction);
+				EXPECT_EQ(a[j].limit, expected[j].limit);
+			}
+
+			Board::Position p(random() % b.rows, random() % b.columns);
+			if (!b.in_bounds_and_has_tile(p)) {
+				vector<TileKind> t;
+				t.push_back(TileKind('A', 1));
+				b.place_unchecked(Move(t, p.row, p.column, Direction::ACROSS));
+			}
+		}
+	}
+}
+
 TEST_F(AnchorTest, two_words_2) {
 	Board b = Board::read("config/standard-board.txt");
 
@@ -545,6 +1027,357 @@ TEST_F(AnchorTest, concave) {
 }
 
 
+class PlaceScoreTest : public testing::Test {
+protected:
+	PlaceScoreTest() {}
+	virtual ~PlaceScoreTest() {}
+};
+
+TEST_F(PlaceScoreTest, spans_and_errors) {
+	Board b = Board::read("config/standard-board.txt");
+	place_simple_word(b);
+
+	// "as" down from under the H of "hi" makes "has"
+	vector<TileKind> t;
+	t.push_back(TileKind('A', 1));
+	t.push_back(TileKind('S', 1));
+	Move m(t, 8, 7, Direction::DOWN);
+	PlaceScore score = b.score_place(m);
+	ASSERT_TRUE(score.valid());
+	ASSERT_EQ(score.word_count, 1);
+	EXPECT_EQ(score.words[0].row, 7);
+	EXPECT_EQ(score.words[0].column, 7);
+	EXPECT_TRUE(score.words[0].direction == Direction::DOWN);
+	EXPECT_EQ(score.words[0].length, 3);
+	EXPECT_EQ(BoardRules::span_word(b, m, score.words[0]), "has");
+	EXPECT_EQ(score.points, b.test_place(m).points);
+
+	// A blank under the I forms a cross word and a main word
+	vector<TileKind> blank;
+	blank.push_back(TileKind('?', 0, 'o'));
+	blank.push_back(TileKind('N', 1));
+	Move across(blank, 8, 8, Direction::ACROSS);
+	score = b.score_place(across);
+	ASSERT_TRUE(score.valid());
+	ASSERT_EQ(score.word_count, 2);
+	EXPECT_EQ(BoardRules::span_word(b, across, score.words[0]), "io");
+	EXPECT_EQ(BoardRules::span_word(b, across, score.words[1]), "on");
+
+	PlaceResult result = b.test_place(across);
+	ASSERT_EQ(result.words.size(), 2);
+	EXPECT_EQ(result.points, score.points);
+
+	Move far(t, 0, 0, Direction::ACROSS);
+	EXPECT_TRUE(b.score_place(far).error == PlaceError::NOT_ADJACENT);
+	EXPECT_EQ(b.test_place(far).error, place_error_message(PlaceError::NOT_ADJACENT));
+	Move off(t, 14, 14, Direction::ACROSS);
+	EXPECT_TRUE(b.score_place(off).error == PlaceError::OUT_OF_BOUNDS);
+	Move on_tile(t, 7, 7, Direction::ACROSS);
+	EXPECT_TRUE(b.score_place(on_tile).error == PlaceError::START_OCCUPIED);
+}
+
+TEST_F(PlaceScoreTest, bound_covers_extensions) {
+	Board b = Board::read("config/standard-board.txt");
+	place_simple_word(b);
+
+	// Moves down from under the H, whose word so far is just the H
+	const size_t extra = 2;
+	vector<uint32_t> all(b.rows * b.columns, (uint32_t(1) << 26) - 1);
+	vector<BoardRules::Extension> extensions;
+	BoardRules::extension_bounds(b, Direction::DOWN, extra, 10, all.data(), all[0], extensions);
+	ASSERT_EQ(extensions.size(), b.rows * b.columns * (extra + 1));
+	auto at = [&](size_t row, size_t column, size_t count) {
+		return extensions[(row * b.columns + column) * (extra + 1) + count];
+	};
+	auto bound = [](int word_points, int word_bonus, int cross_points, const BoardRules::Extension& rest) {
+		return cross_points + rest.cross_points + (word_points + rest.word_points) * word_bonus * rest.word_bonus;
+	};
+	int h = BoardRules::tile_points(b, Board::Position(7, 7));
+
+	// Every way of extending "a" down from under the H stays within the bound for one more tile of up to 10 points
+	vector<TileKind> t;
+	t.push_back(TileKind('A', 1));
+	Move m(t, 8, 7, Direction::DOWN);
+	EXPECT_GE(bound(h, 1, 0, at(8, 7, 1)), static_cast<int>(b.score_place(m).points));
+	for (unsigned short points = 0; points <= 10; points++) {
+		Move longer = m;
+		longer.tiles.push_back(TileKind('S', points));
+		ASSERT_TRUE(b.score_place(longer).valid());
+		EXPECT_GE(bound(h, 1, 0, at(8, 7, 2)), static_cast<int>(b.score_place(longer).points));
+	}
+	EXPECT_EQ(at(8, 7, 2).tiles, 2);
+
+	// Once the A is counted as placed, no more tiles leaves the exact score
+	int word_points = h;
+	int word_bonus = 1;
+	int cross_points = 0;
+	BoardRules::add_tile_points(b, Board::Position(8, 7), Direction::DOWN, t[0], word_points, word_bonus, cross_points);
+	EXPECT_EQ(bound(word_points, word_bonus, cross_points, at(9, 7, 0)), static_cast<int>(b.score_place(m).points));
+
+	// No tile goes where no letter it can be fits
+	vector<uint32_t> none(b.rows * b.columns, 0);
+	BoardRules::extension_bounds(b, Direction::DOWN, extra, 10, none.data(), all[0], extensions);
+	EXPECT_EQ(at(8, 7, 2).tiles, 0);
+	EXPECT_EQ(bound(h, 1, 0, at(8, 7, 2)), h);
+}
+
+class TurnProfileTest : public testing::Test {
+protected:
+	TurnProfileTest() {}
+	virtual ~TurnProfileTest() {}
+};
+
+TEST_F(TurnProfileTest, chrome_trace) {
+	TurnProfile turn;
+	turn.player = "cpu \"1\"";
+	turn.start = 1000;
+	turn.anchors_time = 5;
+	turn.search_start = 5;
+	turn.search_time = 20;
+	turn.scoring_start = 8;
+	turn.scoring_time = 4;
+	turn.candidates = 42;
+	turn.count_visit(3);
+	turn.count_visit(40);
+
+	stringstream out;
+	write_chrome_trace(out, vector<TurnProfile>(2, turn));
+	string json = out.str();
+	EXPECT_EQ(json.find("{\"traceEvents\":["), 0);
+	EXPECT_NE(json.find("\"name\":\"cpu \\\"1\\\"\""), string::npos);
+	EXPECT_NE(json.find("\"name\":\"search\",\"cat\":\"turn\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":1005.000,\"dur\":24.000"),
+			string::npos);
+	EXPECT_NE(json.find("\"name\":\"scoring\",\"cat\":\"turn\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":1008.000,\"dur\":4.000"),
+			string::npos);
+	EXPECT_NE(json.find("\"candidates\":42"), string::npos);
+	EXPECT_NE(json.find("\"15+\":1"), string::npos);
+}
+
+#ifdef SCRABBLE_PROFILE
+TEST_F(TurnProfileTest, counts_search) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	ComputerPlayer cpu("cpu", 7);
+	vector<TileKind> t;
+	for (char letter : string("BATONSF")) {
+		t.push_back(TileKind(letter, 1));
+	}
+	cpu.add_tiles(t);
+	cpu.get_move(b, d);
+
+	const TurnProfile& profile = cpu.get_last_profile();
+	EXPECT_EQ(profile.player, "cpu");
+	EXPECT_EQ(profile.anchors, 2);
+	EXPECT_GT(profile.trie_nodes_visited, profile.candidates);
+	EXPECT_GT(profile.candidates, 0);
+	EXPECT_LE(profile.rejected, profile.candidates);
+	size_t visits = 0;
+	for (size_t count : profile.depth) {
+		visits += count;
+	}
+	EXPECT_EQ(visits, profile.trie_nodes_visited);
+	EXPECT_GE(profile.search_start, profile.anchors_start + profile.anchors_time);
+	EXPECT_GT(profile.scoring_time, 0);
+	EXPECT_GE(profile.scoring_start, profile.search_start);
+	EXPECT_GE(profile.search_time, 0);
+}
+#endif
+
+class RackInferenceTest : public testing::Test {
+protected:
+	RackInferenceTest() {}
+	virtual ~RackInferenceTest() {}
+	TileBag bag = TileBag::read("config/english-tile-bag.txt", 1);
+	Board b = Board::read("config/standard-board.txt");
+
+	vector<TileKind> tiles(const string& letters) {
+		vector<TileKind> result;
+		for (char letter : letters) {
+			for (const auto& kind : bag.get_kinds()) {
+				if (kind.second.letter == letter) {
+					result.push_back(kind.second);
+				}
+			}
+		}
+		return result;
+	}
+};
+
+TEST_F(RackInferenceTest, unseen_tiles) {
+	RackInference inference(bag, b, tiles("qeeaaa?"), 7, 1, 200);
+	EXPECT_EQ(inference.count_unseen(), bag.count_tiles() - 7);
+	EXPECT_EQ(inference.get_unseen()[RackInference::index_of('q')], 0);
+	EXPECT_EQ(inference.get_unseen()[RackInference::index_of('a')], 6);
+	EXPECT_EQ(inference.get_unseen()[RackInference::index_of('?')], 1);
+	EXPECT_EQ(inference.get_opponent_rack_size(), 7);
+	EXPECT_EQ(inference.probability_of('q'), 0);
+	EXPECT_NEAR(inference.expected_count('a'), 7.0 * 6 / inference.count_unseen(), 0.2);
+}
+
+TEST_F(RackInferenceTest, opponent_play) {
+	RackInference inference(bag, b, tiles("qeeaaa?"), 7, 1, 200);
+	inference.observe_opponent(Move(tiles("zi"), 7, 7, Direction::ACROSS));
+	EXPECT_EQ(inference.count_unseen(), bag.count_tiles() - 9);
+	EXPECT_EQ(inference.get_opponent_rack_size(), 7);
+	EXPECT_LT(inference.probability_of('z'), inference.probability_of('i'));
+
+	inference.observe_own_draw(tiles("x"));
+	EXPECT_EQ(inference.probability_of('x'), 0);
+	for (int i = 0; i < 20; i++) {
+		vector<TileKind> rack;
+		vector<TileKind> rest;
+		inference.sample_deal(rack, rest);
+		EXPECT_EQ(rack.size(), 7);
+		EXPECT_EQ(rack.size() + rest.size(), inference.count_unseen());
+		RackInference::Counts counts = {};
+		for (const TileKind& tile : rack) {
+			counts[RackInference::index_of(tile.letter)]++;
+		}
+		for (const TileKind& tile : rest) {
+			counts[RackInference::index_of(tile.letter)]++;
+		}
+		EXPECT_EQ(counts, inference.get_unseen());
+	}
+}
+
+TEST_F(RackInferenceTest, exchange_and_pass) {
+	RackInference inference(bag, b, tiles("qeeaaa?"), 7, 1, 200);
+	inference.observe_opponent(Move());
+	EXPECT_EQ(inference.count_unseen(), bag.count_tiles() - 7);
+	inference.observe_opponent(Move(tiles("abcd")));
+	EXPECT_EQ(inference.count_unseen(), bag.count_tiles() - 7);
+	EXPECT_EQ(inference.get_opponent_rack_size(), 7);
+	EXPECT_GT(inference.effective_particles(), 1);
+	EXPECT_EQ(inference.sample_rack().size(), 7);
+}
+
+class ExchangeEvaluatorTest : public testing::Test {
+protected:
+	ExchangeEvaluatorTest() {}
+	virtual ~ExchangeEvaluatorTest() {}
+
+	vector<TileKind> tiles(const string& letters) {
+		vector<TileKind> result;
+		for (char letter : letters) {
+			result.push_back(TileKind(letter, letter == '?' ? 0 : 1));
+		}
+		return result;
+	}
+};
+
+TEST_F(ExchangeEvaluatorTest, subset_tables) {
+	LeaveTable::Counts unseen = LeaveTable::count(tiles("aaaaeeeiinnrrsstt"));
+	vector<TileKind> rack = tiles("svvquua");
+	ExchangeEvaluator evaluator(rack, unseen);
+
+	EXPECT_EQ(evaluator.all(), 127);
+	EXPECT_DOUBLE_EQ(evaluator.leave_value(evaluator.all()), LeaveTable::value(LeaveTable::count(rack)));
+	EXPECT_DOUBLE_EQ(evaluator.leave_value(0), 0);
+	EXPECT_DOUBLE_EQ(evaluator.draw_value(evaluator.all()), 0);
+	for (uint32_t keep = 0; keep <= evaluator.all(); keep++) {
+		vector<TileKind> kept;
+		for (size_t i = 0; i < rack.size(); i++) {
+			if (keep & (1u << i)) {
+				kept.push_back(rack[i]);
+			}
+		}
+		EXPECT_NEAR(evaluator.leave_value(keep), LeaveTable::value(LeaveTable::count(kept)), 1e-9);
+		EXPECT_EQ(evaluator.tiles_outside(keep).size() + kept.size(), rack.size());
+	}
+	EXPECT_EQ(evaluator.keep_after(tiles("vua")), 0x2d);
+}
+
+TEST_F(ExchangeEvaluatorTest, keeps_good_tiles) {
+	LeaveTable::Counts unseen = LeaveTable::count(tiles("aaaaeeeiinnrrsstt"));
+	ExchangeEvaluator evaluator(tiles("svvquua"), unseen);
+	vector<TileKind> returned = evaluator.tiles_outside(evaluator.best_exchange());
+	bool has_q = false;
+	bool has_s = false;
+	for (const TileKind& tile : returned) {
+		has_q = has_q || tile.letter == 'q';
+		has_s = has_s || tile.letter == 's';
+	}
+	EXPECT_TRUE(has_q);
+	EXPECT_FALSE(has_s);
+	EXPECT_GT(evaluator.equity(evaluator.best_exchange()), evaluator.equity(evaluator.all()));
+}
+
+class ArenaTest : public testing::Test {
+protected:
+	ArenaTest() {}
+	virtual ~ArenaTest() {}
+};
+
+TEST_F(ArenaTest, aligned_and_reused) {
+	Arena arena(256);
+	char* first = static_cast<char*>(arena.allocate(3, 1));
+	void* aligned = arena.allocate(8, 8);
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 8, 0u);
+	EXPECT_GE(static_cast<char*>(aligned), first + 3);
+
+	// Bigger than a block: gets a block of its own
+	char* big = static_cast<char*>(arena.allocate(1000, 16));
+	EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % 16, 0u);
+	big[999] = 'x';
+	size_t reserved = arena.bytes_reserved();
+	EXPECT_GE(reserved, 1256u);
+	EXPECT_EQ(arena.bytes_allocated(), 3u + 8 + 1000);
+
+	// After a reset the same blocks serve the same allocations
+	arena.reset();
+	EXPECT_EQ(arena.bytes_allocated(), 0u);
+	arena.allocate(3, 1);
+	arena.allocate(8, 8);
+	arena.allocate(1000, 16);
+	EXPECT_EQ(arena.bytes_reserved(), reserved);
+}
+
+TEST_F(ArenaTest, containers) {
+	Arena arena;
+	vector<int, ArenaAllocator<int>> numbers{ArenaAllocator<int>(arena)};
+	for (int i = 0; i < 1000; i++) {
+		numbers.push_back(i);
+	}
+	EXPECT_EQ(numbers[999], 999);
+	EXPECT_GE(arena.bytes_allocated(), 1000 * sizeof(int));
+
+	Dictionary::TrieNode* node = arena.make<Dictionary::TrieNode>(arena);
+	node->nexts['a'] = node;
+	EXPECT_EQ(node->nexts.at('a'), node);
+	EXPECT_FALSE(node->is_final);
+}
+
+class MoveTest : public testing::Test {
+protected:
+	MoveTest() {}
+	virtual ~MoveTest() {}
+};
+
+TEST_F(MoveTest, equality_and_hash) {
+	MoveHash hash;
+	Move across({TileKind('c', 3), TileKind('?', 0, 'a'), TileKind('t', 1)}, 7, 7, Direction::ACROSS);
+	Move same({TileKind('c', 3), TileKind('?', 0, 'a'), TileKind('t', 1)}, 7, 7, Direction::ACROSS);
+	EXPECT_TRUE(across == same);
+	EXPECT_EQ(hash(across), hash(same));
+	EXPECT_TRUE(across != Move({TileKind('c', 3), TileKind('?', 0, 'o'), TileKind('t', 1)}, 7, 7, Direction::ACROSS));
+	EXPECT_TRUE(across != Move({TileKind('c', 3), TileKind('a', 1), TileKind('t', 1)}, 7, 7, Direction::ACROSS));
+	EXPECT_TRUE(across != Move({TileKind('c', 3), TileKind('?', 0, 'a'), TileKind('t', 1)}, 7, 7, Direction::DOWN));
+	EXPECT_TRUE(across != Move({TileKind('c', 3), TileKind('?', 0, 'a'), TileKind('t', 1)}, 7, 6, Direction::ACROSS));
+
+	// One tile goes on the same square either way
+	Move one_across({TileKind('s', 1)}, 3, 4, Direction::ACROSS);
+	Move one_down({TileKind('s', 1)}, 3, 4, Direction::DOWN);
+	EXPECT_TRUE(one_across == one_down);
+	EXPECT_EQ(hash(one_across), hash(one_down));
+
+	Move exchange({TileKind('q', 10), TileKind('u', 1), TileKind('?', 0)});
+	Move reordered({TileKind('?', 0), TileKind('q', 10), TileKind('u', 1)});
+	EXPECT_TRUE(exchange == reordered);
+	EXPECT_EQ(hash(exchange), hash(reordered));
+	EXPECT_TRUE(Move() == Move());
+	EXPECT_TRUE(Move() != exchange);
+}
+
 class ComputerPlayerTest : public testing::Test {
 protected:
 	ComputerPlayerTest() {}
@@ -1039,3 +1872,184 @@ TEST_F(ComputerPlayerTest, stress_test) {
 	test_pts(res, 57);
 }
 
+
+TEST_F(ComputerPlayerTest, deadline_completes_with_same_score) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	ComputerPlayer cpu("cpu", 7);
+
+	place_concave_words(b);
+
+	vector<TileKind> t;
+	for (char letter : string("BATONSF")) {
+		t.push_back(TileKind(letter, 2));
+	}
+	cpu.add_tiles(t);
+
+	ComputerPlayer::SearchResult timed = cpu.get_move(b, d, chrono::steady_clock::now() + chrono::hours(1));
+	EXPECT_TRUE(timed.complete);
+	EXPECT_EQ(timed.anchors_searched, timed.anchors);
+	EXPECT_GT(timed.anchors, 0);
+	EXPECT_EQ(b.test_place(timed.move).points, b.test_place(cpu.get_move(b, d)).points);
+}
+
+TEST_F(ComputerPlayerTest, deadline_stops_search) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	ComputerPlayer cpu("cpu", 7);
+
+	place_concave_words(b);
+
+	vector<TileKind> t;
+	for (char letter : string("A?TM?SE")) {
+		t.push_back(TileKind(letter, 1));
+	}
+	cpu.add_tiles(t);
+
+	ComputerPlayer::SearchResult expired = cpu.get_move(b, d, chrono::steady_clock::now());
+	EXPECT_FALSE(expired.complete);
+	EXPECT_EQ(expired.anchors_searched, 0);
+	EXPECT_EQ(expired.move.kind, MoveKind::PASS);
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	ComputerPlayer::SearchResult timed = cpu.get_move(b, d, start + chrono::milliseconds(50));
+	chrono::steady_clock::duration elapsed = chrono::steady_clock::now() - start;
+	EXPECT_FALSE(timed.complete);
+	EXPECT_LT(timed.anchors_searched, timed.anchors);
+	EXPECT_LT(elapsed, chrono::milliseconds(500));
+	if (timed.move.kind == MoveKind::PLACE) {
+		EXPECT_TRUE(b.test_place(timed.move).valid);
+	}
+}
+
+TEST_F(ComputerPlayerTest, pruning_matches_exhaustive) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	ComputerPlayer cpu("cpu", 7);
+
+	place_concave_words(b);
+
+	vector<TileKind> t;
+	for (char letter : string("QUIZ?ER")) {
+		t.push_back(TileKind(letter, letter == '?' ? 0 : 3));
+	}
+	cpu.add_tiles(t);
+
+	ComputerPlayer::Deadline untimed = ComputerPlayer::Deadline::max();
+	cpu.set_pruning(true);
+	ComputerPlayer::SearchResult pruned = cpu.get_move(b, d, untimed);
+	cpu.set_pruning(false);
+	ComputerPlayer::SearchResult exhaustive = cpu.get_move(b, d, untimed);
+
+	EXPECT_TRUE(pruned.complete);
+	EXPECT_GT(pruned.pruned, 0);
+	EXPECT_EQ(exhaustive.pruned, 0);
+	EXPECT_LT(pruned.nodes, exhaustive.nodes);
+	ASSERT_EQ(pruned.move.kind, MoveKind::PLACE);
+	EXPECT_EQ(pruned.move.row, exhaustive.move.row);
+	EXPECT_EQ(pruned.move.column, exhaustive.move.column);
+	EXPECT_EQ(pruned.move.direction, exhaustive.move.direction);
+	ASSERT_EQ(pruned.move.tiles.size(), exhaustive.move.tiles.size());
+	for (size_t i = 0; i < pruned.move.tiles.size(); i++) {
+		EXPECT_EQ(pruned.move.tiles[i].letter, exhaustive.move.tiles[i].letter);
+		EXPECT_EQ(pruned.move.tiles[i].assigned, exhaustive.move.tiles[i].assigned);
+	}
+}
+
+#ifndef SCRABBLE_PROFILE
+// Each search has its own scratch space, so one player can search several boards at once
+TEST_F(ComputerPlayerTest, concurrent_searches) {
+	Board empty = Board::read("config/standard-board.txt");
+	Board concave = empty;
+	place_concave_words(concave);
+	Dictionary d = Dictionary::read(DICT_PATH);
+	ComputerPlayer cpu("cpu", 7);
+	vector<TileKind> t;
+	for (char letter : string("QUIZ?ER")) {
+		t.push_back(TileKind(letter, letter == '?' ? 0 : 3));
+	}
+	cpu.add_tiles(t);
+
+	const Board* boards[2] = {&empty, &concave};
+	size_t expected[2];
+	for (size_t i = 0; i < 2; i++) {
+		expected[i] = cpu.get_move(*boards[i], d, ComputerPlayer::Deadline::max()).points;
+	}
+	size_t found[4][2] = {};
+	vector<thread> threads;
+	for (size_t i = 0; i < 4; i++) {
+		threads.push_back(thread([&, i]() {
+			for (size_t turn = 0; turn < 2; turn++) {
+				const Board& board = *boards[(i + turn) % 2];
+				found[i][(i + turn) % 2] = cpu.get_move(board, d, ComputerPlayer::Deadline::max()).points;
+			}
+		}));
+	}
+	for (thread& worker : threads) {
+		worker.join();
+	}
+	for (size_t i = 0; i < 4; i++) {
+		EXPECT_EQ(found[i][0], expected[0]);
+		EXPECT_EQ(found[i][1], expected[1]);
+	}
+}
+#endif
+
+TEST_F(ComputerPlayerTest, exchanges_bad_rack) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	TileBag bag = TileBag::read("config/english-tile-bag.txt", 1);
+	ComputerPlayer cpu("cpu", 7);
+	vector<TileKind> t;
+	for (char letter : string("QVVWUUU")) {
+		t.push_back(bag.get_kinds().at(tolower(letter)));
+	}
+	cpu.add_tiles(t);
+
+	Move placed = cpu.get_move(b, d);
+	EXPECT_NE(placed.kind, MoveKind::EXCHANGE);
+
+	cpu.enable_exchanges(bag);
+	ComputerPlayer::SearchResult result = cpu.get_move(b, d, ComputerPlayer::Deadline::max());
+	ASSERT_EQ(result.move.kind, MoveKind::EXCHANGE);
+	EXPECT_EQ(result.points, 0);
+	bool has_q = false;
+	for (const TileKind& tile : result.move.tiles) {
+		has_q = has_q || tile.letter == 'q';
+	}
+	EXPECT_TRUE(has_q);
+}
+
+TEST_F(ComputerPlayerTest, moves_found_once) {
+	Board b = Board::read("config/standard-board.txt");
+	Dictionary d = Dictionary::read(DICT_PATH);
+	ComputerPlayer cpu("cpu", 7);
+
+	place_concave_words(b);
+
+	vector<TileKind> t;
+	for (char letter : string("QUIZ?ER")) {
+		t.push_back(TileKind(letter, letter == '?' ? 0 : 3));
+	}
+	cpu.add_tiles(t);
+
+	vector<Move> moves = cpu.get_moves(b, d);
+	ASSERT_FALSE(moves.empty());
+	unordered_set<Move, MoveHash> unique(moves.begin(), moves.end());
+	EXPECT_EQ(unique.size(), moves.size());
+
+	// Every move only makes words in the dictionary, and the best of them is the one get_move() picks
+	unsigned int best = 0;
+	for (const Move& move : moves) {
+		PlaceResult result = b.test_place(move);
+		ASSERT_TRUE(result.valid);
+		for (const string& word : result.words) {
+			EXPECT_TRUE(d.is_word(word)) << word;
+		}
+		for (const TileKind& tile : move.tiles) {
+			EXPECT_TRUE(tile.letter != '?' || tile.assigned != '\0');
+		}
+		best = max(best, result.points + (move.tiles.size() == 7 ? 50 : 0));
+	}
+	EXPECT_EQ(cpu.get_move(b, d, ComputerPlayer::Deadline::max()).points, best);
+}
@@ -33,8 +33,13 @@ std::vector<TileKind> TileBag::remove_random_tiles(size_t count) {
     size_t total_count = this->count_tiles();
 
     std::vector<TileKind> result;
-    for (size_t i = 0; i < count; ++i) {
-        size_t index = std::uniform_int_distribution<size_t>(0, total_count - 1)(this->random);
+    for (; result.size() < count && !this->stacked.empty(); this->stacked.pop_back()) {
+        this->remove_tile(this->stacked.back());
+        total_count -= 1;
+        result.push_back(this->stacked.back());
+    }
+    for (size_t i = result.size(); i < count && total_count > 0; ++i) {
+        size_t index = this->random.below(total_count);
         for (TileMap::iterator it = this->tiles.begin(); it != this->tiles.end(); ++it) {
             if (index < it->second) {
                 it->second -= 1;
@@ -52,3 +57,15 @@ std::vector<TileKind> TileBag::remove_random_tiles(size_t count) {
 const unordered_map<char, TileKind>& TileBag::get_kinds() const {
     return this->kinds;
 }
+
+void TileBag::reseed(uint32_t seed, uint64_t game) {
+    this->random = GameRandom(seed, game);
+}
+
+void TileBag::stack(const std::vector<TileKind>& order) {
+    this->tiles.clear();
+    for (const TileKind& tile : order) {
+        this->add_tile(tile);
+    }
+    this->stacked.assign(order.rbegin(), order.rend());
+}
@@ -1,12 +1,12 @@
 #ifndef TILE_BAG_H
 #define TILE_BAG_H
 
+#include "game_random.h"
 #include "tile_kind.h"
 #include "tile_collection.h"
 #include <vector>
 #include <unordered_map>
 #include <string>
-#include <random>
 
 
 class TileBag : public TileCollection {
@@ -17,12 +17,25 @@ public:
 
     const std::unordered_map<char, TileKind>& get_kinds() const;
 
+    /*
+    Restarts the random draws from a new seed, e.g. for a copy of a bag that was read once and shared. Draws depend
+    only on (seed, game), so game n of a batch draws the same tiles however the batch is run. See GameRandom.
+    */
+    void reseed(uint32_t seed, uint64_t game = 0);
+
+    /*
+    Replaces the tiles with these, which are then drawn in this order instead of at random, to play out one way the
+    hidden tiles could be dealt. Tiles added afterwards, by exchanges, are drawn at random once these run out.
+    */
+    void stack(const std::vector<TileKind>& order);
+
 protected:
-    TileBag(uint32_t seed) : random(seed) {}
+    TileBag(uint32_t seed) : random(seed, 0) {}
 
 private:
     std::unordered_map<char, TileKind> kinds;
-    std::mt19937 random;
+    GameRandom random;
+    std::vector<TileKind> stacked;  // Tiles still to be drawn in order, the next one last
 };
 
 #endif
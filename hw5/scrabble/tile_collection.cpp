@@ -45,6 +45,16 @@ TileKind TileCollection::lookup_tile(char letter) const {
     throw out_of_range("Tile not found.");
 }
 
+bool TileCollection::find_tile(char letter, TileKind& found) const {
+    for (TileMap::const_iterator it = tiles.begin(); it != tiles.end(); it++) {
+        if (it->first.letter == tolower(letter)) {
+            found = it->first;
+            return true;
+        }
+    }
+    return false;
+}
+
 size_t TileCollection::count_tiles() const {
     size_t count {0};
     for (TileMap::const_iterator it = this->tiles.cbegin(); it != this->tiles.cend(); ++it) {
@@ -70,6 +80,40 @@ unsigned int TileCollection::total_points() const {
     return sum;
 }
 
+unsigned short TileCollection::max_points() const {
+    unsigned short highest = 0;
+    for (TileMap::const_iterator map_itr = tiles.begin(); map_itr != tiles.end(); map_itr++) {
+        if (map_itr->second > 0 && map_itr->first.points > highest) {
+            highest = map_itr->first.points;
+        }
+    }
+    return highest;
+}
+
+uint32_t TileCollection::letter_mask() const {
+    uint32_t mask = 0;
+    for (TileMap::const_iterator map_itr = tiles.begin(); map_itr != tiles.end(); map_itr++) {
+        if (map_itr->second == 0) {
+            continue;
+        }
+        if (map_itr->first.letter == TileKind::BLANK_LETTER) {
+            return (uint32_t(1) << 26) - 1;
+        }
+        if (map_itr->first.letter >= 'a' && map_itr->first.letter <= 'z') {
+            mask |= uint32_t(1) << (map_itr->first.letter - 'a');
+        }
+    }
+    return mask;
+}
+
+std::vector<TileKind> TileCollection::list_tiles() const {
+    std::vector<TileKind> list;
+    for (TileMap::const_iterator map_itr = tiles.begin(); map_itr != tiles.end(); map_itr++) {
+        list.insert(list.end(), map_itr->second, map_itr->first);
+    }
+    return list;
+}
+
 TileCollection::const_iterator::self_type TileCollection::const_iterator::operator++(){
     repeat_count++;
     if (repeat_count == map_itr->second){
@@ -2,6 +2,8 @@
 #define TILE_COLLECTION_H
 
 #include "tile_kind.h"
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <vector>
 
@@ -45,6 +47,12 @@ public:
      */
     TileKind lookup_tile(char letter) const;
 
+    /*
+     Like lookup_tile(), but returns whether a tile with this letter exists and sets found to it if so, instead of
+     throwing. For callers that try many letters that are mostly missing, where each exception would cost an allocation.
+     */
+    bool find_tile(char letter, TileKind& found) const;
+
     /*
      Get the total number of all tiles in this collection.
      */
@@ -60,6 +68,22 @@ public:
      */
     unsigned int total_points() const;
 
+    /*
+     Get the highest point value of any tile in the collection, or 0 if it is empty
+     */
+    unsigned short max_points() const;
+
+    /*
+     Get the letters the tiles in the collection can be as a bit mask, bit letter - 'a': every letter if it holds a
+     blank
+     */
+    uint32_t letter_mask() const;
+
+    /*
+     Get every tile in the collection, each kind repeated as many times as it is held
+     */
+    std::vector<TileKind> list_tiles() const;
+
     /*
      Get an iterator to the first element
      */
@@ -0,0 +1,67 @@
+#include "turn_profile.h"
+
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+// Player names are the only free text; keep the JSON valid whatever they contain
+static string json_string(const string& text) {
+    ostringstream out;
+    out << '"';
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out << "\\u" << hex << setw(4) << setfill('0') << int(c) << dec;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+    return out.str();
+}
+
+static void write_phase(
+        ostream& out, const string& name, size_t thread, double turn_start, double start, double duration) {
+    out << ",\n{\"name\":" << json_string(name) << ",\"cat\":\"turn\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread
+        << ",\"ts\":" << turn_start + start << ",\"dur\":" << duration << "}";
+}
+
+void write_chrome_trace(ostream& out, const vector<TurnProfile>& turns) {
+    // One track per player, named with a metadata event
+    map<string, size_t> threads;
+    for (const TurnProfile& turn : turns) {
+        threads.emplace(turn.player, threads.size() + 1);
+    }
+
+    out << fixed << setprecision(3);
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"scrabble\"}}";
+    for (const auto& thread : threads) {
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.second
+            << ",\"args\":{\"name\":" << json_string(thread.first) << "}}";
+    }
+
+    for (const TurnProfile& turn : turns) {
+        size_t thread = threads[turn.player];
+        double search_span = turn.search_time + turn.scoring_time;
+        write_phase(out, "get_move", thread, turn.start, 0, turn.search_start + search_span);
+        write_phase(out, "anchors", thread, turn.start, turn.anchors_start, turn.anchors_time);
+        write_phase(out, "search", thread, turn.start, turn.search_start, search_span);
+        write_phase(out, "scoring", thread, turn.start, turn.scoring_start, turn.scoring_time);
+
+        out << ",\n{\"name\":\"search\",\"ph\":\"C\",\"pid\":1,\"ts\":" << turn.start
+            << ",\"args\":{\"anchors\":" << turn.anchors << ",\"trie_nodes_visited\":" << turn.trie_nodes_visited
+            << ",\"candidates\":" << turn.candidates << ",\"rejected\":" << turn.rejected
+            << ",\"pruned\":" << turn.pruned << "}}";
+        out << ",\n{\"name\":\"depth\",\"ph\":\"C\",\"pid\":1,\"ts\":" << turn.start << ",\"args\":{";
+        for (size_t i = 0; i <= TurnProfile::MAX_DEPTH; i++) {
+            out << (i > 0 ? "," : "") << "\"" << i << (i == TurnProfile::MAX_DEPTH ? "+" : "")
+                << "\":" << turn.depth[i];
+        }
+        out << "}}";
+    }
+    out << "\n]}\n";
+}
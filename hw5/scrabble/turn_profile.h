@@ -0,0 +1,69 @@
+#ifndef TURN_PROFILE_H
+#define TURN_PROFILE_H
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/*
+ Where one ComputerPlayer::get_move call spent its time and effort.
+
+ The counters are only collected when the code is built with SCRABBLE_PROFILE defined (make PROFILE=1); otherwise the
+ hooks in ComputerPlayer compile to nothing and get_last_profile() does not exist. Times are in microseconds, phase
+ starts are relative to the start of the turn.
+*/
+struct TurnProfile {
+    static const size_t MAX_DEPTH = 15;
+
+    std::string player;
+    double start = 0;  // Microseconds since the steady clock's epoch, to place turns on one timeline
+
+    double anchors_start = 0;
+    double anchors_time = 0;
+    double search_start = 0;
+    double search_time = 0;  // Excludes scoring_time
+    double scoring_start = 0;  // When the first candidate was scored
+    double scoring_time = 0;   // Total of the score_place calls, which the search makes as it finds candidates
+
+    size_t anchors = 0;
+    size_t trie_nodes_visited = 0;   // Calls of left_part and extend_right that searched their trie node
+    size_t candidates = 0;           // Moves the search produced
+    size_t rejected = 0;             // Candidates score_place found invalid
+    size_t pruned = 0;               // Calls that returned at once since no move from them could beat the best
+    size_t depth[MAX_DEPTH + 1] = {};  // Trie nodes visited by word length so far; the last bucket holds longer ones
+
+    void count_visit(size_t word_length) { depth[word_length < MAX_DEPTH ? word_length : MAX_DEPTH]++; }
+
+    // Marks the start of a phase, relative to the start of the turn
+    void begin(double& phase_start) const { phase_start = now() - start; }
+    void end(double phase_start, double& phase_time) const { phase_time = now() - start - phase_start; }
+    // Adds one call, begun at call_start on the steady clock, to a phase spread over many calls
+    void add(double call_start, double& phase_start, double& phase_time) const {
+        if (phase_time == 0) {
+            phase_start = call_start - start;
+        }
+        phase_time += now() - call_start;
+    }
+
+    // Microseconds on the steady clock
+    static double now() {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+/*
+ Writes turns as Chrome trace-event JSON (load in chrome://tracing or Perfetto): one complete event per phase on the
+ player's track, and counter events for the search totals. Scoring happens inside the search, so its event is drawn
+ from the first candidate for the total time of all of them.
+*/
+void write_chrome_trace(std::ostream& out, const std::vector<TurnProfile>& turns);
+
+#ifdef SCRABBLE_PROFILE
+#define PROFILE_ONLY(...) __VA_ARGS__
+#else
+#define PROFILE_ONLY(...)
+#endif
+
+#endif
@@ -0,0 +1,245 @@
+#ifndef AUGMENTED_AVL_H
+#define AUGMENTED_AVL_H
+
+#include "avlbst.h"
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * Aggregate policies for AugmentedAVLTree. A policy says what is kept for each subtree on top of its size:
+ *     Type                  the aggregate
+ *     identity()            the aggregate of no items
+ *     of(key, value)        the aggregate of one item
+ *     combine(left, right)  the aggregate of two runs of items, left's keys all before right's; must be associative
+ */
+
+// Keeps nothing but the sizes, for select, rank and count
+template<class Key, class Value>
+struct NoAggregate {
+    struct Type {};
+
+    static Type identity() { return Type(); }
+    static Type of(const Key&, const Value&) { return Type(); }
+    static Type combine(const Type&, const Type&) { return Type(); }
+};
+
+// Keeps the sum of the values
+template<class Key, class Value>
+struct SumAggregate {
+    typedef Value Type;
+
+    static Type identity() { return Value(); }
+    static Type of(const Key&, const Value& value) { return value; }
+    static Type combine(const Type& left, const Type& right) { return left + right; }
+};
+
+/**
+ * An AVLNode that also keeps the size and the aggregate of the subtree it is the root of.
+ */
+template<class Key, class Value, class Aggregate>
+class AugmentedAVLNode : public AVLNode<Key, Value> {
+public:
+    AugmentedAVLNode(const Key& key, const Value& value, std::shared_ptr<AVLNode<Key, Value>> parent);
+
+    size_t getSize() const { return size_; }
+    const Aggregate& getAggregate() const { return aggregate_; }
+    void setSize(size_t size) { size_ = size; }
+    void setAggregate(const Aggregate& aggregate) { aggregate_ = aggregate; }
+
+protected:
+    size_t size_;
+    Aggregate aggregate_;
+};
+
+template<class Key, class Value, class Aggregate>
+AugmentedAVLNode<Key, Value, Aggregate>::AugmentedAVLNode(
+        const Key& key, const Value& value, std::shared_ptr<AVLNode<Key, Value>> parent)
+        : AVLNode<Key, Value>(key, value, parent), size_(1), aggregate_() {}
+
+/**
+ * An AVLTree that keeps the size and an aggregate of every subtree, chosen by Policy (see NoAggregate), so that
+ * order statistics and range aggregates take O(log n) instead of a walk over the items:
+ *     select(k)              the k-th smallest item
+ *     rank(key)              how many keys are smaller than key
+ *     count(lo, hi)          how many keys are in [lo, hi)
+ *     aggregate(lo, hi)      the aggregate of the items with keys in [lo, hi)
+ *
+ * Sizes and aggregates are brought up to date on the way through AVLTree's insert, remove and rotations, at O(log n)
+ * extra combines per update. Change values with insert: the aggregates do not see writes through an iterator.
+ */
+template<class Key, class Value, class Policy = NoAggregate<Key, Value>>
+class AugmentedAVLTree : public AVLTree<Key, Value> {
+public:
+    typedef typename Policy::Type Aggregate;
+    typedef typename BinarySearchTree<Key, Value>::iterator iterator;
+
+    size_t size() const;
+
+    // The item with k smaller keys before it, or end() if k >= size()
+    iterator select(size_t k) const;
+
+    size_t rank(const Key& key) const;
+    size_t count(const Key& lo, const Key& hi) const;
+
+    // The aggregate of the whole tree, or of the items with keys in [lo, hi)
+    Aggregate aggregate() const;
+    Aggregate aggregate(const Key& lo, const Key& hi) const;
+
+protected:
+    typedef AugmentedAVLNode<Key, Value, Aggregate> AugmentedNode;
+
+    static size_t sizeOf(const std::shared_ptr<Node<Key, Value>>& node);
+    static Aggregate aggregateOf(const std::shared_ptr<Node<Key, Value>>& node);
+
+    virtual std::shared_ptr<AVLNode<Key, Value>>
+    makeNode(const Key& key, const Value& value, std::shared_ptr<AVLNode<Key, Value>> parent);
+    virtual void updateNode(std::shared_ptr<AVLNode<Key, Value>> node);
+    virtual void updatePath(std::shared_ptr<AVLNode<Key, Value>> node);
+
+    // The aggregate of the items in node's subtree with keys at least lo, or below hi
+    static Aggregate aggregateFrom(std::shared_ptr<Node<Key, Value>> node, const Key& lo);
+    static Aggregate aggregateBelow(std::shared_ptr<Node<Key, Value>> node, const Key& hi);
+};
+
+template<class Key, class Value, class Policy>
+size_t AugmentedAVLTree<Key, Value, Policy>::sizeOf(const std::shared_ptr<Node<Key, Value>>& node) {
+    return node == nullptr ? 0 : static_cast<const AugmentedNode&>(*node).getSize();
+}
+
+template<class Key, class Value, class Policy>
+typename AugmentedAVLTree<Key, Value, Policy>::Aggregate
+AugmentedAVLTree<Key, Value, Policy>::aggregateOf(const std::shared_ptr<Node<Key, Value>>& node) {
+    return node == nullptr ? Policy::identity() : static_cast<const AugmentedNode&>(*node).getAggregate();
+}
+
+template<class Key, class Value, class Policy>
+std::shared_ptr<AVLNode<Key, Value>> AugmentedAVLTree<Key, Value, Policy>::makeNode(
+        const Key& key, const Value& value, std::shared_ptr<AVLNode<Key, Value>> parent) {
+    auto node = std::make_shared<AugmentedNode>(key, value, parent);
+    node->setAggregate(Policy::of(key, value));
+    return node;
+}
+
+template<class Key, class Value, class Policy>
+void AugmentedAVLTree<Key, Value, Policy>::updateNode(std::shared_ptr<AVLNode<Key, Value>> node) {
+    AugmentedNode& augmentedNode = static_cast<AugmentedNode&>(*node);
+    std::shared_ptr<Node<Key, Value>> left = node->getLeft();
+    std::shared_ptr<Node<Key, Value>> right = node->getRight();
+    augmentedNode.setSize(sizeOf(left) + 1 + sizeOf(right));
+    augmentedNode.setAggregate(Policy::combine(
+            Policy::combine(aggregateOf(left), Policy::of(node->getKey(), node->getValue())), aggregateOf(right)));
+}
+
+template<class Key, class Value, class Policy>
+void AugmentedAVLTree<Key, Value, Policy>::updatePath(std::shared_ptr<AVLNode<Key, Value>> node) {
+    for (; node != nullptr; node = node->getParent_AVL()) {
+        updateNode(node);
+    }
+}
+
+template<class Key, class Value, class Policy>
+size_t AugmentedAVLTree<Key, Value, Policy>::size() const {
+    return sizeOf(this->root_);
+}
+
+template<class Key, class Value, class Policy>
+typename AugmentedAVLTree<Key, Value, Policy>::iterator AugmentedAVLTree<Key, Value, Policy>::select(size_t k) const {
+    std::shared_ptr<Node<Key, Value>> node = this->root_;
+    while (node != nullptr) {
+        size_t left = sizeOf(node->getLeft());
+        if (k < left) {
+            node = node->getLeft();
+        } else if (k == left) {
+            break;
+        } else {
+            k -= left + 1;
+            node = node->getRight();
+        }
+    }
+    return this->iteratorAt(node);
+}
+
+template<class Key, class Value, class Policy>
+size_t AugmentedAVLTree<Key, Value, Policy>::rank(const Key& key) const {
+    size_t smaller = 0;
+    std::shared_ptr<Node<Key, Value>> node = this->root_;
+    while (node != nullptr) {
+        if (node->getKey() < key) {
+            smaller += sizeOf(node->getLeft()) + 1;
+            node = node->getRight();
+        } else {
+            node = node->getLeft();
+        }
+    }
+    return smaller;
+}
+
+template<class Key, class Value, class Policy>
+size_t AugmentedAVLTree<Key, Value, Policy>::count(const Key& lo, const Key& hi) const {
+    if (!(lo < hi)) {
+        return 0;
+    }
+    return rank(hi) - rank(lo);
+}
+
+template<class Key, class Value, class Policy>
+typename AugmentedAVLTree<Key, Value, Policy>::Aggregate AugmentedAVLTree<Key, Value, Policy>::aggregate() const {
+    return aggregateOf(this->root_);
+}
+
+template<class Key, class Value, class Policy>
+typename AugmentedAVLTree<Key, Value, Policy>::Aggregate
+AugmentedAVLTree<Key, Value, Policy>::aggregate(const Key& lo, const Key& hi) const {
+    // Go down to the first node in the range; the rest of the range is split between its two subtrees
+    std::shared_ptr<Node<Key, Value>> node = this->root_;
+    while (node != nullptr) {
+        if (node->getKey() < lo) {
+            node = node->getRight();
+        } else if (!(node->getKey() < hi)) {
+            node = node->getLeft();
+        } else {
+            return Policy::combine(
+                    Policy::combine(aggregateFrom(node->getLeft(), lo), Policy::of(node->getKey(), node->getValue())),
+                    aggregateBelow(node->getRight(), hi));
+        }
+    }
+    return Policy::identity();
+}
+
+template<class Key, class Value, class Policy>
+typename AugmentedAVLTree<Key, Value, Policy>::Aggregate
+AugmentedAVLTree<Key, Value, Policy>::aggregateFrom(std::shared_ptr<Node<Key, Value>> node, const Key& lo) {
+    // Every node kept is followed by its whole right subtree and what was kept further up, in key order
+    Aggregate result = Policy::identity();
+    while (node != nullptr) {
+        if (node->getKey() < lo) {
+            node = node->getRight();
+        } else {
+            result = Policy::combine(
+                    Policy::combine(Policy::of(node->getKey(), node->getValue()), aggregateOf(node->getRight())),
+                    result);
+            node = node->getLeft();
+        }
+    }
+    return result;
+}
+
+template<class Key, class Value, class Policy>
+typename AugmentedAVLTree<Key, Value, Policy>::Aggregate
+AugmentedAVLTree<Key, Value, Policy>::aggregateBelow(std::shared_ptr<Node<Key, Value>> node, const Key& hi) {
+    Aggregate result = Policy::identity();
+    while (node != nullptr) {
+        if (node->getKey() < hi) {
+            result = Policy::combine(
+                    result,
+                    Policy::combine(aggregateOf(node->getLeft()), Policy::of(node->getKey(), node->getValue())));
+            node = node->getRight();
+        } else {
+            node = node->getLeft();
+        }
+    }
+    return result;
+}
+
+#endif
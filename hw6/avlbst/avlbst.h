@@ -6,7 +6,12 @@
 #include <cstdlib>
 #include <exception>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
 
 struct KeyError {};
 
@@ -104,7 +109,66 @@ public:
     virtual void insert(const std::pair<const Key, Value>& new_item);
     virtual void remove(const Key& key);
 
+    // Replaces the contents of the tree with the key/value pairs of [first, last), which must be sorted by key.
+    // Builds a perfectly balanced tree in O(n) with no rotations. When a key repeats the last value wins, as with
+    // insert. Throws std::invalid_argument, leaving the tree empty, if the range is not sorted.
+    template<class Iterator>
+    void buildSorted(Iterator first, Iterator last);
+
+    // Inserts the key/value pairs of [first, last), which must be sorted by key, like insert would. A batch that is
+    // large next to the tree is merged with the tree in one in-order pass and the tree relinked perfectly balanced,
+    // in O(n + m) and reusing the existing nodes; a small one is inserted key by key. Throws std::invalid_argument,
+    // leaving the tree unchanged, if the range is not sorted.
+    // threads is how many threads may relink independent subtrees at once; 1 does it all on the calling thread.
+    template<class Iterator>
+    void mergeSorted(Iterator first, Iterator last, unsigned threads = 1);
+
+    // Batch insert, remove and find for batches in any order. Each sorts its batch and then, like mergeSorted,
+    // applies a batch that is large next to the tree in one in-order pass and a small one key by key. threads is
+    // how many threads may work on independent subtrees at once.
+    template<class Iterator>
+    void insertBatch(Iterator first, Iterator last, unsigned threads = 1);
+    template<class Iterator>
+    void removeBatch(Iterator first, Iterator last, unsigned threads = 1);
+
+    // Returns an iterator to the item for each key of [first, last), in the order given, or end() for keys not in
+    // the tree. The sorted keys are split at each node on the way down, so a node is visited once however many keys
+    // pass through it.
+    template<class Iterator>
+    std::vector<typename BinarySearchTree<Key, Value>::iterator>
+    findBatch(Iterator first, Iterator last, unsigned threads = 1) const;
+
+    // Moves the items with keys at least key into right, replacing what right held, and keeps the rest. Takes
+    // O(log n): nodes are relinked, never copied, so right must be the same kind of tree as this one.
+    void split(const Key& key, AVLTree<Key, Value>& right);
+    // Replaces the contents of the tree with the items of left followed by those of right, leaving both empty, in
+    // O(log n). Throws std::invalid_argument, changing nothing, unless every key in left is less than every key in
+    // right. Either may be this tree.
+    void join(AVLTree<Key, Value>& left, AVLTree<Key, Value>& right);
+
+    // Set operations by key that take other's nodes and leave it empty. unionWith keeps the items of both, with
+    // other's value for a key in both; intersectWith keeps the items whose keys are in both, with this tree's values;
+    // subtract keeps the items whose keys are not in other. Each splits other at this tree's root and works on the
+    // two halves independently, on up to threads threads, in O(m log(n / m + 1)) for trees of m <= n items.
+    void unionWith(AVLTree<Key, Value>& other, unsigned threads = 1);
+    void intersectWith(AVLTree<Key, Value>& other, unsigned threads = 1);
+    void subtract(AVLTree<Key, Value>& other, unsigned threads = 1);
+
 protected:
+    typedef std::shared_ptr<AVLNode<Key, Value>> NodePtr;
+    typedef std::vector<std::shared_ptr<AVLNode<Key, Value>>> NodeList;
+
+    enum SetOperation { UNION, INTERSECTION, DIFFERENCE };
+
+    // Inserting or removing one key costs about the height of the tree in cache misses, a merge costs a few
+    // sequential steps per node and a relink; on bst-bench bulk and batch merging only pays off once the batch is
+    // about 1 / MERGE_RATIO of the tree
+    static const size_t MERGE_RATIO = 4;
+    // Below this many nodes a subtree is linked or searched on one thread; starting a thread costs more
+    static const size_t PARALLEL_GRAIN = 1 << 14;
+    // A subtree no taller than this has fewer than PARALLEL_GRAIN nodes
+    static const int PARALLEL_HEIGHT = 14;
+
     // Helper function already provided to you.
     virtual void nodeSwap(std::shared_ptr<AVLNode<Key, Value>> n1, std::shared_ptr<AVLNode<Key, Value>> n2);
 
@@ -113,6 +177,67 @@ protected:
     // setBalance(...) given a key to a node and balance value, etc
     void insertFix(std::shared_ptr<AVLNode<Key, Value>> p, std::shared_ptr<AVLNode<Key, Value>> n);
     void removeFix(std::shared_ptr<AVLNode<Key, Value>> n, int diff);
+
+    // Hooks for trees that keep more in each node (see AugmentedAVLTree). Every node is made by makeNode. updateNode
+    // is called on a node whose children changed, once its children are up to date; updatePath is called on the
+    // lowest node whose subtree gained, lost or changed an item and must bring it and its ancestors up to date.
+    virtual std::shared_ptr<AVLNode<Key, Value>>
+    makeNode(const Key& key, const Value& value, std::shared_ptr<AVLNode<Key, Value>> parent);
+    virtual void updateNode(std::shared_ptr<AVLNode<Key, Value>> node) {}
+    virtual void updatePath(std::shared_ptr<AVLNode<Key, Value>> node) {}
+
+    // Links nodes[lo, hi), in key order, into a perfectly balanced subtree under parent with the balances set, and
+    // returns its root. height is set to the height of the subtree. With threads > 1 large subtrees are split
+    // between threads, so updateNode must be safe to call on different nodes at once.
+    std::shared_ptr<AVLNode<Key, Value>> linkBalanced(
+            const NodeList& nodes,
+            size_t lo,
+            size_t hi,
+            std::shared_ptr<AVLNode<Key, Value>> parent,
+            int& height,
+            unsigned threads = 1);
+
+    // Collects the tree's nodes in key order and returns true, or returns false with nodes empty if the tree has
+    // more than MERGE_RATIO times batch nodes and a batch that size should be applied key by key
+    bool collectForMerge(size_t batch, NodeList& nodes) const;
+
+    // Fills results[keys[i].second] for every i in [lo, hi) with the item for keys[i].first in node's subtree
+    void findRange(
+            std::shared_ptr<Node<Key, Value>> node,
+            const std::vector<std::pair<Key, size_t>>& keys,
+            size_t lo,
+            size_t hi,
+            std::vector<typename BinarySearchTree<Key, Value>::iterator>& results,
+            unsigned threads) const;
+
+    // Split, join and the set operations work on detached subtrees: roots with no parent that are not root_, along
+    // with their heights, which are passed around so that no height has to be recomputed
+    static int heightOf(NodePtr node);
+    // Detaches node's children, returning them with their heights, and clears node's links and balance
+    static void unlink(NodePtr node, int height, NodePtr& left, int& leftHeight, NodePtr& right, int& rightHeight);
+    // Joins left, mid and right, in that key order, into one balanced subtree and returns its root. mid must be
+    // unlinked. Takes O(|leftHeight - rightHeight| + 1) on top of the updatePath.
+    NodePtr joinNodes(NodePtr left, int leftHeight, NodePtr mid, NodePtr right, int rightHeight, int& height);
+    NodePtr joinNodes(NodePtr left, int leftHeight, NodePtr right, int rightHeight, int& height);
+    // Returns node's subtree without its last node, which is unlinked into last
+    NodePtr splitLast(NodePtr node, int height, NodePtr& last, int& restHeight);
+    // Splits node's subtree into the keys before key and after it, unlinking the node with key itself into match
+    void splitNodes(
+            NodePtr node,
+            int height,
+            const Key& key,
+            NodePtr& left,
+            int& leftHeight,
+            NodePtr& right,
+            int& rightHeight,
+            NodePtr& match);
+    void combine(SetOperation operation, AVLTree<Key, Value>& other, unsigned threads);
+    NodePtr combineNodes(SetOperation operation, NodePtr a, int aHeight, NodePtr b, int bHeight, int& height,
+            unsigned threads);
+
+    // Throws std::invalid_argument if the keys of [first, last) are not in order, and returns how many there are
+    template<class Iterator>
+    static size_t checkSorted(Iterator first, Iterator last);
     // You may implement a printRootAVL(...)
     // using the printRoot() function from the BST implementation
 };
@@ -124,7 +249,8 @@ void AVLTree<Key, Value>::rotateLeft(std::shared_ptr<AVLNode<Key, Value>> p, std
     auto g = p->getParent_AVL();
     auto nLeft = n->getLeft_AVL();
 
-    if (g == nullptr) {
+    // A detached subtree being split or joined has no parent either, but is not the root
+    if (g == nullptr && p == this->root_) {
         this->root_ = n;
     }
 
@@ -147,6 +273,9 @@ void AVLTree<Key, Value>::rotateLeft(std::shared_ptr<AVLNode<Key, Value>> p, std
         nLeft->setParent(p);
     }
     p->setRight(nLeft);
+
+    updateNode(p);
+    updateNode(n);
 }
 
 // Pre condition: p is the parent of n
@@ -156,7 +285,8 @@ void AVLTree<Key, Value>::rotateRight(std::shared_ptr<AVLNode<Key, Value>> p, st
     auto g = p->getParent_AVL();
     auto nRight = n->getRight_AVL();
 
-    if (g == nullptr) {
+    // A detached subtree being split or joined has no parent either, but is not the root
+    if (g == nullptr && p == this->root_) {
         this->root_ = n;
     }
     // Move n up
@@ -178,6 +308,9 @@ void AVLTree<Key, Value>::rotateRight(std::shared_ptr<AVLNode<Key, Value>> p, st
         nRight->setParent(p);
     }
     p->setLeft(nRight);
+
+    updateNode(p);
+    updateNode(n);
 }
 
 template<class Key, class Value>
@@ -186,7 +319,7 @@ void AVLTree<Key, Value>::insert(const std::pair<const Key, Value>& new_item) {
 
     // Empty AVL
     if (this->root_ == nullptr) {
-        this->root_ = std::make_shared<AVLNode<Key, Value>>(new_item.first, new_item.second, nullptr);
+        this->root_ = makeNode(new_item.first, new_item.second, nullptr);
 
         return;
     }
@@ -197,13 +330,14 @@ void AVLTree<Key, Value>::insert(const std::pair<const Key, Value>& new_item) {
         // Same key
         if (new_item.first == traverse->getKey()) {
             traverse->setValue(new_item.second);
+            updatePath(traverse);
             newNode.reset();
             return;
         }
         // Smaller key, go left
         else if (new_item.first < traverse->getKey()) {
             if (traverse->getLeft_AVL() == nullptr) {
-                newNode = std::make_shared<AVLNode<Key, Value>>(new_item.first, new_item.second, traverse);
+                newNode = makeNode(new_item.first, new_item.second, traverse);
                 newNode->setBalance(0);
                 traverse->setLeft(newNode);
                 break;
@@ -213,7 +347,7 @@ void AVLTree<Key, Value>::insert(const std::pair<const Key, Value>& new_item) {
         // Bigger key, go right
         else {
             if (traverse->getRight_AVL() == nullptr) {
-                newNode = std::make_shared<AVLNode<Key, Value>>(new_item.first, new_item.second, traverse);
+                newNode = makeNode(new_item.first, new_item.second, traverse);
                 newNode->setBalance(0);
                 traverse->setRight(newNode);
                 break;
@@ -222,6 +356,8 @@ void AVLTree<Key, Value>::insert(const std::pair<const Key, Value>& new_item) {
         }
     }
 
+    updatePath(traverse);
+
     // Update parent balance
     if (traverse->getBalance() == -1 || traverse->getBalance() == 1) {
         traverse->setBalance(0);
@@ -237,92 +373,97 @@ void AVLTree<Key, Value>::insert(const std::pair<const Key, Value>& new_item) {
 
 template<class Key, class Value>
 void AVLTree<Key, Value>::insertFix(std::shared_ptr<AVLNode<Key, Value>> p, std::shared_ptr<AVLNode<Key, Value>> n) {
-    auto g = p->getParent_AVL();
-    if (p == nullptr || g == nullptr) {
-        return;
-    }
+    // Walk up while the subtree under g keeps getting taller
+    while (p != nullptr && p->getParent_AVL() != nullptr) {
+        auto g = p->getParent_AVL();
 
-    // Assume p is the left child of g
-    if (p == g->getLeft_AVL()) {
-        g->updateBalance(-1);
-        // Case 1: b(g) == 0
-        if (g->getBalance() == 0) {
-            return;
-        }
-        // Case 2: b(g) == -1
-        else if (g->getBalance() == -1) {
-            insertFix(g, p);
-        }
-        // Case 3: b(g) == -2
-        else {
-            // zig-zig
-            if (n == p->getLeft_AVL()) {
-                rotateRight(g, p);
-                p->setBalance(0);
-                g->setBalance(0);
+        // Assume p is the left child of g
+        if (p == g->getLeft_AVL()) {
+            g->updateBalance(-1);
+            // Case 1: b(g) == 0
+            if (g->getBalance() == 0) {
+                return;
+            }
+            // Case 2: b(g) == -1
+            else if (g->getBalance() == -1) {
+                n = p;
+                p = g;
+                continue;
             }
-            // zig-zag
+            // Case 3: b(g) == -2
             else {
-                rotateLeft(p, n);
-                rotateRight(g, n);
-                // Case 3a : b(n) == -1 then b(p) = 0; b(g) = +1; b(n) = 0;
-                if (n->getBalance() == -1) {
-                    p->setBalance(0);
-                    g->setBalance(1);
-                }
-                // Case 3b: b(n) == 0 then b(p) = 0; b(g) = 0; b(n) = 0;
-                else if (n->getBalance() == 0) {
+                // zig-zig
+                if (n == p->getLeft_AVL()) {
+                    rotateRight(g, p);
                     p->setBalance(0);
                     g->setBalance(0);
                 }
-                // Case 3c: b(n) == +1 then b(p) = -1; b(g) = 0; b(n) = 0;
+                // zig-zag
                 else {
-                    p->setBalance(-1);
-                    g->setBalance(0);
+                    rotateLeft(p, n);
+                    rotateRight(g, n);
+                    // Case 3a : b(n) == -1 then b(p) = 0; b(g) = +1; b(n) = 0;
+                    if (n->getBalance() == -1) {
+                        p->setBalance(0);
+                        g->setBalance(1);
+                    }
+                    // Case 3b: b(n) == 0 then b(p) = 0; b(g) = 0; b(n) = 0;
+                    else if (n->getBalance() == 0) {
+                        p->setBalance(0);
+                        g->setBalance(0);
+                    }
+                    // Case 3c: b(n) == +1 then b(p) = -1; b(g) = 0; b(n) = 0;
+                    else {
+                        p->setBalance(-1);
+                        g->setBalance(0);
+                    }
+                    n->setBalance(0);
                 }
-                n->setBalance(0);
             }
-        }
-    } else {
-        g->updateBalance(1);
-        // Case 1: b(g) == 0
-        if (g->getBalance() == 0) {
-            return;
-        }
-        // Case 2: b(g) == 1
-        else if (g->getBalance() == 1) {
-            insertFix(g, p);
-        }
-        // Case 3: b(g) == 2
-        else {
-            // zig-zig
-            if (n == p->getRight_AVL()) {
-                rotateLeft(g, p);
-                p->setBalance(0);
-                g->setBalance(0);
+        } else {
+            g->updateBalance(1);
+            // Case 1: b(g) == 0
+            if (g->getBalance() == 0) {
+                return;
             }
-            // zig-zag
+            // Case 2: b(g) == 1
+            else if (g->getBalance() == 1) {
+                n = p;
+                p = g;
+                continue;
+            }
+            // Case 3: b(g) == 2
             else {
-                rotateRight(p, n);
-                rotateLeft(g, n);
-                // Case 3a : b(n) == -1 then b(p) = 0; b(g) = +1; b(n) = 0;
-                if (n->getBalance() == 1) {
-                    p->setBalance(0);
-                    g->setBalance(-1);
-                }
-                // Case 3b: b(n) == 0 then b(p) = 0; b(g) = 0; b(n) = 0;
-                else if (n->getBalance() == 0) {
+                // zig-zig
+                if (n == p->getRight_AVL()) {
+                    rotateLeft(g, p);
                     p->setBalance(0);
                     g->setBalance(0);
                 }
-                // Case 3c: b(n) == +1 then b(p) = -1; b(g) = 0; b(n) = 0;
+                // zig-zag
                 else {
-                    p->setBalance(1);
-                    g->setBalance(0);
+                    rotateRight(p, n);
+                    rotateLeft(g, n);
+                    // Case 3a : b(n) == -1 then b(p) = 0; b(g) = +1; b(n) = 0;
+                    if (n->getBalance() == 1) {
+                        p->setBalance(0);
+                        g->setBalance(-1);
+                    }
+                    // Case 3b: b(n) == 0 then b(p) = 0; b(g) = 0; b(n) = 0;
+                    else if (n->getBalance() == 0) {
+                        p->setBalance(0);
+                        g->setBalance(0);
+                    }
+                    // Case 3c: b(n) == +1 then b(p) = -1; b(g) = 0; b(n) = 0;
+                    else {
+                        p->setBalance(1);
+                        g->setBalance(0);
+                    }
+                    n->setBalance(0);
                 }
-                n->setBalance(0);
             }
         }
+        return;
     }
 }
 
@@ -361,25 +502,23 @@ void AVLTree<Key, Value>::remove(const Key& key) {
     } else {
         if (removeNode->getLeft_AVL() != nullptr) {
             if (removeNode->getParent_AVL() == nullptr) {
-                std::cerr << "IN GET LEFT AVL" << removeNode->getKey() << std::endl;
                 removeNode->getLeft_AVL()->setParent(nullptr);
                 this->root_ = removeNode->getLeft_AVL();
             } else {
                 if (removeNode == removeNode->getParent_AVL()->getLeft_AVL()) {
                     removeNode->getParent_AVL()->setLeft(removeNode->getLeft_AVL());
                 } else {
-                    removeNode->getParent_AVL()->setRight(removeNode->getRight_AVL());
+                    removeNode->getParent_AVL()->setRight(removeNode->getLeft_AVL());
                 }
                 removeNode->getLeft_AVL()->setParent(removeNode->getParent_AVL());
             }
         }
         if (removeNode->getRight_AVL() != nullptr) {
             if (removeNode->getParent_AVL() == nullptr) {
-                std::cerr << "IN GET RIGHT AVL" << removeNode->getKey() << std::endl;
                 removeNode->getRight_AVL()->setParent(nullptr);
                 this->root_ = removeNode->getRight_AVL();
             } else {
-                if (removeNode == removeNode->getParent_AVL()->getRight_AVL()) {
+                if (removeNode == removeNode->getParent_AVL()->getLeft_AVL()) {
                     removeNode->getParent_AVL()->setLeft(removeNode->getRight_AVL());
                 } else {
                     removeNode->getParent_AVL()->setRight(removeNode->getRight_AVL());
@@ -390,134 +529,629 @@ void AVLTree<Key, Value>::remove(const Key& key) {
     }
 
     removeNode.reset();
+    updatePath(p);
     removeFix(p, diff);
     return;
 }
 
 template<class Key, class Value>
-void AVLTree<Key, Value>::removeFix(std::shared_ptr<AVLNode<Key, Value>> n, int diff) {  // 3, -1
-    // If n is null, return
-    if (n == nullptr) {
-        return;
-    }
+void AVLTree<Key, Value>::removeFix(std::shared_ptr<AVLNode<Key, Value>> n, int diff) {
+    // Walk up while the subtree under n keeps getting shorter
+    while (n != nullptr) {
+        int ndiff = 0;
+        auto p = n->getParent_AVL();
+        std::shared_ptr<AVLNode<Key, Value>> c = nullptr;
+        std::shared_ptr<AVLNode<Key, Value>> g = nullptr;
 
-    int ndiff = 0;
-    auto p = n->getParent_AVL();
-    std::shared_ptr<AVLNode<Key, Value>> c = nullptr;
-    std::shared_ptr<AVLNode<Key, Value>> g = nullptr;
-
-    // Compute next recursive call's arguments now before altering tree
-    if (p != nullptr) {
-        if (BinarySearchTree<Key, Value>::isLeftChild(n)) {
-            ndiff = 1;
-        } else {
-            ndiff = -1;
+        // Compute the next step's arguments now before altering tree
+        if (p != nullptr) {
+            if (BinarySearchTree<Key, Value>::isLeftChild(n)) {
+                ndiff = 1;
+            } else {
+                ndiff = -1;
+            }
         }
-    }
 
-    // Assume diff = -1, node from right subtree removed
-    if (diff == -1) {
-        // Case 1: b(n) + diff == -2
-        if (n->getBalance() + diff == -2) {
-            c = n->getLeft_AVL();
-            // Case 1a: b(c) == -1 (zig-zig case)
-            if (c->getBalance() == -1) {
-                rotateRight(n, c);
-                n->setBalance(0);
-                c->setBalance(0);
-                removeFix(p, ndiff);
+        // Assume diff = -1, node from right subtree removed
+        if (diff == -1) {
+            // Case 1: b(n) + diff == -2
+            if (n->getBalance() + diff == -2) {
+                c = n->getLeft_AVL();
+                // Case 1a: b(c) == -1 (zig-zig case)
+                if (c->getBalance() == -1) {
+                    rotateRight(n, c);
+                    n->setBalance(0);
+                    c->setBalance(0);
+                    n = p;
+                    diff = ndiff;
+                    continue;
+                }
+                // Case 1b: b(c) == 0 (zig-zig case)
+                else if (c->getBalance() == 0) {
+                    rotateRight(n, c);
+                    n->setBalance(-1);
+                    c->setBalance(1);
+                    return;
+                }
+                // Case 1c: b(c) == +1 (zig zag case)
+                else {
+                    auto g = c->getRight_AVL();
+                    rotateLeft(c, g);
+                    rotateRight(n, g);
+                    if (g->getBalance() == 1) {
+                        n->setBalance(0);
+                        c->setBalance(-1);
+                        g->setBalance(0);
+                    } else if (g->getBalance() == 0) {
+                        n->setBalance(0);
+                        c->setBalance(0);
+                        g->setBalance(0);
+                    } else {
+                        n->setBalance(1);
+                        c->setBalance(0);
+                        g->setBalance(0);
+                    }
+                    n = p;
+                    diff = ndiff;
+                    continue;
+                }
             }
-            // Case 1b: b(c) == 0 (zig-zig case)
-            else if (c->getBalance() == 0) {
-                rotateRight(n, c);
+            // Case 2: b(n) + diff == -1
+            else if (n->getBalance() + diff == -1) {
                 n->setBalance(-1);
-                c->setBalance(1);
                 return;
             }
-            // Case 1c: b(c) == +1 (zig zag case)
+            // Case 3: b(n) + diff == 0
             else {
-                auto g = c->getRight_AVL();
-                rotateLeft(c, g);
-                rotateRight(n, c);
-                if (g->getBalance() == 1) {
-                    n->setBalance(0);
-                    c->setBalance(-1);
-                    g->setBalance(0);
-                } else if (g->getBalance() == 0) {
+                n->setBalance(0);
+                n = p;
+                diff = ndiff;
+                continue;
+            }
+        }
+
+        // Assume diff = 1, node from left subtree removed
+        if (diff == 1) {
+            // Case 1: b(n) + diff == 2
+            if (n->getBalance() + diff == 2) {
+                c = n->getRight_AVL();
+                // Case 1a: b(c) == +1 (zig-zig case)
+                if (c->getBalance() == 1) {
+                    rotateLeft(n, c);
                     n->setBalance(0);
                     c->setBalance(0);
-                    g->setBalance(0);
-                } else {
+                    n = p;
+                    diff = ndiff;
+                    continue;
+                }
+                // Case 1b: b(c) == 0 (zig-zig case)
+                else if (c->getBalance() == 0) {
+                    rotateLeft(n, c);
                     n->setBalance(1);
-                    c->setBalance(0);
-                    g->setBalance(0);
+                    c->setBalance(-1);
+                    return;
+                }
+                // Case 1c: b(c) == -1 (zig zag case)
+                else {
+                    auto g = c->getLeft_AVL();
+                    rotateRight(c, g);
+                    rotateLeft(n, g);
+                    if (g->getBalance() == -1) {
+                        n->setBalance(0);
+                        c->setBalance(1);
+                        g->setBalance(0);
+                    } else if (g->getBalance() == 0) {
+                        n->setBalance(0);
+                        c->setBalance(0);
+                        g->setBalance(0);
+                    } else {
+                        n->setBalance(-1);
+                        c->setBalance(0);
+                        g->setBalance(0);
+                    }
+                    n = p;
+                    diff = ndiff;
+                    continue;
                 }
-                removeFix(p, ndiff);
-            }
-        }
-        // Case 2: b(n) + diff == -1
-        else if (n->getBalance() + diff == -1) {
-            n->setBalance(-1);
-            return;
-        }
-        // Case 3: b(n) + diff == 0
-        else {
-            n->setBalance(0);
-            removeFix(p, ndiff);
-        }
-    }
-
-    // Assume diff = 1, node from left subtree removed
-    if (diff == 1) {
-        // Case 1: b(n) + diff == 2
-        if (n->getBalance() + diff == 2) {
-            c = n->getRight_AVL();
-            // Case 1a: b(c) == +1 (zig-zig case)
-            if (c->getBalance() == 1) {
-                rotateLeft(n, c);
-                n->setBalance(0);
-                c->setBalance(0);
-                removeFix(p, ndiff);
             }
-            // Case 1b: b(c) == 0 (zig-zig case)
-            else if (c->getBalance() == 0) {
-                rotateLeft(n, c);
+            // Case 2: b(n) + diff == 1
+            else if (n->getBalance() + diff == 1) {
                 n->setBalance(1);
-                c->setBalance(-1);
                 return;
             }
-            // Case 1c: b(c) == -1 (zig zag case)
+            // Case 3: b(n) + diff == 0
             else {
-                auto g = c->getLeft_AVL();
-                rotateRight(c, g);
-                rotateLeft(n, c);
-                if (g->getBalance() == -1) {
-                    n->setBalance(0);
-                    c->setBalance(1);
-                    g->setBalance(0);
-                } else if (g->getBalance() == 0) {
-                    n->setBalance(0);
-                    c->setBalance(0);
-                    g->setBalance(0);
-                } else {
-                    n->setBalance(-1);
-                    c->setBalance(0);
-                    g->setBalance(0);
-                }
-                removeFix(p, ndiff);
+                n->setBalance(0);
+                n = p;
+                diff = ndiff;
+                continue;
             }
         }
-        // Case 2: b(n) + diff == 1
-        else if (n->getBalance() + diff == 1) {
-            n->setBalance(1);
+        return;
+    }
+}
+
+template<class Key, class Value>
+template<class Iterator>
+size_t AVLTree<Key, Value>::checkSorted(Iterator first, Iterator last) {
+    size_t count = 0;
+    for (Iterator prev = first; first != last; prev = first, ++count) {
+        if (++first != last && first->first < prev->first) {
+            throw std::invalid_argument("keys are not sorted");
+        }
+    }
+    return count;
+}
+
+template<class Key, class Value>
+std::shared_ptr<AVLNode<Key, Value>> AVLTree<Key, Value>::linkBalanced(
+        const NodeList& nodes,
+        size_t lo,
+        size_t hi,
+        std::shared_ptr<AVLNode<Key, Value>> parent,
+        int& height,
+        unsigned threads) {
+    if (lo == hi) {
+        height = 0;
+        return nullptr;
+    }
+    size_t mid = lo + (hi - lo) / 2;
+    std::shared_ptr<AVLNode<Key, Value>> root = nodes[mid];
+    int leftHeight = 0;
+    int rightHeight = 0;
+    root->setParent(parent);
+    if (threads > 1 && hi - lo > PARALLEL_GRAIN) {
+        // The halves share no nodes, so the left one can be linked on another thread
+        std::shared_ptr<AVLNode<Key, Value>> left;
+        std::thread worker([&]() { left = linkBalanced(nodes, lo, mid, root, leftHeight, threads / 2); });
+        root->setRight(linkBalanced(nodes, mid + 1, hi, root, rightHeight, threads - threads / 2));
+        worker.join();
+        root->setLeft(left);
+    } else {
+        root->setLeft(linkBalanced(nodes, lo, mid, root, leftHeight));
+        root->setRight(linkBalanced(nodes, mid + 1, hi, root, rightHeight));
+    }
+    root->setBalance(rightHeight - leftHeight);
+    updateNode(root);
+    height = 1 + std::max(leftHeight, rightHeight);
+    return root;
+}
+
+template<class Key, class Value>
+bool AVLTree<Key, Value>::collectForMerge(size_t batch, NodeList& nodes) const {
+    // Stop as soon as the tree is too big, so a small batch costs a walk over at most MERGE_RATIO times its size
+    size_t limit = batch * MERGE_RATIO;
+    for (auto node = this->getSmallestNode(); node != nullptr; node = this->successor(node)) {
+        if (nodes.size() == limit) {
+            nodes.clear();
+            return false;
+        }
+        nodes.push_back(std::static_pointer_cast<AVLNode<Key, Value>>(node));
+    }
+    return true;
+}
+
+template<class Key, class Value>
+template<class Iterator>
+void AVLTree<Key, Value>::buildSorted(Iterator first, Iterator last) {
+    this->clear();
+    mergeSorted(first, last);
+}
+
+template<class Key, class Value>
+template<class Iterator>
+void AVLTree<Key, Value>::mergeSorted(Iterator first, Iterator last, unsigned threads) {
+    size_t batch = checkSorted(first, last);
+
+    NodeList existing;
+    if (!collectForMerge(batch, existing)) {
+        for (; first != last; ++first) {
+            insert(std::pair<const Key, Value>(first->first, first->second));
+        }
+        return;
+    }
+
+    // Merge the batch into the tree's nodes, making nodes for new keys and updating the values of existing ones
+    NodeList merged;
+    merged.reserve(existing.size() + batch);
+    size_t i = 0;
+    for (; first != last; ++first) {
+        while (i < existing.size() && existing[i]->getKey() < first->first) {
+            merged.push_back(existing[i++]);
+        }
+        if (!merged.empty() && merged.back()->getKey() == first->first) {
+            merged.back()->setValue(first->second);
+        } else if (i < existing.size() && existing[i]->getKey() == first->first) {
+            existing[i]->setValue(first->second);
+            merged.push_back(existing[i++]);
+        } else {
+            merged.push_back(makeNode(first->first, first->second, nullptr));
+        }
+    }
+    merged.insert(merged.end(), existing.begin() + i, existing.end());
+
+    int treeHeight = 0;
+    this->root_ = linkBalanced(merged, 0, merged.size(), nullptr, treeHeight, threads);
+}
+
+template<class Key, class Value>
+template<class Iterator>
+void AVLTree<Key, Value>::insertBatch(Iterator first, Iterator last, unsigned threads) {
+    std::vector<std::pair<Key, Value>> items(first, last);
+    // Stable, so that when a key repeats the last value still wins
+    std::stable_sort(items.begin(), items.end(), [](const std::pair<Key, Value>& a, const std::pair<Key, Value>& b) {
+        return a.first < b.first;
+    });
+    mergeSorted(items.begin(), items.end(), threads);
+}
+
+template<class Key, class Value>
+template<class Iterator>
+void AVLTree<Key, Value>::removeBatch(Iterator first, Iterator last, unsigned threads) {
+    std::vector<Key> keys(first, last);
+    std::sort(keys.begin(), keys.end());
+
+    NodeList existing;
+    if (!collectForMerge(keys.size(), existing)) {
+        for (const Key& key : keys) {
+            remove(key);
+        }
+        return;
+    }
+
+    // Keep the nodes whose keys are not in the batch. The removed ones are unlinked from everything, since a parent
+    // and child pointing at each other would keep each other alive.
+    NodeList kept;
+    kept.reserve(existing.size());
+    size_t i = 0;
+    for (const std::shared_ptr<AVLNode<Key, Value>>& node : existing) {
+        while (i < keys.size() && keys[i] < node->getKey()) {
+            i++;
+        }
+        if (i < keys.size() && !(node->getKey() < keys[i])) {
+            node->setParent(nullptr);
+            node->setLeft(nullptr);
+            node->setRight(nullptr);
+        } else {
+            kept.push_back(node);
+        }
+    }
+
+    int treeHeight = 0;
+    this->root_ = linkBalanced(kept, 0, kept.size(), nullptr, treeHeight, threads);
+}
+
+template<class Key, class Value>
+template<class Iterator>
+std::vector<typename BinarySearchTree<Key, Value>::iterator>
+AVLTree<Key, Value>::findBatch(Iterator first, Iterator last, unsigned threads) const {
+    std::vector<std::pair<Key, size_t>> keys;
+    for (size_t index = 0; first != last; ++first, ++index) {
+        keys.push_back(std::make_pair(*first, index));
+    }
+    std::sort(keys.begin(), keys.end());
+    std::vector<typename BinarySearchTree<Key, Value>::iterator> results(keys.size(), this->end());
+    findRange(this->root_, keys, 0, keys.size(), results, threads);
+    return results;
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::findRange(
+        std::shared_ptr<Node<Key, Value>> node,
+        const std::vector<std::pair<Key, size_t>>& keys,
+        size_t lo,
+        size_t hi,
+        std::vector<typename BinarySearchTree<Key, Value>::iterator>& results,
+        unsigned threads) const {
+    while (node != nullptr && lo < hi) {
+        // Split the keys into those before the node's key, equal to it and after it
+        const Key& key = node->getKey();
+        size_t equal = std::lower_bound(
+                keys.begin() + lo, keys.begin() + hi, key,
+                [](const std::pair<Key, size_t>& a, const Key& b) { return a.first < b; }) - keys.begin();
+        size_t after = std::upper_bound(
+                keys.begin() + equal, keys.begin() + hi, key,
+                [](const Key& a, const std::pair<Key, size_t>& b) { return a < b.first; }) - keys.begin();
+        for (size_t i = equal; i < after; i++) {
+            results[keys[i].second] = this->iteratorAt(node);
+        }
+
+        // Each side writes only its own keys' results, so the left one can be searched on another thread
+        if (threads > 1 && hi - lo > PARALLEL_GRAIN) {
+            std::thread worker([&]() { findRange(node->getLeft(), keys, lo, equal, results, threads / 2); });
+            findRange(node->getRight(), keys, after, hi, results, threads - threads / 2);
+            worker.join();
             return;
         }
-        // Case 3: b(n) + diff == 0
-        else {
-            n->setBalance(0);
-            removeFix(p, ndiff);
+        findRange(node->getLeft(), keys, lo, equal, results, 1);
+        node = node->getRight();
+        lo = after;
+    }
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::split(const Key& key, AVLTree<Key, Value>& right) {
+    if (&right == this) {
+        throw std::invalid_argument("cannot split a tree into itself");
+    }
+    right.clear();
+    NodePtr root = std::static_pointer_cast<AVLNode<Key, Value>>(this->root_);
+    this->root_ = nullptr;
+
+    NodePtr left, rest, match;
+    int leftHeight = 0;
+    int restHeight = 0;
+    splitNodes(root, heightOf(root), key, left, leftHeight, rest, restHeight, match);
+    this->root_ = left;
+    if (match != nullptr) {
+        int height = 0;
+        rest = joinNodes(nullptr, 0, match, rest, restHeight, height);
+    }
+    right.root_ = rest;
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::join(AVLTree<Key, Value>& left, AVLTree<Key, Value>& right) {
+    if (left.root_ != nullptr && right.root_ != nullptr
+        && !(left.getLargestNode()->getKey() < right.getSmallestNode()->getKey())) {
+        throw std::invalid_argument("keys to join are not in order");
+    }
+    NodePtr leftRoot = std::static_pointer_cast<AVLNode<Key, Value>>(left.root_);
+    NodePtr rightRoot = std::static_pointer_cast<AVLNode<Key, Value>>(right.root_);
+    left.root_ = nullptr;
+    right.root_ = nullptr;
+    this->clear();
+
+    int height = 0;
+    this->root_ = joinNodes(leftRoot, heightOf(leftRoot), rightRoot, heightOf(rightRoot), height);
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::unionWith(AVLTree<Key, Value>& other, unsigned threads) {
+    combine(UNION, other, threads);
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::intersectWith(AVLTree<Key, Value>& other, unsigned threads) {
+    combine(INTERSECTION, other, threads);
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::subtract(AVLTree<Key, Value>& other, unsigned threads) {
+    combine(DIFFERENCE, other, threads);
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::combine(SetOperation operation, AVLTree<Key, Value>& other, unsigned threads) {
+    if (&other == this) {
+        if (operation == DIFFERENCE) {
+            this->clear();
+        }
+        return;
+    }
+    NodePtr a = std::static_pointer_cast<AVLNode<Key, Value>>(this->root_);
+    NodePtr b = std::static_pointer_cast<AVLNode<Key, Value>>(other.root_);
+    this->root_ = nullptr;
+    other.root_ = nullptr;
+
+    int height = 0;
+    this->root_ = combineNodes(operation, a, heightOf(a), b, heightOf(b), height, threads);
+}
+
+template<class Key, class Value>
+int AVLTree<Key, Value>::heightOf(NodePtr node) {
+    // Follow the taller side down
+    int height = 0;
+    for (; node != nullptr; height++) {
+        node = node->getBalance() < 0 ? node->getLeft_AVL() : node->getRight_AVL();
+    }
+    return height;
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::unlink(
+        NodePtr node, int height, NodePtr& left, int& leftHeight, NodePtr& right, int& rightHeight) {
+    left = node->getLeft_AVL();
+    right = node->getRight_AVL();
+    leftHeight = height - (node->getBalance() > 0 ? 2 : 1);
+    rightHeight = height - (node->getBalance() < 0 ? 2 : 1);
+    if (left != nullptr) {
+        left->setParent(nullptr);
+    }
+    if (right != nullptr) {
+        right->setParent(nullptr);
+    }
+    node->setLeft(nullptr);
+    node->setRight(nullptr);
+    node->setParent(nullptr);
+    node->setBalance(0);
+}
+
+template<class Key, class Value>
+typename AVLTree<Key, Value>::NodePtr AVLTree<Key, Value>::joinNodes(
+        NodePtr left, int leftHeight, NodePtr mid, NodePtr right, int rightHeight, int& height) {
+    if (leftHeight <= rightHeight + 1 && rightHeight <= leftHeight + 1) {
+        mid->setLeft(left);
+        mid->setRight(right);
+        if (left != nullptr) {
+            left->setParent(mid);
+        }
+        if (right != nullptr) {
+            right->setParent(mid);
         }
+        mid->setBalance(rightHeight - leftHeight);
+        updateNode(mid);
+        height = 1 + std::max(leftHeight, rightHeight);
+        return mid;
+    }
+
+    // Go down the inner side of the taller subtree to the first subtree at most one taller than the shorter one, and
+    // put mid in its place, over it and the shorter subtree
+    bool leftTaller = leftHeight > rightHeight;
+    NodePtr top = leftTaller ? left : right;
+    NodePtr shorter = leftTaller ? right : left;
+    int topHeight = leftTaller ? leftHeight : rightHeight;
+    int shorterHeight = leftTaller ? rightHeight : leftHeight;
+    NodePtr parent;
+    NodePtr inner = top;
+    int innerHeight = topHeight;
+    while (innerHeight > shorterHeight + 1) {
+        parent = inner;
+        if (leftTaller) {
+            innerHeight -= inner->getBalance() < 0 ? 2 : 1;
+            inner = inner->getRight_AVL();
+        } else {
+            innerHeight -= inner->getBalance() > 0 ? 2 : 1;
+            inner = inner->getLeft_AVL();
+        }
+    }
+    if (leftTaller) {
+        mid->setLeft(inner);
+        mid->setRight(shorter);
+        mid->setBalance(shorterHeight - innerHeight);
+        parent->setRight(mid);
+    } else {
+        mid->setLeft(shorter);
+        mid->setRight(inner);
+        mid->setBalance(innerHeight - shorterHeight);
+        parent->setLeft(mid);
+    }
+    mid->setParent(parent);
+    if (inner != nullptr) {
+        inner->setParent(mid);
+    }
+    if (shorter != nullptr) {
+        shorter->setParent(mid);
+    }
+
+    // mid's subtree is one taller than inner's was, as if mid had just been inserted, so rebalance as insert would.
+    // The subtree only gets taller if that reaches top and tips it off balance without a rotation.
+    char topBalance = top->getBalance();
+    updatePath(mid);
+    insertFix(mid, inner);
+    if (top->getParent_AVL() != nullptr) {
+        height = topHeight;
+        return top->getParent_AVL();
+    }
+    height = topBalance == 0 && top->getBalance() != 0 ? topHeight + 1 : topHeight;
+    return top;
+}
+
+template<class Key, class Value>
+typename AVLTree<Key, Value>::NodePtr
+AVLTree<Key, Value>::joinNodes(NodePtr left, int leftHeight, NodePtr right, int rightHeight, int& height) {
+    if (left == nullptr) {
+        height = rightHeight;
+        return right;
+    }
+    NodePtr last;
+    int restHeight = 0;
+    NodePtr rest = splitLast(left, leftHeight, last, restHeight);
+    return joinNodes(rest, restHeight, last, right, rightHeight, height);
+}
+
+template<class Key, class Value>
+typename AVLTree<Key, Value>::NodePtr
+AVLTree<Key, Value>::splitLast(NodePtr node, int height, NodePtr& last, int& restHeight) {
+    NodePtr left, right;
+    int leftHeight = 0;
+    int rightHeight = 0;
+    unlink(node, height, left, leftHeight, right, rightHeight);
+    if (right == nullptr) {
+        last = node;
+        restHeight = leftHeight;
+        return left;
+    }
+    int restRightHeight = 0;
+    NodePtr rest = splitLast(right, rightHeight, last, restRightHeight);
+    return joinNodes(left, leftHeight, node, rest, restRightHeight, restHeight);
+}
+
+template<class Key, class Value>
+void AVLTree<Key, Value>::splitNodes(
+        NodePtr node,
+        int height,
+        const Key& key,
+        NodePtr& left,
+        int& leftHeight,
+        NodePtr& right,
+        int& rightHeight,
+        NodePtr& match) {
+    if (node == nullptr) {
+        left = right = match = nullptr;
+        leftHeight = rightHeight = 0;
+        return;
+    }
+    // Each node on the way down is joined back onto the pieces on its side, shortest first, so the joins cost
+    // O(log n) altogether
+    NodePtr nodeLeft, nodeRight, piece;
+    int nodeLeftHeight = 0;
+    int nodeRightHeight = 0;
+    int pieceHeight = 0;
+    unlink(node, height, nodeLeft, nodeLeftHeight, nodeRight, nodeRightHeight);
+    if (key < node->getKey()) {
+        splitNodes(nodeLeft, nodeLeftHeight, key, left, leftHeight, piece, pieceHeight, match);
+        right = joinNodes(piece, pieceHeight, node, nodeRight, nodeRightHeight, rightHeight);
+    } else if (node->getKey() < key) {
+        splitNodes(nodeRight, nodeRightHeight, key, piece, pieceHeight, right, rightHeight, match);
+        left = joinNodes(nodeLeft, nodeLeftHeight, node, piece, pieceHeight, leftHeight);
+    } else {
+        left = nodeLeft;
+        leftHeight = nodeLeftHeight;
+        right = nodeRight;
+        rightHeight = nodeRightHeight;
+        match = node;
+    }
+}
+
+template<class Key, class Value>
+typename AVLTree<Key, Value>::NodePtr AVLTree<Key, Value>::combineNodes(
+        SetOperation operation, NodePtr a, int aHeight, NodePtr b, int bHeight, int& height, unsigned threads) {
+    if (a == nullptr || b == nullptr) {
+        NodePtr kept = operation == UNION ? (a != nullptr ? a : b) : (operation == DIFFERENCE ? a : nullptr);
+        height = kept == a ? aHeight : (kept == b ? bHeight : 0);
+        this->clearHelper(kept == a ? b : a);
+        return kept;
     }
+
+    // Split b around a's root, and combine the halves on each side
+    NodePtr aLeft, aRight, bLeft, bRight, match;
+    int aLeftHeight = 0;
+    int aRightHeight = 0;
+    int bLeftHeight = 0;
+    int bRightHeight = 0;
+    unlink(a, aHeight, aLeft, aLeftHeight, aRight, aRightHeight);
+    splitNodes(b, bHeight, a->getKey(), bLeft, bLeftHeight, bRight, bRightHeight, match);
+
+    NodePtr left, right;
+    int leftHeight = 0;
+    int rightHeight = 0;
+    if (threads > 1 && std::min(aHeight, bHeight) > PARALLEL_HEIGHT) {
+        // The halves share no nodes, so the left one can be combined on another thread
+        std::thread worker([&]() {
+            left = combineNodes(operation, aLeft, aLeftHeight, bLeft, bLeftHeight, leftHeight, threads / 2);
+        });
+        right = combineNodes(operation, aRight, aRightHeight, bRight, bRightHeight, rightHeight, threads - threads / 2);
+        worker.join();
+    } else {
+        left = combineNodes(operation, aLeft, aLeftHeight, bLeft, bLeftHeight, leftHeight, 1);
+        right = combineNodes(operation, aRight, aRightHeight, bRight, bRightHeight, rightHeight, 1);
+    }
+
+    // Put a's root back between the halves unless the operation drops its key
+    if (operation == UNION && match != nullptr) {
+        a->setValue(match->getValue());
+    }
+    if (operation == UNION || (operation == INTERSECTION) == (match != nullptr)) {
+        return joinNodes(left, leftHeight, a, right, rightHeight, height);
+    }
+    return joinNodes(left, leftHeight, right, rightHeight, height);
+}
+
+template<class Key, class Value>
+std::shared_ptr<AVLNode<Key, Value>>
+AVLTree<Key, Value>::makeNode(const Key& key, const Value& value, std::shared_ptr<AVLNode<Key, Value>> parent) {
+    return std::make_shared<AVLNode<Key, Value>>(key, value, parent);
 }
 
 // Function already completed for you
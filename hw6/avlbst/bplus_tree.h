@@ -0,0 +1,640 @@
+#ifndef BPLUS_TREE_H
+#define BPLUS_TREE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/**
+ * Searches within one node's sorted keys: how many of keys[0, count) are less than key, or not greater than it.
+ * Key arrays are padded to a multiple of 4 so the int version can read whole 128 bit blocks.
+ */
+template<class Key>
+struct NodeKeySearch {
+    static size_t countLess(const Key* keys, size_t count, const Key& key) {
+        return std::lower_bound(keys, keys + count, key) - keys;
+    }
+
+    static size_t countNotGreater(const Key* keys, size_t count, const Key& key) {
+        return std::upper_bound(keys, keys + count, key) - keys;
+    }
+};
+
+#ifdef __SSE2__
+// Compares four keys at a time, stopping at the first block that is not entirely below key
+template<>
+struct NodeKeySearch<int> {
+    static size_t countLess(const int* keys, size_t count, int key) {
+        __m128i target = _mm_set1_epi32(key);
+        size_t less = 0;
+        for (size_t i = 0; i < count; i += 4) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+            int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, target))) & validLanes(count - i);
+            less += __builtin_popcount(mask);
+            if (mask != 0xf) {
+                break;
+            }
+        }
+        return less;
+    }
+
+    static size_t countNotGreater(const int* keys, size_t count, int key) {
+        __m128i target = _mm_set1_epi32(key);
+        size_t notGreater = 0;
+        for (size_t i = 0; i < count; i += 4) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+            int mask = ~_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(block, target))) & validLanes(count - i);
+            notGreater += __builtin_popcount(mask);
+            if (mask != 0xf) {
+                break;
+            }
+        }
+        return notGreater;
+    }
+
+    static int validLanes(size_t left) { return left >= 4 ? 0xf : (1 << left) - 1; }
+};
+#endif
+
+/**
+ * An ordered map with the same insert/remove/find/iterator interface as AVLTree, for read-heavy indexes.
+ *
+ * A B+-tree: every item is in a leaf, inner nodes only hold separator keys, and all leaves are at the same depth and
+ * linked in key order, so a lookup touches a few wide nodes instead of log2(n) scattered ones and a scan walks the
+ * leaves in sequence. Each node's keys take about two cache lines (at least 4 keys) and are kept apart from its
+ * children or items, so a search within a node reads only them; int keys are compared four at a time with SSE2.
+ *
+ * Nodes other than the root are kept at least half full by borrowing from or merging with a sibling on remove.
+ * Inserts and removes move items within a leaf, so they invalidate iterators and references into that leaf.
+ * Key must be default constructible.
+ *
+ * The iterator is this class's own rather than BinarySearchTree's, whose iterator holds a Node while items here sit
+ * in leaf arrays, and it only goes forward: leaves link to the next one only, which is all a scan needs.
+ */
+template<class Key, class Value>
+class BPlusTree {
+public:
+    BPlusTree();
+    ~BPlusTree();
+
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+    bool isBalanced() const;
+    bool empty() const;
+    size_t size() const;
+
+protected:
+    struct Leaf;
+
+public:
+    class iterator {
+    public:
+        iterator();
+
+        std::pair<const Key, Value>& operator*() const;
+        std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class BPlusTree<Key, Value>;
+        iterator(Leaf* leaf, size_t index);
+        Leaf* leaf_;
+        size_t index_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+
+    // The first item with a key not less than key, or end() if there is none
+    iterator lowerBound(const Key& key) const;
+
+    // Calls visit(item) on each item with a key in [lo, hi), in order, walking the linked leaves
+    template<class Visit>
+    void forEachInRange(const Key& lo, const Key& hi, Visit visit) const;
+
+protected:
+    typedef std::pair<const Key, Value> Item;
+
+    static const size_t CACHE_LINE = 64;
+    static const size_t CAPACITY = 2 * CACHE_LINE / sizeof(Key) < 4 ? 4 : 2 * CACHE_LINE / sizeof(Key);
+    static const size_t MIN_COUNT = CAPACITY / 2;
+
+    // One slot more than CAPACITY for a node about to split, rounded up for NodeKeySearch
+    static const size_t KEY_SLOTS = (CAPACITY + 1 + 3) / 4 * 4;
+
+    struct Node {
+        explicit Node(bool leaf);
+
+        Key keys[KEY_SLOTS];
+        size_t count;
+        bool leaf;
+    };
+
+    // keys[i] is the smallest key children[i + 1] can hold, so children[i] only holds keys below it
+    struct Inner : Node {
+        Inner();
+
+        Node* children[CAPACITY + 2];
+    };
+
+    struct Leaf : Node {
+        Leaf();
+
+        typename std::aligned_storage<sizeof(Item), alignof(Item)>::type items[CAPACITY + 1];
+        Leaf* next;
+
+        Item& item(size_t index);
+    };
+
+    // What an insert hands back up when it split a node: the new right sibling and the smallest key it can hold
+    struct Split {
+        Node* right;
+        Key separator;
+    };
+
+    static Inner* inner(Node* node);
+    static Leaf* leaf(Node* node);
+
+    // Moves the item at from in source to the empty slot to in target
+    static void moveItem(Leaf* source, size_t from, Leaf* target, size_t to);
+
+    // Return whether node split, filling split
+    bool insertAt(Node* node, const Item& keyValuePair, Split& split);
+    bool insertIntoLeaf(Leaf* node, const Item& keyValuePair, Split& split);
+
+    // Return whether key was removed; children left with fewer than MIN_COUNT keys are fixed by the caller
+    bool removeAt(Node* node, const Key& key);
+    void fixChild(Inner* parent, size_t index);
+    void merge(Inner* parent, size_t index);
+
+    Leaf* lowerBoundLeaf(const Key& key, size_t& index) const;
+
+    static void deleteAll(Node* node);
+
+    // Returns the depth of node's leaves, or -1 if they differ or a node is out of order or too empty
+    static int checkedDepth(const Node* node, const Key* lo, const Key* hi, bool root);
+
+    Node* root_;
+    size_t size_;
+};
+
+/*
+--------------------------------------------------------
+Begin implementations for the BPlusTree::iterator class.
+--------------------------------------------------------
+*/
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::iterator::iterator() : leaf_(nullptr), index_(0) {}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::iterator::iterator(Leaf* leaf, size_t index) : leaf_(leaf), index_(index) {}
+
+template<class Key, class Value>
+std::pair<const Key, Value>& BPlusTree<Key, Value>::iterator::operator*() const {
+    return leaf_->item(index_);
+}
+
+template<class Key, class Value>
+std::pair<const Key, Value>* BPlusTree<Key, Value>::iterator::operator->() const {
+    return &leaf_->item(index_);
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::iterator::operator==(const iterator& rhs) const {
+    return leaf_ == rhs.leaf_ && index_ == rhs.index_;
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::iterator::operator!=(const iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator& BPlusTree<Key, Value>::iterator::operator++() {
+    if (++index_ == leaf_->count) {
+        leaf_ = leaf_->next;
+        index_ = 0;
+    }
+    return *this;
+}
+
+/*
+-----------------------------------------------
+Begin implementations for the BPlusTree class.
+-----------------------------------------------
+*/
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::Node::Node(bool leaf) : keys(), count(0), leaf(leaf) {}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::Inner::Inner() : Node(false), children() {}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::Leaf::Leaf() : Node(true), next(nullptr) {}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::Item& BPlusTree<Key, Value>::Leaf::item(size_t index) {
+    return *reinterpret_cast<Item*>(&items[index]);
+}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::BPlusTree() : root_(nullptr), size_(0) {}
+
+template<class Key, class Value>
+BPlusTree<Key, Value>::~BPlusTree() {
+    clear();
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::Inner* BPlusTree<Key, Value>::inner(Node* node) {
+    return static_cast<Inner*>(node);
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::Leaf* BPlusTree<Key, Value>::leaf(Node* node) {
+    return static_cast<Leaf*>(node);
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::moveItem(Leaf* source, size_t from, Leaf* target, size_t to) {
+    new (&target->items[to]) Item(std::move(source->item(from)));
+    source->item(from).~Item();
+    target->keys[to] = source->keys[from];
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::deleteAll(Node* node) {
+    if (node->leaf) {
+        Leaf* items = leaf(node);
+        for (size_t i = 0; i < items->count; i++) {
+            items->item(i).~Item();
+        }
+        delete items;
+    } else {
+        for (size_t i = 0; i <= node->count; i++) {
+            deleteAll(inner(node)->children[i]);
+        }
+        delete inner(node);
+    }
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::clear() {
+    if (root_ != nullptr) {
+        deleteAll(root_);
+    }
+    root_ = nullptr;
+    size_ = 0;
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::empty() const {
+    return size_ == 0;
+}
+
+template<class Key, class Value>
+size_t BPlusTree<Key, Value>::size() const {
+    return size_;
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair) {
+    if (root_ == nullptr) {
+        root_ = new Leaf();
+    }
+    Split split;
+    if (insertAt(root_, keyValuePair, split)) {
+        // Grow a level: the new root separates the old one from its new sibling
+        Inner* root = new Inner();
+        root->keys[0] = split.separator;
+        root->children[0] = root_;
+        root->children[1] = split.right;
+        root->count = 1;
+        root_ = root;
+    }
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::insertAt(Node* node, const Item& keyValuePair, Split& split) {
+    if (node->leaf) {
+        return insertIntoLeaf(leaf(node), keyValuePair, split);
+    }
+
+    Inner* parent = inner(node);
+    size_t index = NodeKeySearch<Key>::countNotGreater(parent->keys, parent->count, keyValuePair.first);
+    Split childSplit;
+    if (!insertAt(parent->children[index], keyValuePair, childSplit)) {
+        return false;
+    }
+
+    // Make room for the new child after the one that split
+    for (size_t i = parent->count; i > index; i--) {
+        parent->keys[i] = parent->keys[i - 1];
+        parent->children[i + 1] = parent->children[i];
+    }
+    parent->keys[index] = childSplit.separator;
+    parent->children[index + 1] = childSplit.right;
+    if (++parent->count <= CAPACITY) {
+        return false;
+    }
+
+    // Split in two around the middle key, which moves up
+    Inner* right = new Inner();
+    size_t middle = parent->count / 2;
+    right->count = parent->count - middle - 1;
+    for (size_t i = 0; i < right->count; i++) {
+        right->keys[i] = parent->keys[middle + 1 + i];
+        right->children[i] = parent->children[middle + 1 + i];
+    }
+    right->children[right->count] = parent->children[parent->count];
+    parent->count = middle;
+    split.right = right;
+    split.separator = parent->keys[middle];
+    return true;
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::insertIntoLeaf(Leaf* node, const Item& keyValuePair, Split& split) {
+    size_t index = NodeKeySearch<Key>::countLess(node->keys, node->count, keyValuePair.first);
+    if (index < node->count && !(keyValuePair.first < node->keys[index])) {
+        node->item(index).second = keyValuePair.second;
+        return false;
+    }
+
+    for (size_t i = node->count; i > index; i--) {
+        moveItem(node, i - 1, node, i);
+    }
+    new (&node->items[index]) Item(keyValuePair);
+    node->keys[index] = keyValuePair.first;
+    size_++;
+    if (++node->count <= CAPACITY) {
+        return false;
+    }
+
+    // Split in two, with the upper half in a new leaf after this one
+    Leaf* right = new Leaf();
+    size_t middle = node->count / 2;
+    right->count = node->count - middle;
+    for (size_t i = 0; i < right->count; i++) {
+        moveItem(node, middle + i, right, i);
+    }
+    node->count = middle;
+    right->next = node->next;
+    node->next = right;
+    split.right = right;
+    split.separator = right->keys[0];
+    return true;
+}
+
+template<class Key, class Value>
+void BPlusTree<Key, Value>::remove(const Key& key) {
+    if (root_ == nullptr || !removeAt(root_, key)) {
+        return;
+    }
+    // Shrink a level when the root is left with a single child, or drop an empty leaf root
+    if (!root_->leaf && root_->count == 0) {
+        Inner* root = inner(root_);
+        root_ = root->children[0];
+        delete root;
+    } else if (root_->leaf && root_->count == 0) {
+        delete leaf(root_);
+        root_ = nullptr;
+    }
+}
+
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::removeAt(Node* node, const Key& key) {
+    if (node->leaf) {
+        Leaf* items = leaf(node);
+        size_t index = NodeKeySearch<Key>::countLess(items->keys, items->count, key);
+        if (index == items->count || key < items->keys[index]) {
+            return false;
+        }
+        items->item(index).~Item();
+        for (size_t i = index + 1; i < items->count; i++) {
+            moveItem(items, i, items, i - 1);
+        }
+        items->count--;
+        size_--;
+        return true;
+    }
+
+    Inner* parent = inner(node);
+    size_t index = NodeKeySearch<Key>::countNotGreater(parent->keys, parent->count, key);
+    if (!removeAt(parent->children[index], key)) {
+        return false;
+    }
+    if (parent->children[index]->count < MIN_COUNT) {
+        fixChild(parent, index);
+    }
+    return true;
+}
+
+// Refills parent's child at index from a sibling with keys to spare, or else merges it with one
+template<class Key, class Value>
+void BPlusTree<Key, Value>::fixChild(Inner* parent, size_t index) {
+    Node* child = parent->children[index];
+    Node* left = index > 0 ? parent->children[index - 1] : nullptr;
+    Node* right = index < parent->count ? parent->children[index + 1] : nullptr;
+
+    if (left != nullptr && left->count > MIN_COUNT) {
+        // Take the last key of the left sibling
+        if (child->leaf) {
+            for (size_t i = child->count; i > 0; i--) {
+                moveItem(leaf(child), i - 1, leaf(child), i);
+            }
+            moveItem(leaf(left), left->count - 1, leaf(child), 0);
+            parent->keys[index - 1] = child->keys[0];
+        } else {
+            for (size_t i = child->count; i > 0; i--) {
+                child->keys[i] = child->keys[i - 1];
+            }
+            for (size_t i = child->count + 1; i > 0; i--) {
+                inner(child)->children[i] = inner(child)->children[i - 1];
+            }
+            child->keys[0] = parent->keys[index - 1];
+            inner(child)->children[0] = inner(left)->children[left->count];
+            parent->keys[index - 1] = left->keys[left->count - 1];
+        }
+        left->count--;
+        child->count++;
+    } else if (right != nullptr && right->count > MIN_COUNT) {
+        // Take the first key of the right sibling
+        if (child->leaf) {
+            moveItem(leaf(right), 0, leaf(child), child->count);
+            for (size_t i = 1; i < right->count; i++) {
+                moveItem(leaf(right), i, leaf(right), i - 1);
+            }
+            parent->keys[index] = right->keys[0];
+        } else {
+            child->keys[child->count] = parent->keys[index];
+            inner(child)->children[child->count + 1] = inner(right)->children[0];
+            parent->keys[index] = right->keys[0];
+            for (size_t i = 1; i < right->count; i++) {
+                right->keys[i - 1] = right->keys[i];
+            }
+            for (size_t i = 1; i <= right->count; i++) {
+                inner(right)->children[i - 1] = inner(right)->children[i];
+            }
+        }
+        right->count--;
+        child->count++;
+    } else if (left != nullptr) {
+        merge(parent, index - 1);
+    } else {
+        merge(parent, index);
+    }
+}
+
+// Merges parent's child at index + 1 into the one at index, and takes it and its separator out of parent
+template<class Key, class Value>
+void BPlusTree<Key, Value>::merge(Inner* parent, size_t index) {
+    Node* left = parent->children[index];
+    Node* right = parent->children[index + 1];
+    if (left->leaf) {
+        for (size_t i = 0; i < right->count; i++) {
+            moveItem(leaf(right), i, leaf(left), left->count + i);
+        }
+        left->count += right->count;
+        leaf(left)->next = leaf(right)->next;
+        delete leaf(right);
+    } else {
+        // The separator comes down between the two halves
+        left->keys[left->count] = parent->keys[index];
+        for (size_t i = 0; i < right->count; i++) {
+            left->keys[left->count + 1 + i] = right->keys[i];
+        }
+        for (size_t i = 0; i <= right->count; i++) {
+            inner(left)->children[left->count + 1 + i] = inner(right)->children[i];
+        }
+        left->count += right->count + 1;
+        delete inner(right);
+    }
+
+    for (size_t i = index + 1; i < parent->count; i++) {
+        parent->keys[i - 1] = parent->keys[i];
+        parent->children[i] = parent->children[i + 1];
+    }
+    parent->count--;
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::Leaf* BPlusTree<Key, Value>::lowerBoundLeaf(const Key& key, size_t& index) const {
+    if (root_ == nullptr) {
+        return nullptr;
+    }
+    Node* node = root_;
+    while (!node->leaf) {
+        node = inner(node)->children[NodeKeySearch<Key>::countNotGreater(node->keys, node->count, key)];
+    }
+    index = NodeKeySearch<Key>::countLess(node->keys, node->count, key);
+    return leaf(node);
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator BPlusTree<Key, Value>::begin() const {
+    if (root_ == nullptr) {
+        return end();
+    }
+    Node* node = root_;
+    while (!node->leaf) {
+        node = inner(node)->children[0];
+    }
+    return iterator(leaf(node), 0);
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator BPlusTree<Key, Value>::end() const {
+    return iterator();
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator BPlusTree<Key, Value>::find(const Key& key) const {
+    size_t index = 0;
+    Leaf* items = lowerBoundLeaf(key, index);
+    if (items == nullptr || index == items->count || key < items->keys[index]) {
+        return end();
+    }
+    return iterator(items, index);
+}
+
+template<class Key, class Value>
+typename BPlusTree<Key, Value>::iterator BPlusTree<Key, Value>::lowerBound(const Key& key) const {
+    size_t index = 0;
+    Leaf* items = lowerBoundLeaf(key, index);
+    if (items == nullptr) {
+        return end();
+    } else if (index == items->count) {
+        // Every key in this leaf is smaller, so the bound is the first item of the next one
+        return iterator(items->next, 0);
+    }
+    return iterator(items, index);
+}
+
+template<class Key, class Value>
+template<class Visit>
+void BPlusTree<Key, Value>::forEachInRange(const Key& lo, const Key& hi, Visit visit) const {
+    size_t index = 0;
+    for (Leaf* items = lowerBoundLeaf(lo, index); items != nullptr; items = items->next, index = 0) {
+        for (; index < items->count; index++) {
+            if (!(items->keys[index] < hi)) {
+                return;
+            }
+            visit(items->item(index));
+        }
+    }
+}
+
+template<class Key, class Value>
+int BPlusTree<Key, Value>::checkedDepth(const Node* node, const Key* lo, const Key* hi, bool root) {
+    if (node->count > CAPACITY || (!root && node->count < MIN_COUNT)) {
+        return -1;
+    }
+    for (size_t i = 0; i < node->count; i++) {
+        if ((i > 0 && !(node->keys[i - 1] < node->keys[i])) || (lo != nullptr && node->keys[i] < *lo)
+            || (hi != nullptr && !(node->keys[i] < *hi))) {
+            return -1;
+        }
+    }
+    if (node->leaf) {
+        return 0;
+    }
+
+    const Inner* parent = static_cast<const Inner*>(node);
+    int depth = -1;
+    for (size_t i = 0; i <= node->count; i++) {
+        const Key* childLo = i == 0 ? lo : &node->keys[i - 1];
+        const Key* childHi = i == node->count ? hi : &node->keys[i];
+        int childDepth = checkedDepth(parent->children[i], childLo, childHi, false);
+        if (childDepth < 0 || (depth >= 0 && childDepth != depth)) {
+            return -1;
+        }
+        depth = childDepth;
+    }
+    return depth + 1;
+}
+
+// Checks the B+-tree invariants: sorted keys within the separators' bounds, node sizes and equal leaf depths
+template<class Key, class Value>
+bool BPlusTree<Key, Value>::isBalanced() const {
+    return root_ == nullptr || checkedDepth(root_, nullptr, nullptr, true) >= 0;
+}
+
+#endif
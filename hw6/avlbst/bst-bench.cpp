@@ -0,0 +1,781 @@
+#include "augmented_avl.h"
+#include "avlbst.h"
+#include "bplus_tree.h"
+#include "bst.h"
+#include "concurrent_avl.h"
+#include "persistent_avl.h"
+#include "pooled_avl.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Every allocation goes through here so the benchmarks can report the memory each tree uses
+static atomic<size_t> allocatedBytes(0);
+
+// The operators are kept out of line: GCC flags malloc or free inlined into a caller as mismatched with the other
+__attribute__((noinline)) void* operator new(size_t size) {
+    allocatedBytes += size;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// Prints one line of results: nanoseconds per operation for each phase
+static void report(const string& name, size_t n, double insert, double find, double scan, double remove, size_t bytes) {
+    cout << setw(14) << left << name << right << setw(10) << n << fixed << setprecision(1) << setw(10)
+         << insert * 1e9 / n << setw(10) << find * 1e9 / n << setw(10) << scan * 1e9 / n << setw(10)
+         << remove * 1e9 / (n / 2) << setw(10) << static_cast<double>(bytes) / n << endl;
+}
+
+// Inserts keys, finds each, scans in order and removes every other key, with tree's own interface
+template<class Tree>
+static void runTree(const string& name, const vector<int>& keys) {
+    size_t before = allocatedBytes;
+    Tree* tree = new Tree();
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int key : keys) {
+        tree->insert(make_pair(key, key));
+    }
+    double insert = secondsSince(start);
+    size_t bytes = allocatedBytes - before;
+
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (int key : keys) {
+        sum += tree->find(key)->second;
+    }
+    double find = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    for (typename Tree::iterator it = tree->begin(); it != tree->end(); ++it) {
+        sum -= it->second;
+    }
+    double scan = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    for (size_t i = 0; i < keys.size(); i += 2) {
+        tree->remove(keys[i]);
+    }
+    double remove = secondsSince(start);
+
+    if (sum != 0) {
+        cout << name << ": wrong sum" << endl;
+    }
+    delete tree;
+    report(name, keys.size(), insert, find, scan, remove, bytes);
+}
+
+// std::map with the tree interface, for the same loop
+template<class Key, class Value>
+struct StdMap : std::map<Key, Value> {
+    void remove(const Key& key) { this->erase(key); }
+};
+
+// PooledAVLTree against AVLTree and std::map, with random keys
+static void pooled() {
+    cout << "pooled: ns per insert, find, scan step and remove; bytes per key after inserting" << endl;
+    cout << setw(14) << left << "tree" << right << setw(10) << "keys" << setw(10) << "insert" << setw(10) << "find"
+         << setw(10) << "scan" << setw(10) << "remove" << setw(10) << "bytes" << endl;
+    for (size_t n = 1000; n <= 1000000; n *= 10) {
+        vector<int> keys(n);
+        iota(keys.begin(), keys.end(), 0);
+        shuffle(keys.begin(), keys.end(), mt19937(1));
+        runTree<AVLTree<int, int>>("AVLTree", keys);
+        runTree<PooledAVLTree<int, int>>("PooledAVLTree", keys);
+        runTree<StdMap<int, int>>("std::map", keys);
+    }
+}
+
+// BPlusTree against AVLTree, with random keys. AVLTree stops at 1e7 keys: it takes about 90 bytes a key, so 1e8
+// would need 9 GB.
+static void btree() {
+    cout << "btree: ns per insert, find, scan step and remove; bytes per key after inserting" << endl;
+    cout << setw(14) << left << "tree" << right << setw(10) << "keys" << setw(10) << "insert" << setw(10) << "find"
+         << setw(10) << "scan" << setw(10) << "remove" << setw(10) << "bytes" << endl;
+    for (size_t n = 1000; n <= 100000000; n *= 10) {
+        vector<int> keys(n);
+        iota(keys.begin(), keys.end(), 0);
+        shuffle(keys.begin(), keys.end(), mt19937(1));
+        if (n <= 10000000) {
+            runTree<AVLTree<int, int>>("AVLTree", keys);
+        }
+        runTree<BPlusTree<int, int>>("BPlusTree", keys);
+    }
+}
+
+// Sorted keys 0, 2, 4, ... as key/value pairs
+static vector<pair<int, int>> evenKeys(size_t n) {
+    vector<pair<int, int>> keys(n);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = make_pair(static_cast<int>(2 * i), static_cast<int>(i));
+    }
+    return keys;
+}
+
+// AVLTree::buildSorted and mergeSorted against inserting the same sorted keys one at a time
+static void bulk() {
+    cout << "bulk: ms to build from n sorted keys, then to add a sorted batch of n / 10 and of n new keys" << endl;
+    cout << setw(10) << "keys" << setw(12) << "insert" << setw(12) << "build" << setw(12) << "insert 10%"
+         << setw(12) << "merge 10%" << setw(12) << "insert 100%" << setw(12) << "merge 100%" << endl;
+    for (size_t n = 1000; n <= 1000000; n *= 10) {
+        vector<pair<int, int>> keys = evenKeys(n);
+        vector<pair<int, int>> small(n / 10);
+        vector<pair<int, int>> large(n);
+        for (size_t i = 0; i < n; i++) {
+            large[i] = make_pair(static_cast<int>(2 * i + 1), 0);
+        }
+        for (size_t i = 0; i < small.size(); i++) {
+            small[i] = large[i * 10];
+        }
+
+        double times[6];
+        for (int merge = 0; merge < 2; merge++) {
+            const vector<pair<int, int>>* batches[] = {&small, &large};
+            for (int b = 0; b < 2; b++) {
+                AVLTree<int, int> tree;
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                if (merge) {
+                    tree.buildSorted(keys.begin(), keys.end());
+                } else {
+                    for (const pair<int, int>& key : keys) {
+                        tree.insert(key);
+                    }
+                }
+                times[merge] = secondsSince(start);
+
+                start = chrono::steady_clock::now();
+                if (merge) {
+                    tree.mergeSorted(batches[b]->begin(), batches[b]->end());
+                } else {
+                    for (const pair<int, int>& key : *batches[b]) {
+                        tree.insert(key);
+                    }
+                }
+                times[2 + 2 * b + merge] = secondsSince(start);
+                if (!tree.isBalanced()) {
+                    cout << "unbalanced tree" << endl;
+                }
+            }
+        }
+        cout << setw(10) << n << fixed << setprecision(2);
+        for (double time : times) {
+            cout << setw(12) << time * 1000;
+        }
+        cout << endl;
+    }
+}
+
+// AugmentedAVLTree's select, rank and range sum against walking an AVLTree with its iterator
+static void augmented() {
+    cout << "augmented: ns per insert, and per select, rank and range sum over a random quarter of the keys" << endl;
+    cout << setw(18) << left << "tree" << right << setw(10) << "keys" << setw(10) << "insert" << setw(12) << "select"
+         << setw(12) << "rank" << setw(12) << "sum" << endl;
+    const int queries = 20;
+    for (size_t n = 1000; n <= 1000000; n *= 10) {
+        vector<int> keys(n);
+        iota(keys.begin(), keys.end(), 0);
+        shuffle(keys.begin(), keys.end(), mt19937(1));
+        long long check = 0;
+
+        AVLTree<int, int> plain;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int key : keys) {
+            plain.insert(make_pair(key, key));
+        }
+        double insert = secondsSince(start);
+        double times[3];
+        for (int query = 0; query < 3; query++) {
+            start = chrono::steady_clock::now();
+            for (int i = 0; i < queries; i++) {
+                int lo = keys[i];
+                int hi = lo + static_cast<int>(n / 4);
+                size_t index = 0;
+                for (AVLTree<int, int>::iterator it = plain.begin(); it != plain.end(); ++it, ++index) {
+                    if (query == 0 && index == static_cast<size_t>(lo)) {
+                        check += (*it).first;
+                        break;
+                    } else if (query == 1 && (*it).first >= lo) {
+                        check += index;
+                        break;
+                    } else if (query == 2 && (*it).first >= lo && (*it).first < hi) {
+                        check += (*it).second;
+                    }
+                }
+            }
+            times[query] = secondsSince(start);
+        }
+        cout << setw(18) << left << "AVLTree walk" << right << setw(10) << n << fixed << setprecision(1) << setw(10)
+             << insert * 1e9 / n << setw(12) << times[0] * 1e9 / queries << setw(12) << times[1] * 1e9 / queries
+             << setw(12) << times[2] * 1e9 / queries << endl;
+
+        AugmentedAVLTree<int, int, SumAggregate<int, long long>> tree;
+        start = chrono::steady_clock::now();
+        for (int key : keys) {
+            tree.insert(make_pair(key, key));
+        }
+        insert = secondsSince(start);
+        for (int query = 0; query < 3; query++) {
+            start = chrono::steady_clock::now();
+            for (int i = 0; i < queries; i++) {
+                int lo = keys[i];
+                if (query == 0) {
+                    check -= (*tree.select(lo)).first;
+                } else if (query == 1) {
+                    check -= tree.rank(lo);
+                } else {
+                    check -= tree.aggregate(lo, lo + static_cast<int>(n / 4));
+                }
+            }
+            times[query] = secondsSince(start);
+        }
+        cout << setw(18) << left << "AugmentedAVLTree" << right << setw(10) << n << fixed << setprecision(1)
+             << setw(10) << insert * 1e9 / n << setw(12) << times[0] * 1e9 / queries << setw(12)
+             << times[1] * 1e9 / queries << setw(12) << times[2] * 1e9 / queries << endl;
+        if (check != 0) {
+            cout << "augmented: results differ" << endl;
+        }
+    }
+}
+
+// forEachInRange against walking the whole tree from begin() and filtering, for ranges of a few widths
+static void range() {
+    const size_t n = 1000000;
+    cout << "range: us per scan of [lo, lo + width) in an AVLTree of " << n << " keys" << endl;
+    cout << setw(10) << "width" << setw(14) << "walk" << setw(14) << "scan" << endl;
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), mt19937(1));
+    AVLTree<int, int> tree;
+    for (int key : keys) {
+        tree.insert(make_pair(key, key));
+    }
+
+    for (int width = 10; width <= 100000; width *= 100) {
+        const int walks = 5;
+        const int scans = 1000;
+        long long check = 0;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int i = 0; i < walks; i++) {
+            for (AVLTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it) {
+                if ((*it).first >= keys[i] && (*it).first < keys[i] + width) {
+                    check += (*it).second;
+                }
+            }
+        }
+        double walk = secondsSince(start) / walks;
+
+        start = chrono::steady_clock::now();
+        for (int i = 0; i < scans; i++) {
+            long long sum = 0;
+            tree.forEachInRange(keys[i], keys[i] + width, [&sum](pair<const int, int>& item) { sum += item.second; });
+            if (i < walks) {
+                check -= sum;
+            }
+        }
+        double scan = secondsSince(start) / scans;
+        if (check != 0) {
+            cout << "range: results differ" << endl;
+        }
+        cout << setw(10) << width << fixed << setprecision(1) << setw(14) << walk * 1e6 << setw(14) << scan * 1e6
+             << endl;
+    }
+}
+
+// AVLTree behind one mutex, with the ConcurrentAVLTree interface
+struct LockedAVLTree {
+    AVLTree<int, int> tree;
+    mutex lock;
+
+    void insert(const pair<const int, int>& item) {
+        lock_guard<mutex> guard(lock);
+        tree.insert(item);
+    }
+
+    void remove(int key) {
+        lock_guard<mutex> guard(lock);
+        tree.remove(key);
+    }
+
+    struct Reader {
+        explicit Reader(LockedAVLTree& tree) : tree(tree) {}
+
+        bool find(int key, int& value) {
+            lock_guard<mutex> guard(tree.lock);
+            AVLTree<int, int>::iterator it = tree.tree.find(key);
+            if (it == tree.tree.end()) {
+                return false;
+            }
+            value = (*it).second;
+            return true;
+        }
+
+        LockedAVLTree& tree;
+    };
+};
+
+// Runs readers finding random keys in tree for a while, with one writer replacing random keys all along
+template<class Tree>
+static void runReaders(const string& name, Tree& tree, size_t n, int readers) {
+    const chrono::milliseconds duration(300);
+    atomic<bool> stop(false);
+    vector<long long> finds(readers);
+    long long updates = 0;
+
+    vector<thread> threads;
+    for (int i = 0; i < readers; i++) {
+        threads.emplace_back([&tree, &stop, &finds, n, i]() {
+            typename Tree::Reader reader(tree);
+            mt19937 random(i);
+            long long count = 0;
+            int value = 0;
+            while (!stop.load(memory_order_relaxed)) {
+                for (int j = 0; j < 256; j++) {
+                    count += reader.find(static_cast<int>(random() % n), value);
+                }
+            }
+            finds[i] = count;
+        });
+    }
+    threads.emplace_back([&tree, &stop, &updates, n, readers]() {
+        mt19937 random(readers + 1);
+        while (!stop.load(memory_order_relaxed)) {
+            int key = static_cast<int>(random() % n);
+            tree.remove(key);
+            tree.insert(make_pair(key, key));
+            updates += 2;
+        }
+    });
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    this_thread::sleep_for(duration);
+    stop.store(true);
+    for (thread& t : threads) {
+        t.join();
+    }
+    double seconds = secondsSince(start);
+
+    long long total = 0;
+    for (long long count : finds) {
+        total += count;
+    }
+    cout << setw(20) << left << name << right << setw(10) << readers << fixed << setprecision(2) << setw(14)
+         << total / seconds / 1e6 << setw(14) << total / seconds / 1e6 / readers << setw(14)
+         << updates / seconds / 1e3 << endl;
+}
+
+// ConcurrentAVLTree's lock-free readers against readers of an AVLTree behind a mutex, while one thread updates
+static void concurrent() {
+    const size_t n = 1000000;
+    cout << "concurrent: millions of finds per second in all and per reader, thousands of updates per second, with "
+         << n << " keys and " << thread::hardware_concurrency() << " hardware threads" << endl;
+    cout << setw(20) << left << "tree" << right << setw(10) << "readers" << setw(14) << "finds" << setw(14)
+         << "per reader" << setw(14) << "updates" << endl;
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), mt19937(1));
+    ConcurrentAVLTree<int, int> concurrentTree;
+    LockedAVLTree lockedTree;
+    for (int key : keys) {
+        concurrentTree.insert(make_pair(key, key));
+        lockedTree.insert(make_pair(key, key));
+    }
+
+    for (int readers = 1; readers <= 8; readers *= 2) {
+        runReaders("ConcurrentAVLTree", concurrentTree, n, readers);
+        runReaders("AVLTree + mutex", lockedTree, n, readers);
+    }
+}
+
+// PersistentAVLTree updates that keep every old version, and snapshots against copying a std::map
+static void persistent() {
+    cout << "persistent: ns per insert and find, bytes per update with all versions kept, ns per snapshot, and us"
+         << " per std::map copy" << endl;
+    cout << setw(10) << "keys" << setw(10) << "insert" << setw(10) << "find" << setw(10) << "bytes" << setw(10)
+         << "snapshot" << setw(12) << "map copy" << endl;
+    for (size_t n = 1000; n <= 1000000; n *= 10) {
+        vector<int> keys(n);
+        iota(keys.begin(), keys.end(), 0);
+        shuffle(keys.begin(), keys.end(), mt19937(1));
+
+        PersistentAVLTree<int, int> tree;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (int key : keys) {
+            tree = tree.insert(make_pair(key, key));
+        }
+        double insert = secondsSince(start);
+
+        long long sum = 0;
+        start = chrono::steady_clock::now();
+        for (int key : keys) {
+            sum += tree.find(key)->second;
+        }
+        double find = secondsSince(start);
+
+        // Replace values, keeping each version
+        const size_t updates = 10000;
+        vector<PersistentAVLTree<int, int>> versions;
+        versions.reserve(updates);
+        size_t before = allocatedBytes;
+        for (size_t i = 0; i < updates; i++) {
+            versions.push_back(versions.empty() ? tree : versions.back());
+            versions.back() = versions.back().insert(make_pair(keys[i % n], -keys[i % n]));
+        }
+        double bytes = static_cast<double>(allocatedBytes - before - updates * sizeof(tree)) / updates;
+        if (!versions.back().isBalanced() || versions.front().size() != n) {
+            cout << "persistent: bad version" << endl;
+        }
+
+        start = chrono::steady_clock::now();
+        for (size_t i = 0; i < updates; i++) {
+            PersistentAVLTree<int, int> snapshot = versions[i];
+            sum -= snapshot.size();
+        }
+        double snapshot = secondsSince(start);
+
+        map<int, int> copied;
+        for (int key : keys) {
+            copied[key] = key;
+        }
+        start = chrono::steady_clock::now();
+        map<int, int> copy = copied;
+        double mapCopy = secondsSince(start);
+        sum += copy.size() * updates;
+
+        if (sum != static_cast<long long>(n) * (static_cast<long long>(n) - 1) / 2) {
+            cout << "persistent: wrong sum" << endl;
+        }
+        cout << setw(10) << n << fixed << setprecision(1) << setw(10) << insert * 1e9 / n << setw(10)
+             << find * 1e9 / n << setw(10) << bytes << setw(10) << snapshot * 1e9 / updates << setw(12)
+             << mapCopy * 1e6 << endl;
+    }
+}
+
+// A BinarySearchTree that can be built as sorted inserts would build it, a chain of right children, without walking
+// the whole chain for every key
+struct SortedChain : BinarySearchTree<int, int> {
+    void build(size_t n) {
+        clear();
+        shared_ptr<Node<int, int>> last;
+        for (size_t i = 0; i < n; i++) {
+            shared_ptr<Node<int, int>> node = make_shared<Node<int, int>>(static_cast<int>(i), 0, last);
+            if (last == nullptr) {
+                root_ = node;
+            } else {
+                last->setRight(node);
+            }
+            last = node;
+        }
+    }
+};
+
+// Checks, walks, searches and tears down tree, which holds the keys 0 to n - 1, and prints a line of results
+template<class Tree>
+static void runDegenerate(const string& name, Tree& tree, size_t n, double insert) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    bool balanced = tree.isBalanced();
+    double check = secondsSince(start);
+
+    long long sum = 0;
+    start = chrono::steady_clock::now();
+    for (typename Tree::iterator it = tree.begin(); it != tree.end(); ++it) {
+        sum += (*it).first;
+    }
+    double walk = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    bool found = tree.find(static_cast<int>(n - 1)) != tree.end();
+    double find = secondsSince(start);
+
+    start = chrono::steady_clock::now();
+    tree.clear();
+    double clear = secondsSince(start);
+
+    if (sum != static_cast<long long>(n) * (static_cast<long long>(n) - 1) / 2 || !found) {
+        cout << name << ": wrong contents" << endl;
+    }
+    cout << setw(20) << left << name << right << setw(10) << n << fixed << setprecision(1);
+    if (insert < 0) {
+        cout << setw(10) << "-";
+    } else {
+        cout << setw(10) << insert * 1e9 / n;
+    }
+    cout << setw(10) << check * 1e9 / n << setw(10) << (balanced ? "yes" : "no") << setw(10) << walk * 1e9 / n
+         << setw(12) << find * 1e6 << setw(10) << clear * 1e9 / n << endl;
+}
+
+// Sorted inserts into BinarySearchTree, which make a chain as deep as the tree is big, next to the same keys in an
+// AVLTree. Chains past 1e4 keys are linked directly, since inserting would take n * n / 2 steps.
+static void degenerate() {
+    cout << "degenerate: ns per key to insert in order, check balance, walk and clear; us to find the last key"
+         << endl;
+    cout << setw(20) << left << "tree" << right << setw(10) << "keys" << setw(10) << "insert" << setw(10) << "check"
+         << setw(10) << "balanced" << setw(10) << "walk" << setw(12) << "find" << setw(10) << "clear" << endl;
+    for (size_t n = 1000; n <= 1000000; n *= 10) {
+        SortedChain chain;
+        double insert = -1;
+        if (n <= 10000) {
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            for (size_t i = 0; i < n; i++) {
+                chain.insert(make_pair(static_cast<int>(i), 0));
+            }
+            insert = secondsSince(start);
+        } else {
+            chain.build(n);
+        }
+        runDegenerate("BinarySearchTree", chain, n, insert);
+
+        AVLTree<int, int> tree;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (size_t i = 0; i < n; i++) {
+            tree.insert(make_pair(static_cast<int>(i), 0));
+        }
+        runDegenerate("AVLTree", tree, n, secondsSince(start));
+    }
+}
+
+// AVLTree's insertBatch, removeBatch and findBatch on one and on four threads against a loop of single calls, for
+// batches of random keys in a tree of 1e6 keys
+static void batch() {
+    cout << "batch: ms to insert, remove and find a batch of random keys in a tree of 1e6, key by key and as a batch"
+         << " on 1 and 4 threads" << endl;
+    cout << setw(10) << "batch";
+    const char* operations[] = {"insert", "remove", "find"};
+    for (const char* operation : operations) {
+        cout << setw(10) << operation << setw(10) << "batch" << setw(10) << "batch x4";
+    }
+    cout << endl;
+
+    const size_t n = 1000000;
+    vector<pair<int, int>> keys = evenKeys(n);
+    mt19937 rng(42);
+    const size_t sizes[] = {1000, 10000, 100000, 250000, 500000, 1000000};
+    for (size_t size : sizes) {
+        // New odd keys to insert, existing even keys to remove, and half and half to find
+        vector<pair<int, int>> added(size);
+        vector<int> removed(size);
+        vector<int> found(size);
+        for (size_t i = 0; i < size; i++) {
+            added[i] = make_pair(static_cast<int>(2 * (rng() % n) + 1), static_cast<int>(i));
+            removed[i] = static_cast<int>(2 * (rng() % n));
+            found[i] = static_cast<int>(rng() % (2 * n));
+        }
+
+        double times[9];
+        size_t hits[3] = {0, 0, 0};
+        for (int operation = 0; operation < 3; operation++) {
+            for (int mode = 0; mode < 3; mode++) {
+                AVLTree<int, int> tree;
+                tree.buildSorted(keys.begin(), keys.end());
+                unsigned threads = mode == 2 ? 4 : 1;
+                chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                if (operation == 0 && mode == 0) {
+                    for (const pair<int, int>& key : added) {
+                        tree.insert(key);
+                    }
+                } else if (operation == 0) {
+                    tree.insertBatch(added.begin(), added.end(), threads);
+                } else if (operation == 1 && mode == 0) {
+                    for (int key : removed) {
+                        tree.remove(key);
+                    }
+                } else if (operation == 1) {
+                    tree.removeBatch(removed.begin(), removed.end(), threads);
+                } else if (mode == 0) {
+                    for (int key : found) {
+                        hits[mode] += tree.find(key) != tree.end();
+                    }
+                } else {
+                    for (const AVLTree<int, int>::iterator& it : tree.findBatch(found.begin(), found.end(), threads)) {
+                        hits[mode] += it != tree.end();
+                    }
+                }
+                times[3 * operation + mode] = secondsSince(start);
+                if (!tree.isBalanced()) {
+                    cout << "unbalanced tree" << endl;
+                }
+            }
+        }
+        if (hits[1] != hits[0] || hits[2] != hits[0]) {
+            cout << "batch find disagrees with find" << endl;
+        }
+        cout << setw(10) << size << fixed << setprecision(2);
+        for (double time : times) {
+            cout << setw(10) << time * 1000;
+        }
+        cout << endl;
+    }
+}
+
+// Random distinct keys from [0, 2n), as sorted key/value pairs
+static vector<pair<int, int>> randomKeys(size_t n, mt19937& rng) {
+    vector<int> keys(2 * n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), rng);
+    keys.resize(n);
+    sort(keys.begin(), keys.end());
+    vector<pair<int, int>> items(n);
+    for (size_t i = 0; i < n; i++) {
+        items[i] = make_pair(keys[i], static_cast<int>(i));
+    }
+    return items;
+}
+
+// AVLTree's split and join against rebuilding both halves from an in-order walk, and its set operations on one and
+// four threads against doing the same with insertBatch and removeBatch
+static void splitJoin() {
+    cout << "split: us per split at a random key, per join back and per rebuild of both halves" << endl;
+    cout << setw(10) << "keys" << setw(10) << "split" << setw(10) << "join" << setw(12) << "rebuild" << endl;
+    mt19937 rng(42);
+    for (size_t n = 10000; n <= 1000000; n *= 10) {
+        vector<pair<int, int>> keys = evenKeys(n);
+        AVLTree<int, int> tree;
+        tree.buildSorted(keys.begin(), keys.end());
+        AVLTree<int, int> right;
+        const int rounds = 1000;
+        double split = 0;
+        double join = 0;
+        for (int i = 0; i < rounds; i++) {
+            int key = static_cast<int>(rng() % (2 * n));
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            tree.split(key, right);
+            split += secondsSince(start);
+            start = chrono::steady_clock::now();
+            tree.join(tree, right);
+            join += secondsSince(start);
+        }
+        if (!tree.isBalanced()) {
+            cout << "unbalanced tree" << endl;
+        }
+
+        int key = static_cast<int>(rng() % (2 * n));
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        vector<pair<int, int>> below;
+        vector<pair<int, int>> above;
+        for (AVLTree<int, int>::iterator it = tree.begin(); it != tree.end(); ++it) {
+            (it->first < key ? below : above).push_back(*it);
+        }
+        AVLTree<int, int> left;
+        left.buildSorted(below.begin(), below.end());
+        right.buildSorted(above.begin(), above.end());
+        double rebuild = secondsSince(start);
+        cout << setw(10) << n << fixed << setprecision(2) << setw(10) << split / rounds * 1e6 << setw(10)
+             << join / rounds * 1e6 << setw(12) << rebuild * 1e6 << endl;
+    }
+
+    cout << "split: ms for set operations on two trees of n random keys from [0, 2n), on 1 and 4 threads, and for"
+         << " union and difference by walking one tree into insertBatch or removeBatch" << endl;
+    cout << setw(10) << "keys" << setw(10) << "union" << setw(10) << "x4" << setw(10) << "intersect" << setw(10)
+         << "x4" << setw(10) << "subtract" << setw(10) << "x4" << setw(10) << "insert" << setw(10) << "remove" << endl;
+    for (size_t n = 10000; n <= 1000000; n *= 10) {
+        vector<pair<int, int>> aKeys = randomKeys(n, rng);
+        vector<pair<int, int>> bKeys = randomKeys(n, rng);
+        double times[8];
+        size_t sizes[8];
+        for (int run = 0; run < 8; run++) {
+            AVLTree<int, int> a;
+            AVLTree<int, int> b;
+            a.buildSorted(aKeys.begin(), aKeys.end());
+            b.buildSorted(bKeys.begin(), bKeys.end());
+            unsigned threads = run % 2 == 1 ? 4 : 1;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            if (run < 2) {
+                a.unionWith(b, threads);
+            } else if (run < 4) {
+                a.intersectWith(b, threads);
+            } else if (run < 6) {
+                a.subtract(b, threads);
+            } else {
+                vector<pair<int, int>> items;
+                for (AVLTree<int, int>::iterator it = b.begin(); it != b.end(); ++it) {
+                    items.push_back(*it);
+                }
+                if (run == 6) {
+                    a.insertBatch(items.begin(), items.end());
+                } else {
+                    vector<int> removed;
+                    for (const pair<int, int>& item : items) {
+                        removed.push_back(item.first);
+                    }
+                    a.removeBatch(removed.begin(), removed.end());
+                }
+            }
+            times[run] = secondsSince(start);
+            sizes[run] = 0;
+            for (AVLTree<int, int>::iterator it = a.begin(); it != a.end(); ++it) {
+                sizes[run]++;
+            }
+            if (!a.isBalanced()) {
+                cout << "unbalanced tree" << endl;
+            }
+        }
+        if (sizes[1] != sizes[0] || sizes[6] != sizes[0] || sizes[3] != sizes[2] || sizes[5] != sizes[4]
+            || sizes[7] != sizes[4]) {
+            cout << "set operations disagree" << endl;
+        }
+        cout << setw(10) << n << fixed << setprecision(2);
+        for (double time : times) {
+            cout << setw(10) << time * 1000;
+        }
+        cout << endl;
+    }
+}
+
+// Runs the benchmarks named on the command line, or all of them
+int main(int argc, char* argv[]) {
+    struct Benchmark {
+        const char* name;
+        void (*run)();
+    };
+    const Benchmark benchmarks[] = {
+            {"pooled", pooled},
+            {"bulk", bulk},
+            {"augmented", augmented},
+            {"range", range},
+            {"concurrent", concurrent},
+            {"persistent", persistent},
+            {"btree", btree},
+            {"degenerate", degenerate},
+            {"batch", batch},
+            {"split", splitJoin},
+    };
+    for (const Benchmark& benchmark : benchmarks) {
+        bool selected = argc == 1;
+        for (int i = 1; i < argc; i++) {
+            selected = selected || string(argv[i]) == benchmark.name;
+        }
+        if (selected) {
+            benchmark.run();
+            cout << endl;
+        }
+    }
+    return 0;
+}
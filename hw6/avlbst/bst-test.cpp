@@ -1,10 +1,900 @@
+#include "augmented_avl.h"
 #include "avlbst.h"
+#include "bplus_tree.h"
 #include "bst.h"
+#include "concurrent_avl.h"
+#include "persistent_avl.h"
+#include "pooled_avl.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 using namespace std;
 
+static int failures = 0;
+
+static void check(bool ok, const string& what) {
+    if (!ok) {
+        cout << "FAILED: " << what << endl;
+        failures++;
+    }
+}
+
+// One writer rewrites every even key with the number of the round, while readers look keys up without locking. Each
+// value a reader sees must be the one from before its lookup or one written during it: the round that had finished
+// when the lookup started, or a later one that had started when it ended. Odd keys come and go and may be missing.
+static void testConcurrentReaders() {
+    const int KEYS = 2000;
+    const int ROUNDS = 40;
+    const size_t READERS = 4;
+
+    ConcurrentAVLTree<int, int> tree;
+    for (int key = 0; key < KEYS; key += 2) {
+        tree.insert(make_pair(key, 0));
+    }
+    atomic<int> started(0);
+    atomic<int> finished(0);
+    atomic<bool> done(false);
+    atomic<int> stale(0);
+    atomic<int> missing(0);
+    atomic<int> lookups(0);
+
+    vector<thread> readers;
+    for (size_t i = 0; i < READERS; i++) {
+        readers.push_back(thread([&, i]() {
+            ConcurrentAVLTree<int, int>::Reader reader(tree);
+            mt19937 random(i);
+            while (!done.load()) {
+                int key = random() % KEYS;
+                int oldest = finished.load();
+                int value = -1;
+                bool found = reader.find(key, value);
+                int newest = started.load();
+                lookups++;
+                if (key % 2 == 0 && !found) {
+                    missing++;
+                } else if (found && (value < oldest || value > newest)) {
+                    stale++;
+                }
+            }
+        }));
+    }
+
+    mt19937 random(42);
+    for (int round = 1; round <= ROUNDS; round++) {
+        started.store(round);
+        for (int key = 0; key < KEYS; key++) {
+            if (key % 2 == 0) {
+                tree.insert(make_pair(key, round));
+            } else if (random() % 2) {
+                tree.insert(make_pair(key, round));
+            } else {
+                tree.remove(key);
+            }
+        }
+        finished.store(round);
+    }
+    done.store(true);
+    for (thread& reader : readers) {
+        reader.join();
+    }
+
+    check(lookups.load() > 0, "concurrent readers ran");
+    check(missing.load() == 0, "concurrent readers found every even key");
+    check(stale.load() == 0, "concurrent readers saw the old or the new value");
+    ConcurrentAVLTree<int, int>::Reader reader(tree);
+    for (int key = 0; key < KEYS; key += 2) {
+        int value = -1;
+        check(reader.find(key, value) && value == ROUNDS, "every even key has the last round's value");
+    }
+}
+
+// An augmented tree, so the checks cover the subtree sizes and sums that split and join have to keep up to date
+class CheckedTree : public AugmentedAVLTree<int, int, SumAggregate<int, int>> {
+public:
+    // Whether every node's parent pointer and stored balance match the tree as linked
+    bool linksValid() const {
+        bool valid = true;
+        subtreeHeight(this->root_, nullptr, valid);
+        return valid;
+    }
+
+private:
+    static int subtreeHeight(shared_ptr<Node<int, int>> node, Node<int, int>* parent, bool& valid) {
+        if (node == nullptr) {
+            return 0;
+        }
+        if (node->getParent().get() != parent) {
+            valid = false;
+        }
+        int left = subtreeHeight(node->getLeft(), node.get(), valid);
+        int right = subtreeHeight(node->getRight(), node.get(), valid);
+        if (static_pointer_cast<AVLNode<int, int>>(node)->getBalance() != right - left) {
+            valid = false;
+        }
+        return 1 + max(left, right);
+    }
+};
+
+// Compares tree with expected: contents in order, links, balance, and the augmented size, sum and order statistics
+static void checkTree(const CheckedTree& tree, const map<int, int>& expected, const string& what) {
+    bool same = true;
+    CheckedTree::iterator it = tree.begin();
+    for (map<int, int>::const_iterator item = expected.begin(); item != expected.end(); ++item, ++it) {
+        if (it == tree.end() || it->first != item->first || it->second != item->second) {
+            same = false;
+            break;
+        }
+    }
+    long sum = 0;
+    for (map<int, int>::const_iterator item = expected.begin(); item != expected.end(); ++item) {
+        sum += item->second;
+    }
+    check(same && it == tree.end(), what + ": contents match std::map");
+    check(tree.isBalanced() && tree.linksValid(), what + ": parents and balance factors are right");
+    check(tree.size() == expected.size() && tree.aggregate() == sum, what + ": augmented size and sum are right");
+    if (!expected.empty()) {
+        check(tree.select(0)->first == expected.begin()->first
+                      && tree.rank(expected.rbegin()->first) == expected.size() - 1,
+              what + ": select and rank agree with the sizes");
+    }
+
+    // Random positions and ranges, including keys past either end and lo >= hi, against the keys in order and their
+    // running sums: rank(key) is the number of keys below key, and [lo, hi) holds the keys from rank(lo) to rank(hi)
+    const int PROBES = 20;
+    vector<int> keys;
+    vector<long> sums(1, 0);
+    for (map<int, int>::const_iterator item = expected.begin(); item != expected.end(); ++item) {
+        keys.push_back(item->first);
+        sums.push_back(sums.back() + item->second);
+    }
+    int first = keys.empty() ? 0 : keys.front() - 2;
+    int span = keys.empty() ? 4 : keys.back() - keys.front() + 5;
+    mt19937 random(static_cast<unsigned>(keys.size()));
+    bool selects = tree.select(keys.size()) == tree.end();
+    bool ranges = true;
+    for (int probe = 0; probe < PROBES; probe++) {
+        if (!keys.empty()) {
+            size_t k = random() % keys.size();
+            selects = selects && tree.select(k) != tree.end() && tree.select(k)->first == keys[k];
+        }
+        int lo = first + static_cast<int>(random() % span);
+        int hi = first + static_cast<int>(random() % span);
+        size_t below = lower_bound(keys.begin(), keys.end(), lo) - keys.begin();
+        size_t end = max(below, static_cast<size_t>(lower_bound(keys.begin(), keys.end(), hi) - keys.begin()));
+        ranges = ranges && tree.rank(lo) == below && tree.count(lo, hi) == end - below
+                 && tree.aggregate(lo, hi) == sums[end] - sums[below];
+    }
+    check(selects, what + ": select matches the std::map order");
+    check(ranges, what + ": rank, count and aggregate over [lo, hi) match std::map");
+}
+
+// Adds count random items with keys below range to tree and expected, or keys in order past range if sorted
+static void fill(CheckedTree& tree, map<int, int>& expected, mt19937& random, int count, int range, bool sorted) {
+    for (int i = 0; i < count; i++) {
+        int key = sorted ? range + 3 * i : random() % range;
+        int value = random() % 100;
+        tree.insert(make_pair(key, value));
+        expected[key] = value;
+    }
+}
+
+// Random trees split, joined back and combined with the set operations, checked against std::map after each step.
+// The large rounds make both trees tall enough for the set operations to hand subtrees to other threads.
+static void testSplitJoin() {
+    mt19937 random(7);
+    const int ROUNDS = 120;
+    const int LARGE_ROUNDS = 2;
+    for (int round = 0; round < ROUNDS; round++) {
+        bool large = round >= ROUNDS - LARGE_ROUNDS;
+        int count = large ? 40000 : random() % 200;
+        unsigned threads = 1 + round % 4;
+        bool sorted = round % 5 == 0;
+        string name = "round " + to_string(round);
+
+        CheckedTree tree;
+        CheckedTree right;
+        map<int, int> expected;
+        fill(tree, expected, random, count, 3 * count + 1, sorted);
+        int key = random() % (4 * count + 2) - 1;
+        tree.split(key, right);
+        map<int, int> expectedLeft(expected.begin(), expected.lower_bound(key));
+        map<int, int> expectedRight(expected.lower_bound(key), expected.end());
+        checkTree(tree, expectedLeft, name + " split left");
+        checkTree(right, expectedRight, name + " split right");
+
+        CheckedTree joined;
+        joined.join(tree, right);
+        checkTree(joined, expected, name + " join");
+        checkTree(tree, map<int, int>(), name + " join empties left");
+        checkTree(right, map<int, int>(), name + " join empties right");
+
+        // Joining into one of the trees, and out of order, which has to throw and change nothing
+        joined.split(key, right);
+        joined.join(joined, right);
+        checkTree(joined, expected, name + " join into left");
+        if (!expectedLeft.empty() && !expectedRight.empty()) {
+            joined.split(key, right);
+            bool threw = false;
+            try {
+                joined.join(right, joined);
+            } catch (invalid_argument&) {
+                threw = true;
+            }
+            check(threw, name + " join out of order throws");
+            checkTree(joined, expectedLeft, name + " failed join keeps left");
+            checkTree(right, expectedRight, name + " failed join keeps right");
+            joined.join(joined, right);
+        }
+
+        // Several splits, then joined back in order
+        int cuts[4];
+        for (int& cut : cuts) {
+            cut = random() % (4 * count + 2);
+        }
+        sort(cuts, cuts + 4);
+        CheckedTree pieces[4];
+        for (int i = 3; i >= 0; i--) {
+            joined.split(cuts[i], pieces[i]);
+        }
+        for (int i = 0; i < 4; i++) {
+            joined.join(joined, pieces[i]);
+        }
+        checkTree(joined, expected, name + " pieces joined back");
+
+        for (int operation = 0; operation < 3; operation++) {
+            CheckedTree a;
+            CheckedTree b;
+            map<int, int> expectedA;
+            map<int, int> expectedB;
+            int range = (random() % 2 ? 1 : 3) * (count + 1);
+            fill(a, expectedA, random, count, range, sorted && operation == 0);
+            fill(b, expectedB, random, large ? count : random() % (count + 1), range, false);
+            map<int, int> result;
+            string what = name + " threads " + to_string(threads);
+            if (operation == 0) {
+                result = expectedA;
+                for (map<int, int>::iterator item = expectedB.begin(); item != expectedB.end(); ++item) {
+                    result[item->first] = item->second;
+                }
+                a.unionWith(b, threads);
+                what += " unionWith";
+            } else if (operation == 1) {
+                for (map<int, int>::iterator item = expectedA.begin(); item != expectedA.end(); ++item) {
+                    if (expectedB.count(item->first)) {
+                        result.insert(*item);
+                    }
+                }
+                a.intersectWith(b, threads);
+                what += " intersectWith";
+            } else {
+                for (map<int, int>::iterator item = expectedA.begin(); item != expectedA.end(); ++item) {
+                    if (!expectedB.count(item->first)) {
+                        result.insert(*item);
+                    }
+                }
+                a.subtract(b, threads);
+                what += " subtract";
+            }
+            checkTree(a, result, what);
+            checkTree(b, map<int, int>(), what + " empties other");
+        }
+    }
+}
+
+// Compares the ordered queries of tree with std::map for every key from below the smallest to above the largest in
+// [-2, range + 2): lowerBound, upperBound, equalRange, forEachInRange with lo == hi and lo > hi, and reverse iteration
+template<class Tree>
+static void checkOrderedQueries(const Tree& tree, const map<int, int>& expected, int range, mt19937& random,
+                                const string& what) {
+    bool bounds = true;
+    bool ranges = true;
+    for (int key = -2; key < range + 2; key++) {
+        map<int, int>::const_iterator lower = expected.lower_bound(key);
+        map<int, int>::const_iterator upper = expected.upper_bound(key);
+        typename Tree::iterator lowerIt = tree.lowerBound(key);
+        typename Tree::iterator upperIt = tree.upperBound(key);
+        pair<typename Tree::iterator, typename Tree::iterator> equal = tree.equalRange(key);
+        if ((lower == expected.end() ? lowerIt != tree.end() : lowerIt == tree.end() || lowerIt->first != lower->first)
+            || (upper == expected.end() ? upperIt != tree.end()
+                                        : upperIt == tree.end() || upperIt->first != upper->first)
+            || equal.first != lowerIt || equal.second != upperIt) {
+            bounds = false;
+        }
+
+        int hi = key + static_cast<int>(random() % 8) - 2;
+        vector<int> visited;
+        tree.forEachInRange(key, hi, [&visited](const pair<const int, int>& item) { visited.push_back(item.first); });
+        vector<int> inRange;
+        for (map<int, int>::const_iterator item = lower; item != expected.end() && item->first < hi; ++item) {
+            inRange.push_back(item->first);
+        }
+        if (visited != inRange) {
+            ranges = false;
+        }
+    }
+    check(bounds, what + ": lowerBound, upperBound and equalRange match std::map");
+    check(ranges, what + ": forEachInRange visits the std::map range");
+
+    bool reversed = true;
+    typename Tree::reverse_iterator it = tree.rbegin();
+    for (map<int, int>::const_reverse_iterator item = expected.rbegin(); item != expected.rend(); ++item, ++it) {
+        if (it == tree.rend() || it->first != item->first || it->second != item->second) {
+            reversed = false;
+            break;
+        }
+    }
+    check(reversed && it == tree.rend(), what + ": reverse iteration matches std::map");
+}
+
+// Plain and AVL trees of random keys, some removed again, queried across and past their keys. The empty first round
+// and the one-key second round cover trees with nothing or only the root to bound.
+static void testOrderedQueries() {
+    mt19937 random(11);
+    const int ROUNDS = 40;
+    for (int round = 0; round < ROUNDS; round++) {
+        int count = round < 2 ? round : random() % 300;
+        int range = 2 * count + 1;
+        string name = "queries round " + to_string(round);
+
+        BinarySearchTree<int, int> plain;
+        AVLTree<int, int> balanced;
+        map<int, int> expected;
+        for (int i = 0; i < count; i++) {
+            int key = random() % range;
+            int value = random() % 100;
+            plain.insert(make_pair(key, value));
+            balanced.insert(make_pair(key, value));
+            expected[key] = value;
+        }
+        for (int i = 0; i < count / 4; i++) {
+            int key = random() % range;
+            plain.remove(key);
+            balanced.remove(key);
+            expected.erase(key);
+        }
+        checkOrderedQueries(plain, expected, range, random, name + " plain");
+        checkOrderedQueries(balanced, expected, range, random, name + " AVL");
+    }
+}
+
+// count items with random keys below range, sorted by key, repeating keys with different values
+static vector<pair<int, int>> sortedItems(mt19937& random, int count, int range) {
+    vector<int> keys;
+    for (int i = 0; i < count; i++) {
+        keys.push_back(random() % range);
+    }
+    sort(keys.begin(), keys.end());
+    vector<pair<int, int>> items;
+    for (int key : keys) {
+        items.push_back(make_pair(key, static_cast<int>(random() % 100)));
+    }
+    return items;
+}
+
+// Trees built from sorted ranges and merged with more of them, as std::map would take the same items one at a time.
+// Ranges are empty, small or large next to the tree, overlap its keys and repeat keys; the large rounds merge more
+// than PARALLEL_GRAIN items so that several threads link the tree.
+static void testSortedBulk() {
+    mt19937 random(13);
+    const int ROUNDS = 60;
+    const int LARGE_ROUNDS = 2;
+    for (int round = 0; round < ROUNDS; round++) {
+        bool large = round >= ROUNDS - LARGE_ROUNDS;
+        int count = round % 10 == 0 ? 0 : large ? 20000 : random() % 300;
+        int range = 2 * count + 1;
+        unsigned threads = large ? 2 + round % 3 : 1 + round % 4;
+        string name = "bulk round " + to_string(round);
+
+        CheckedTree tree;
+        map<int, int> expected;
+        fill(tree, expected, random, 10, 50, false);
+        vector<pair<int, int>> built = sortedItems(random, count, range);
+        tree.buildSorted(built.begin(), built.end());
+        expected.clear();
+        for (const pair<int, int>& item : built) {
+            expected[item.first] = item.second;
+        }
+        checkTree(tree, expected, name + " build");
+
+        // Every other small round merges a batch small enough to be inserted key by key
+        int batch = large || round % 2 == 0 ? count + 1 : count / 8;
+        vector<pair<int, int>> merged = sortedItems(random, batch, range + range / 4);
+        tree.mergeSorted(merged.begin(), merged.end(), threads);
+        for (const pair<int, int>& item : merged) {
+            expected[item.first] = item.second;
+        }
+        checkTree(tree, expected, name + " merge");
+
+        vector<pair<int, int>> none;
+        tree.mergeSorted(none.begin(), none.end(), threads);
+        checkTree(tree, expected, name + " empty merge");
+        if (merged.size() > 1) {
+            vector<pair<int, int>> unsorted(merged.rbegin(), merged.rend());
+            bool threw = false;
+            try {
+                tree.mergeSorted(unsorted.begin(), unsorted.end(), threads);
+            } catch (const invalid_argument&) {
+                threw = true;
+            }
+            check(threw || unsorted.front().first == unsorted.back().first, name + " unsorted merge throws");
+            checkTree(tree, expected, name + " unsorted merge");
+        }
+    }
+}
+
+// Random batches in any order, with repeated keys and keys not in the tree, inserted, looked up and removed, with
+// std::map taking the same keys one at a time. Batch sizes step across a quarter of the tree, where the batch
+// operations switch from key by key to merging (MERGE_RATIO), and the large rounds pass PARALLEL_GRAIN keys to
+// several threads.
+static void testBatches() {
+    mt19937 random(17);
+    const int ROUNDS = 48;
+    const int LARGE_ROUNDS = 2;
+    for (int round = 0; round < ROUNDS; round++) {
+        bool large = round >= ROUNDS - LARGE_ROUNDS;
+        int count = large ? 20000 : 40 + random() % 200;
+        int range = 2 * count;
+        unsigned threads = 1 + round % 4;
+        string name = "batch round " + to_string(round) + " threads " + to_string(threads);
+
+        CheckedTree tree;
+        map<int, int> expected;
+        fill(tree, expected, random, count, range, false);
+        int size = static_cast<int>(expected.size());
+        int batch = large ? size : size / 4 - 1 + (round / 4) % 3;
+
+        vector<pair<int, int>> items;
+        for (int i = 0; i < batch; i++) {
+            int key = i % 5 == 4 ? items[random() % items.size()].first : static_cast<int>(random() % (2 * range));
+            items.push_back(make_pair(key, static_cast<int>(random() % 100)));
+        }
+        tree.insertBatch(items.begin(), items.end(), threads);
+        for (const pair<int, int>& item : items) {
+            expected[item.first] = item.second;
+        }
+        checkTree(tree, expected, name + " insert");
+
+        vector<int> keys;
+        for (int i = 0; i < (large ? 2 * size : batch); i++) {
+            keys.push_back(i % 5 == 4 ? keys[random() % keys.size()] : static_cast<int>(random() % (3 * range)) - 2);
+        }
+        vector<CheckedTree::iterator> found = tree.findBatch(keys.begin(), keys.end(), threads);
+        bool same = found.size() == keys.size();
+        for (size_t i = 0; same && i < keys.size(); i++) {
+            map<int, int>::const_iterator item = expected.find(keys[i]);
+            same = item == expected.end() ? found[i] == tree.end()
+                                          : found[i] != tree.end() && found[i]->first == item->first
+                                                    && found[i]->second == item->second;
+        }
+        check(same, name + " find: results match std::map in the order given");
+
+        tree.removeBatch(keys.begin(), keys.end(), threads);
+        for (int key : keys) {
+            expected.erase(key);
+        }
+        checkTree(tree, expected, name + " remove");
+    }
+}
+
+// Reads the packed links of a PooledAVLTree, which the public interface hides
+class CheckedPool : public PooledAVLTree<int, int> {
+public:
+    // Whether every node's parent index and the balance packed above it match the tree as linked
+    bool linksValid() const {
+        bool valid = true;
+        subtreeHeight(root_, NIL, valid);
+        return valid;
+    }
+
+    // Slots taken from the slab, and how many of them are on the free list
+    uint32_t slotsUsed() const { return used_; }
+    uint32_t slotsFree() const {
+        uint32_t count = 0;
+        for (uint32_t index = freeList_; index != NIL; index = slot(index).left) {
+            count++;
+        }
+        return count;
+    }
+
+private:
+    int subtreeHeight(uint32_t node, uint32_t parent, bool& valid) const {
+        if (node == NIL) {
+            return 0;
+        }
+        if (getParent(node) != parent || slot(node).parentBalance >> 30 > 2) {
+            valid = false;
+        }
+        int left = subtreeHeight(getLeft(node), node, valid);
+        int right = subtreeHeight(getRight(node), node, valid);
+        if (getBalance(node) != right - left) {
+            valid = false;
+        }
+        return 1 + max(left, right);
+    }
+};
+
+// Compares a pooled tree with expected in both directions, by lookups of keys in and out of it, and by its links
+static void checkPool(const CheckedPool& tree, const map<int, int>& expected, int range, const string& what) {
+    bool forward = true;
+    CheckedPool::iterator it = tree.begin();
+    for (map<int, int>::const_iterator item = expected.begin(); item != expected.end(); ++item, ++it) {
+        if (it == tree.end() || it->first != item->first || it->second != item->second) {
+            forward = false;
+            break;
+        }
+    }
+    bool backward = true;
+    CheckedPool::reverse_iterator rit = tree.rbegin();
+    for (map<int, int>::const_reverse_iterator item = expected.rbegin(); item != expected.rend(); ++item, ++rit) {
+        if (rit == tree.rend() || rit->first != item->first || rit->second != item->second) {
+            backward = false;
+            break;
+        }
+    }
+    bool found = true;
+    for (int key = -1; key <= range; key++) {
+        map<int, int>::const_iterator item = expected.find(key);
+        CheckedPool::iterator at = tree.find(key);
+        found = found && (item == expected.end() ? at == tree.end() : at != tree.end() && at->second == item->second);
+    }
+    check(forward && it == tree.end() && backward && rit == tree.rend(), what + ": iterates like std::map both ways");
+    check(found, what + ": find matches std::map");
+    check(tree.size() == expected.size() && tree.empty() == expected.empty(), what + ": size matches std::map");
+    check(tree.isBalanced() && tree.linksValid(), what + ": parent indices and packed balances are right");
+    check(tree.slotsFree() == tree.slotsUsed() - tree.size(), what + ": every slot is in the tree or free");
+}
+
+// Random inserts and removes on a pooled tree and std::map. After each batch of removes, as many new keys are
+// inserted, and they must all fit in the freed slots; the last round spans several chunks.
+static void testPooledTree() {
+    mt19937 random(19);
+    const int ROUNDS = 30;
+    for (int round = 0; round < ROUNDS; round++) {
+        int count = round == ROUNDS - 1 ? 10000 : random() % 400;
+        int range = 2 * count + 1;
+        string name = "pooled round " + to_string(round);
+
+        CheckedPool tree;
+        map<int, int> expected;
+        for (int i = 0; i < count; i++) {
+            int key = random() % range;
+            int value = random() % 100;
+            tree.insert(make_pair(key, value));
+            expected[key] = value;
+        }
+        checkPool(tree, expected, range, name + " insert");
+
+        int removed = 0;
+        for (int i = 0; i < count / 2; i++) {
+            int key = random() % range;
+            removed += static_cast<int>(expected.erase(key));
+            tree.remove(key);
+        }
+        checkPool(tree, expected, range, name + " remove");
+
+        uint32_t used = tree.slotsUsed();
+        for (int key = range; key < range + removed; key++) {
+            tree.insert(make_pair(key, key));
+            expected[key] = key;
+        }
+        check(tree.slotsUsed() == used && tree.slotsFree() == 0, name + ": inserts reuse the freed slots");
+        checkPool(tree, expected, range + removed, name + " reinsert");
+
+        tree.clear();
+        checkPool(tree, map<int, int>(), range, name + " clear");
+    }
+}
+
+// A value that counts how many of it exist, so a persistent tree's nodes, which each hold one, can be counted
+struct Counted {
+    static atomic<int> live;
+    int value;
+
+    explicit Counted(int value) : value(value) { live++; }
+    Counted(const Counted& other) : value(other.value) { live++; }
+    Counted& operator=(const Counted& other) {
+        value = other.value;
+        return *this;
+    }
+    ~Counted() { live--; }
+};
+
+atomic<int> Counted::live(0);
+
+// A version of a persistent tree whose nodes and reference counts can be looked at
+class CheckedVersion : public PersistentAVLTree<int, Counted> {
+public:
+    // How many version roots and child links point at each node
+    typedef map<const Node*, size_t> References;
+
+    CheckedVersion() {}
+    CheckedVersion(PersistentAVLTree<int, Counted>&& version) : PersistentAVLTree<int, Counted>(move(version)) {}
+
+    // Adds one to references[node] for every version root and every child link reaching node from versions
+    static void countReferences(const vector<const CheckedVersion*>& versions, References& references) {
+        vector<const Node*> pending;
+        for (const CheckedVersion* version : versions) {
+            if (version->root_ != nullptr && references[version->root_]++ == 0) {
+                pending.push_back(version->root_);
+            }
+        }
+        while (!pending.empty()) {
+            const Node* node = pending.back();
+            pending.pop_back();
+            for (const Node* child : {node->left, node->right}) {
+                if (child != nullptr && references[child]++ == 0) {
+                    pending.push_back(child);
+                }
+            }
+        }
+    }
+
+    static bool referencesMatch(const References& references) {
+        for (const pair<const Node* const, size_t>& node : references) {
+            if (node.first->references.load() != node.second) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Compares one version with the std::map copy taken when it was made
+static void checkVersion(const CheckedVersion& version, const map<int, int>& expected, const string& what) {
+    bool same = true;
+    CheckedVersion::iterator it = version.begin();
+    for (map<int, int>::const_iterator item = expected.begin(); item != expected.end(); ++item, ++it) {
+        if (it == version.end() || it->first != item->first || it->second.value != item->second
+            || version.find(item->first) == version.end()) {
+            same = false;
+            break;
+        }
+    }
+    check(same && it == version.end() && version.size() == expected.size(), what + ": matches its std::map copy");
+    check(version.isBalanced(), what + ": balanced");
+}
+
+// Every node of every version still alive is reachable from one of them, and counts exactly the versions and nodes
+// that point at it
+static void checkNodes(const vector<const CheckedVersion*>& versions, const string& what) {
+    CheckedVersion::References references;
+    CheckedVersion::countReferences(versions, references);
+    check(CheckedVersion::referencesMatch(references), what + ": reference counts match the links to each node");
+    check(Counted::live.load() == static_cast<int>(references.size()), what + ": unreachable nodes are freed");
+}
+
+// A live tree changes while snapshots of it are kept, each with a std::map copy from the same moment. The snapshots
+// are dropped in a random order, the last half of them by threads at once, and every node must go with the last
+// version that holds it.
+static void testSnapshots() {
+    mt19937 random(23);
+    const int SNAPSHOTS = 12;
+    const int CHANGES = 150;
+    const int RANGE = 400;
+    const size_t DROPPERS = 3;
+    {
+        CheckedVersion live;
+        map<int, int> expected;
+        vector<CheckedVersion> snapshots;
+        vector<map<int, int>> copies;
+        for (int snapshot = 0; snapshot < SNAPSHOTS; snapshot++) {
+            for (int change = 0; change < CHANGES; change++) {
+                int key = random() % RANGE;
+                if (random() % 3 == 0) {
+                    live = live.remove(key);
+                    expected.erase(key);
+                } else {
+                    int value = random() % 100;
+                    live = live.insert(make_pair(key, Counted(value)));
+                    expected[key] = value;
+                }
+            }
+            snapshots.push_back(live);
+            copies.push_back(expected);
+        }
+        live = live.remove(-1);
+        live = live.insert(make_pair(RANGE, Counted(0)));
+        expected[RANGE] = 0;
+        checkVersion(live, expected, "live tree");
+
+        vector<const CheckedVersion*> versions(1, &live);
+        for (int snapshot = 0; snapshot < SNAPSHOTS; snapshot++) {
+            checkVersion(snapshots[snapshot], copies[snapshot], "snapshot " + to_string(snapshot));
+            versions.push_back(&snapshots[snapshot]);
+        }
+        checkNodes(versions, "all snapshots");
+
+        vector<int> order;
+        for (int snapshot = 0; snapshot < SNAPSHOTS; snapshot++) {
+            order.push_back(snapshot);
+        }
+        shuffle(order.begin(), order.end(), random);
+        for (int i = 0; i < SNAPSHOTS / 2; i++) {
+            snapshots[order[i]] = CheckedVersion();
+            versions.erase(find(versions.begin(), versions.end(), &snapshots[order[i]]));
+            checkNodes(versions, "dropped snapshot " + to_string(order[i]));
+        }
+
+        vector<thread> droppers;
+        atomic<int> mismatches(0);
+        for (size_t t = 0; t < DROPPERS; t++) {
+            droppers.push_back(thread([&, t]() {
+                for (int i = SNAPSHOTS / 2 + static_cast<int>(t); i < SNAPSHOTS; i += static_cast<int>(DROPPERS)) {
+                    CheckedVersion mine(move(snapshots[order[i]]));
+                    if (mine.size() != copies[order[i]].size()) {
+                        mismatches++;
+                    }
+                }
+            }));
+        }
+        for (thread& dropper : droppers) {
+            dropper.join();
+        }
+        check(mismatches.load() == 0, "snapshots dropped by threads were intact");
+        checkNodes(vector<const CheckedVersion*>(1, &live), "snapshots dropped by threads");
+        checkVersion(live, expected, "live tree after the snapshots");
+    }
+    check(Counted::live.load() == 0, "the last version frees every node");
+}
+
+// Reads how deep a B+-tree is, to tell that inserts split inner nodes and removes merged them back
+template<class Key>
+class CheckedBPlus : public BPlusTree<Key, int> {
+public:
+    // Levels above the leaves, or -1 when empty or out of shape
+    int depth() const {
+        return this->root_ == nullptr ? -1 : BPlusTree<Key, int>::checkedDepth(this->root_, nullptr, nullptr, true);
+    }
+};
+
+// NodeKeySearch against std::lower_bound and upper_bound for every count a node can have, with the padding past
+// count holding keys that would be counted if the search read them. For int this is the SSE2 search where the build
+// has it, whose last block of four is cut down by validLanes.
+template<class Key>
+static void checkNodeKeySearch(mt19937& random, const string& what) {
+    const size_t SLOTS = 36;
+    bool same = true;
+    for (size_t count = 0; count + 4 <= SLOTS; count++) {
+        Key keys[SLOTS];
+        for (size_t i = 0; i < SLOTS; i++) {
+            keys[i] = i < count ? static_cast<Key>(random() % 40) : static_cast<Key>(-1);
+        }
+        sort(keys, keys + count);
+        for (Key key = -1; key <= 41; key++) {
+            same = same && NodeKeySearch<Key>::countLess(keys, count, key)
+                                   == static_cast<size_t>(lower_bound(keys, keys + count, key) - keys)
+                   && NodeKeySearch<Key>::countNotGreater(keys, count, key)
+                              == static_cast<size_t>(upper_bound(keys, keys + count, key) - keys);
+        }
+    }
+    check(same, what + " node search matches std::lower_bound and upper_bound");
+}
+
+// Random inserts and removes on a B+-tree and std::map, growing the tree until inner nodes split and removing until
+// they have merged back into one leaf, with its contents, lookups, bounds and leaf scans compared along the way
+template<class Key>
+static void checkBPlus(mt19937& random, const string& what) {
+    const int COUNT = 6000;
+    const int RANGE = 2 * COUNT;
+    const int CHECKS = 6;
+
+    CheckedBPlus<Key> tree;
+    map<Key, int> expected;
+    int deepest = -1;
+    for (int step = 0; step < 2 * CHECKS; step++) {
+        bool growing = step < CHECKS;
+        string name = what + (growing ? " insert " : " remove ") + to_string(step);
+        for (int i = 0; i < COUNT / CHECKS; i++) {
+            Key key = static_cast<Key>(random() % RANGE);
+            if (growing || random() % 8 == 0) {
+                int value = random() % 100;
+                tree.insert(make_pair(key, value));
+                expected[key] = value;
+            }
+            // The removes take out keys known to be there, so the tree shrinks as fast as it grew
+            if (!growing && !expected.empty()) {
+                typename map<Key, int>::iterator victim = expected.lower_bound(key);
+                if (victim == expected.end()) {
+                    victim = expected.begin();
+                }
+                tree.remove(victim->first);
+                expected.erase(victim);
+            }
+            tree.remove(static_cast<Key>(RANGE + 1));
+        }
+        deepest = max(deepest, tree.depth());
+
+        bool same = tree.size() == expected.size() && tree.empty() == expected.empty();
+        typename CheckedBPlus<Key>::iterator it = tree.begin();
+        for (typename map<Key, int>::const_iterator item = expected.begin(); same && item != expected.end();
+             ++item, ++it) {
+            same = it != tree.end() && it->first == item->first && it->second == item->second;
+        }
+        check(same && it == tree.end(), name + ": contents match std::map");
+        check(tree.isBalanced(), name + ": keys sorted, nodes at least half full and leaves level");
+
+        bool found = true;
+        bool ranges = true;
+        for (Key key = -1; key <= RANGE; key += 1 + random() % 16) {
+            typename map<Key, int>::const_iterator item = expected.find(key);
+            typename CheckedBPlus<Key>::iterator at = tree.find(key);
+            found = found && (item == expected.end() ? at == tree.end()
+                                                     : at != tree.end() && at->second == item->second);
+            typename map<Key, int>::const_iterator lower = expected.lower_bound(key);
+            typename CheckedBPlus<Key>::iterator bound = tree.lowerBound(key);
+            found = found && (lower == expected.end() ? bound == tree.end()
+                                                      : bound != tree.end() && bound->first == lower->first);
+
+            Key hi = key + static_cast<Key>(random() % 200);
+            vector<Key> visited;
+            tree.forEachInRange(key, hi, [&visited](const pair<const Key, int>& item) {
+                visited.push_back(item.first);
+            });
+            vector<Key> inRange;
+            for (; lower != expected.end() && lower->first < hi; ++lower) {
+                inRange.push_back(lower->first);
+            }
+            ranges = ranges && visited == inRange;
+        }
+        check(found, name + ": find and lowerBound match std::map");
+        check(ranges, name + ": leaf scans visit the std::map range");
+    }
+    check(deepest >= 2, what + ": inner nodes split");
+    check(tree.depth() <= 0, what + ": removes merged the inner nodes away");
+}
+
+// int keys take the SSE2 node search where the build has it; long long keys always take the scalar one
+static void testBPlusTree() {
+    mt19937 random(29);
+    checkNodeKeySearch<int>(random, "int");
+    checkNodeKeySearch<long long>(random, "long long");
+    checkBPlus<int>(random, "B+-tree of int");
+    checkBPlus<long long>(random, "B+-tree of long long");
+}
+
+// Sorted inserts leave a plain tree as one right spine. insert() would walk the whole spine for every key, so the spine
+// is grown from its bottom end instead, giving the same shape in linear time.
+class SpineTree : public BinarySearchTree<int, int> {
+public:
+    void insertLargest(int key) {
+        if (root_ == nullptr) {
+            insert(make_pair(key, key));
+            last_ = root_;
+        } else {
+            last_->setRight(make_shared<Node<int, int>>(key, key, last_));
+            last_ = last_->getRight();
+        }
+    }
+
+private:
+    shared_ptr<Node<int, int>> last_;
+};
+
+// clear(), isBalanced() and the destructor must not recurse as deep as the tree, which here is one node per key.
+static void testDeepTree() {
+    const int KEYS = 100000;
+
+    SpineTree tree;
+    for (int key = 0; key < KEYS; key++) {
+        tree.insertLargest(key);
+    }
+    tree.insert(make_pair(KEYS, KEYS));
+    check(tree.find(KEYS) != tree.end() && tree.find(KEYS)->second == KEYS, "deep tree insert below the spine");
+    check(!tree.isBalanced(), "deep tree balance");
+    tree.clear();
+    check(tree.empty() && tree.begin() == tree.end(), "deep tree clear");
+    for (int key = 0; key < KEYS; key++) {
+        tree.insertLargest(key);
+    }
+}
+
 int main(int argc, char* argv[]) {
     // Binary Search Tree tests
     BinarySearchTree<char, int> bt;
@@ -57,5 +947,16 @@ int main(int argc, char* argv[]) {
     cout << "Erasing a" << endl;
     at.remove('a');
 
-    return 0;
+    testConcurrentReaders();
+    testSplitJoin();
+    testDeepTree();
+    testOrderedQueries();
+    testSortedBulk();
+    testBatches();
+    testPooledTree();
+    testSnapshots();
+    testBPlusTree();
+
+    cout << endl << (failures == 0 ? "All checks passed" : to_string(failures) + " checks failed") << endl;
+    return failures == 0 ? 0 : 1;
 }
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <memory>
 #include <utility>
+#include <vector>
 
 // A templated class for a Node in a search tree.
 // The getters for parent/left/right are virtual so
@@ -203,16 +204,53 @@ public:
         std::shared_ptr<Node<Key, Value>> current_;
     };
 
+    // Walks the items from the largest key down, using predecessor
+    class reverse_iterator {
+    public:
+        reverse_iterator();
+
+        std::pair<const Key, Value>& operator*() const;
+        std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const reverse_iterator& rhs) const;
+        bool operator!=(const reverse_iterator& rhs) const;
+
+        reverse_iterator& operator++();
+
+    protected:
+        friend class BinarySearchTree<Key, Value>;
+        reverse_iterator(std::shared_ptr<Node<Key, Value>> ptr);
+        std::shared_ptr<Node<Key, Value>> current_;
+    };
+
 public:
     // Functions already completed for you
     iterator begin() const;
     iterator end() const;
     iterator find(const Key& key) const;
 
+    reverse_iterator rbegin() const;
+    reverse_iterator rend() const;
+
+    // The first item with a key not less than key, or greater than key, or end() if there is none
+    iterator lowerBound(const Key& key) const;
+    iterator upperBound(const Key& key) const;
+
+    // lowerBound(key) and upperBound(key): the item with key, or two equal iterators to where it would go
+    std::pair<iterator, iterator> equalRange(const Key& key) const;
+
+    // Calls visit(item) on each item with a key in [lo, hi), in order, as it goes: one search for lo, then a
+    // successor step per item, so a scan costs O(log n + items in range) and nothing is collected
+    template<class Visit>
+    void forEachInRange(const Key& lo, const Key& hi, Visit visit) const;
+
 protected:
     // Mandatory helper functions you need to complete
     std::shared_ptr<Node<Key, Value>> internalFind(const Key& k) const;
     std::shared_ptr<Node<Key, Value>> getSmallestNode() const;
+    std::shared_ptr<Node<Key, Value>> getLargestNode() const;
+    std::shared_ptr<Node<Key, Value>> lowerBoundNode(const Key& key) const;
+    std::shared_ptr<Node<Key, Value>> upperBoundNode(const Key& key) const;
     static std::shared_ptr<Node<Key, Value>> predecessor(std::shared_ptr<Node<Key, Value>> current);
     static std::shared_ptr<Node<Key, Value>> successor(std::shared_ptr<Node<Key, Value>> current);
     // Note:  static means these functions don't have a "this" pointer
@@ -236,6 +274,7 @@ protected:
     int getHeight(std::shared_ptr<Node<Key, Value>> root) const;
     bool isBalancedHelper(std::shared_ptr<Node<Key, Value>> root) const;
     std::shared_ptr<Node<Key, Value>> getRoot();
+    iterator iteratorAt(std::shared_ptr<Node<Key, Value>> node) const;
     std::shared_ptr<Node<Key, Value>> internalFindHelper(std::shared_ptr<Node<Key, Value>> node, const Key& key) const;
 
 protected:
@@ -288,6 +327,42 @@ typename BinarySearchTree<Key, Value>::iterator& BinarySearchTree<Key, Value>::i
     return *this;
 }
 
+template<class Key, class Value>
+BinarySearchTree<Key, Value>::reverse_iterator::reverse_iterator(std::shared_ptr<Node<Key, Value>> ptr)
+        : current_(ptr) {}
+
+template<class Key, class Value>
+BinarySearchTree<Key, Value>::reverse_iterator::reverse_iterator() : current_(nullptr) {}
+
+template<class Key, class Value>
+std::pair<const Key, Value>& BinarySearchTree<Key, Value>::reverse_iterator::operator*() const {
+    return current_->getItem();
+}
+
+template<class Key, class Value>
+std::pair<const Key, Value>* BinarySearchTree<Key, Value>::reverse_iterator::operator->() const {
+    return &current_->getItem();
+}
+
+template<class Key, class Value>
+bool BinarySearchTree<Key, Value>::reverse_iterator::operator==(
+        const BinarySearchTree<Key, Value>::reverse_iterator& rhs) const {
+    return this->current_ == rhs.current_;
+}
+
+template<class Key, class Value>
+bool BinarySearchTree<Key, Value>::reverse_iterator::operator!=(
+        const BinarySearchTree<Key, Value>::reverse_iterator& rhs) const {
+    return this->current_ != rhs.current_;
+}
+
+// Moves to the item with the next smaller key
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::reverse_iterator& BinarySearchTree<Key, Value>::reverse_iterator::operator++() {
+    this->current_ = predecessor(this->current_);
+    return *this;
+}
+
 // -------------------------------------------------------------
 // End implementations for the BinarySearchTree::iterator class.
 // -------------------------------------------------------------
@@ -324,16 +399,25 @@ bool BinarySearchTree<Key, Value>::hasParent(std::shared_ptr<Node<Key, Value>> n
 
 template<typename Key, typename Value>
 void BinarySearchTree<Key, Value>::clearHelper(std::shared_ptr<Node<Key, Value>> root) {
-    // Recurse both ways then call reset() on current node
-    if (root == nullptr) {
-        return;
+    // Unlink nodes from an explicit stack, so that neither this nor the destructors recurse as deep as the tree
+    std::vector<std::shared_ptr<Node<Key, Value>>> pending;
+    if (root != nullptr) {
+        pending.push_back(root);
     }
-    clearHelper(root->getLeft());
-    clearHelper(root->getRight());
-    root->setLeft(nullptr);
-    root->setRight(nullptr);
-    root->setParent(nullptr);
     root.reset();
+    while (!pending.empty()) {
+        std::shared_ptr<Node<Key, Value>> node = pending.back();
+        pending.pop_back();
+        if (node->getLeft() != nullptr) {
+            pending.push_back(node->getLeft());
+        }
+        if (node->getRight() != nullptr) {
+            pending.push_back(node->getRight());
+        }
+        node->setLeft(nullptr);
+        node->setRight(nullptr);
+        node->setParent(nullptr);
+    }
 }
 template<class Key, class Value>
 bool BinarySearchTree<Key, Value>::isLeafNode(std::shared_ptr<Node<Key, Value>> node) {
@@ -365,29 +449,60 @@ bool BinarySearchTree<Key, Value>::hasOneChild(std::shared_ptr<Node<Key, Value>>
 
 template<class Key, class Value>
 int BinarySearchTree<Key, Value>::getHeight(std::shared_ptr<Node<Key, Value>> root) const {
-    if (root == nullptr) {
-        return 0;
+    // Count the levels, one at a time
+    int height = 0;
+    std::vector<std::shared_ptr<Node<Key, Value>>> level;
+    std::vector<std::shared_ptr<Node<Key, Value>>> next;
+    if (root != nullptr) {
+        level.push_back(root);
+    }
+    while (!level.empty()) {
+        height++;
+        next.clear();
+        for (const std::shared_ptr<Node<Key, Value>>& node : level) {
+            if (node->getLeft() != nullptr) {
+                next.push_back(node->getLeft());
+            }
+            if (node->getRight() != nullptr) {
+                next.push_back(node->getRight());
+            }
+        }
+        level.swap(next);
     }
-
-    return 1 + std::max(getHeight(root->getLeft()), getHeight(root->getRight()));
+    return height;
 }
 
 template<class Key, class Value>
 bool BinarySearchTree<Key, Value>::isBalancedHelper(std::shared_ptr<Node<Key, Value>> root) const {
-    int left = 0;
-    int right = 0;
-
-    if (root == nullptr) {
-        return true;
-    }
-
-    left = getHeight(root->getLeft());
-    right = getHeight(root->getRight());
-
-    if (abs(left - right) < 2 && isBalancedHelper(root->getLeft()) && isBalancedHelper(root->getRight())) {
-        return true;
+    // One post-order pass: a node is finished once both its subtrees are, and their heights wait on a stack for it
+    struct Step {
+        std::shared_ptr<Node<Key, Value>> node;
+        bool childrenDone;
+    };
+    std::vector<Step> pending;
+    std::vector<int> heights;
+    pending.push_back(Step{root, false});
+    while (!pending.empty()) {
+        Step step = pending.back();
+        pending.pop_back();
+        if (step.node == nullptr) {
+            heights.push_back(0);
+        } else if (!step.childrenDone) {
+            pending.push_back(Step{step.node, true});
+            pending.push_back(Step{step.node->getRight(), false});
+            pending.push_back(Step{step.node->getLeft(), false});
+        } else {
+            int right = heights.back();
+            heights.pop_back();
+            int left = heights.back();
+            heights.pop_back();
+            if (abs(left - right) > 1) {
+                return false;
+            }
+            heights.push_back(1 + std::max(left, right));
+        }
     }
-    return false;
+    return true;
 }
 
 template<class Key, class Value>
@@ -398,26 +513,15 @@ std::shared_ptr<Node<Key, Value>> BinarySearchTree<Key, Value>::getRoot() {
 template<class Key, class Value>
 std::shared_ptr<Node<Key, Value>>
 BinarySearchTree<Key, Value>::internalFindHelper(std::shared_ptr<Node<Key, Value>> node, const Key& key) const {
-    // Base case
-    if (node->getKey() != key && node->getLeft() == nullptr && node->getRight() == nullptr) {
-        return nullptr;
-    }
-    // If found, otherwise traverse
-    if (node->getKey() == key) {
-        return node;
-    } else if (key < node->getKey()) {
-        if (node->getLeft() == nullptr) {
-            return nullptr;
+    // Walk down from node until the key is found or the path runs out
+    while (node != nullptr && node->getKey() != key) {
+        if (key < node->getKey()) {
+            node = node->getLeft();
         } else {
-            return internalFindHelper(node->getLeft(), key);
-        }
-    } else {
-        if (node->getRight() == nullptr) {
-            return nullptr;
-        } else {
-            return internalFindHelper(node->getRight(), key);
+            node = node->getRight();
         }
     }
+    return node;
 }
 
 // Default constructor for a BinarySearchTree, which sets the root to NULL.
@@ -467,6 +571,52 @@ typename BinarySearchTree<Key, Value>::iterator BinarySearchTree<Key, Value>::fi
     return it;
 }
 
+// Returns an iterator to node, for subclasses that find nodes their own way
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::iterator
+BinarySearchTree<Key, Value>::iteratorAt(std::shared_ptr<Node<Key, Value>> node) const {
+    return iterator(node);
+}
+
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::reverse_iterator BinarySearchTree<Key, Value>::rbegin() const {
+    return reverse_iterator(getLargestNode());
+}
+
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::reverse_iterator BinarySearchTree<Key, Value>::rend() const {
+    return reverse_iterator(nullptr);
+}
+
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::iterator BinarySearchTree<Key, Value>::lowerBound(const Key& key) const {
+    return iterator(lowerBoundNode(key));
+}
+
+template<class Key, class Value>
+typename BinarySearchTree<Key, Value>::iterator BinarySearchTree<Key, Value>::upperBound(const Key& key) const {
+    return iterator(upperBoundNode(key));
+}
+
+template<class Key, class Value>
+std::pair<typename BinarySearchTree<Key, Value>::iterator, typename BinarySearchTree<Key, Value>::iterator>
+BinarySearchTree<Key, Value>::equalRange(const Key& key) const {
+    std::shared_ptr<Node<Key, Value>> lower = lowerBoundNode(key);
+    if (lower != nullptr && !(key < lower->getKey())) {
+        return std::make_pair(iterator(lower), iterator(successor(lower)));
+    }
+    return std::make_pair(iterator(lower), iterator(lower));
+}
+
+template<class Key, class Value>
+template<class Visit>
+void BinarySearchTree<Key, Value>::forEachInRange(const Key& lo, const Key& hi, Visit visit) const {
+    for (std::shared_ptr<Node<Key, Value>> node = lowerBoundNode(lo); node != nullptr && node->getKey() < hi;
+         node = successor(node)) {
+        visit(node->getItem());
+    }
+}
+
 // An insert method to insert into a Binary Search Tree.
 // If the key is already present in the tree,
 // update the current value with the new value.
@@ -634,7 +784,7 @@ std::shared_ptr<Node<Key, Value>> BinarySearchTree<Key, Value>::predecessor(std:
 template<typename Key, typename Value>
 void BinarySearchTree<Key, Value>::clear() {
     clearHelper(root_);
-    // root_ = nullptr;
+    root_ = nullptr;
 }
 
 // A helper function to find the smallest node in the tree.
@@ -651,6 +801,52 @@ std::shared_ptr<Node<Key, Value>> BinarySearchTree<Key, Value>::getSmallestNode(
     return traverse;
 }
 
+// A helper function to find the largest node in the tree.
+template<typename Key, typename Value>
+std::shared_ptr<Node<Key, Value>> BinarySearchTree<Key, Value>::getLargestNode() const {
+    if (root_ == nullptr) {
+        return nullptr;
+    }
+
+    auto traverse = root_;
+    while (traverse->getRight() != nullptr) {
+        traverse = traverse->getRight();
+    }
+    return traverse;
+}
+
+// Returns the node with the smallest key not less than key, or nullptr if every key is less
+template<typename Key, typename Value>
+std::shared_ptr<Node<Key, Value>> BinarySearchTree<Key, Value>::lowerBoundNode(const Key& key) const {
+    std::shared_ptr<Node<Key, Value>> bound = nullptr;
+    auto traverse = root_;
+    while (traverse != nullptr) {
+        if (traverse->getKey() < key) {
+            traverse = traverse->getRight();
+        } else {
+            bound = traverse;
+            traverse = traverse->getLeft();
+        }
+    }
+    return bound;
+}
+
+// Returns the node with the smallest key greater than key, or nullptr if there is none
+template<typename Key, typename Value>
+std::shared_ptr<Node<Key, Value>> BinarySearchTree<Key, Value>::upperBoundNode(const Key& key) const {
+    std::shared_ptr<Node<Key, Value>> bound = nullptr;
+    auto traverse = root_;
+    while (traverse != nullptr) {
+        if (key < traverse->getKey()) {
+            bound = traverse;
+            traverse = traverse->getLeft();
+        } else {
+            traverse = traverse->getRight();
+        }
+    }
+    return bound;
+}
+
 // Helper function to find a node with given key, k and
 // return a pointer to it or nullptr if no item with that key exists
 template<typename Key, typename Value>
@@ -0,0 +1,362 @@
+#ifndef CONCURRENT_AVL_H
+#define CONCURRENT_AVL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * An AVL tree for one writer at a time and many readers, where readers never lock or wait.
+ *
+ * Nodes are never changed once readers can see them. An update copies the path from the root down to what it
+ * changes, rebalances the copies and publishes them by swapping the root pointer, so a reader always walks one whole
+ * version of the tree. Writers take a mutex, so updates happen one at a time.
+ *
+ * Nodes an update replaces are retired rather than freed, tagged with the epoch they were replaced in. A reader
+ * announces the epoch it starts in, and a retired node is freed once every reader in progress started after it
+ * was replaced. A reader only ever delays freeing; it never blocks the writer.
+ *
+ * Readers go through a Reader, which holds one of MAX_READERS announcement slots for as long as it lives:
+ *     ConcurrentAVLTree<int, int>::Reader reader(tree);
+ *     int value;
+ *     if (reader.find(key, value)) ...
+ * find copies the value out, since the node may be freed once the reader moves on.
+ */
+template<class Key, class Value>
+class ConcurrentAVLTree {
+public:
+    static const size_t MAX_READERS = 64;
+
+    ConcurrentAVLTree();
+    ~ConcurrentAVLTree();
+
+    ConcurrentAVLTree(const ConcurrentAVLTree&) = delete;
+    ConcurrentAVLTree& operator=(const ConcurrentAVLTree&) = delete;
+
+    // Updates take the writer lock; they do not wait for readers
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+
+    size_t size() const;
+
+    // A reader's claim on the tree. Use one per thread; it is not safe to share between threads.
+    class Reader {
+    public:
+        // Throws std::length_error if MAX_READERS readers already exist
+        explicit Reader(ConcurrentAVLTree<Key, Value>& tree);
+        ~Reader();
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // Copies the value for key into value and returns true, or returns false if key is not in the tree
+        bool find(const Key& key, Value& value);
+
+    private:
+        ConcurrentAVLTree<Key, Value>& tree_;
+        size_t slot_;
+    };
+
+protected:
+    struct Node {
+        std::pair<const Key, Value> item;
+        Node* left;
+        Node* right;
+        int height;
+        uint64_t version;  // The update that made the node; it can be changed in place during that update only
+    };
+
+    struct Retired {
+        Node* node;
+        uint64_t epoch;
+    };
+
+    // The epoch a slot holds while its reader is not reading
+    static const uint64_t IDLE = UINT64_MAX;
+
+    struct alignas(64) ReaderSlot {
+        std::atomic<uint64_t> epoch;
+        std::atomic<bool> claimed;
+    };
+
+    static int height(const Node* node);
+
+    // Returns node itself if this update made it, or else a copy to change, retiring node
+    Node* own(Node* node);
+    Node* makeNode(const Key& key, const Value& value);
+    void retire(Node* node);
+
+    // Each takes and returns the root of a subtree; the nodes passed in must be owned by this update
+    Node* rebalance(Node* node);
+    Node* rotateLeft(Node* node);
+    Node* rotateRight(Node* node);
+
+    Node* insertAt(Node* node, const Key& key, const Value& value);
+    Node* removeAt(Node* node, const Key& key);
+    Node* removeSmallest(Node* node, Node*& smallest);
+
+    // Publishes root and frees the retired nodes no reader can still be looking at
+    void publish(Node* root);
+    void reclaim();
+
+    static void deleteAll(Node* node);
+
+    std::atomic<Node*> root_;
+    std::atomic<uint64_t> epoch_;
+    std::atomic<size_t> size_;
+    ReaderSlot readers_[MAX_READERS];
+
+    // Only touched with the writer lock held
+    std::mutex writer_;
+    uint64_t version_;
+    std::vector<Retired> retired_;
+};
+
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::ConcurrentAVLTree() : root_(nullptr), epoch_(0), size_(0), version_(0) {
+    for (ReaderSlot& slot : readers_) {
+        slot.epoch.store(IDLE);
+        slot.claimed.store(false);
+    }
+}
+
+// There must be no readers left
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::~ConcurrentAVLTree() {
+    deleteAll(root_.load());
+    for (const Retired& retired : retired_) {
+        delete retired.node;
+    }
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::deleteAll(Node* node) {
+    while (node != nullptr) {
+        deleteAll(node->left);
+        Node* right = node->right;
+        delete node;
+        node = right;
+    }
+}
+
+template<class Key, class Value>
+size_t ConcurrentAVLTree<Key, Value>::size() const {
+    return size_.load();
+}
+
+template<class Key, class Value>
+int ConcurrentAVLTree<Key, Value>::height(const Node* node) {
+    return node == nullptr ? 0 : node->height;
+}
+
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node*
+ConcurrentAVLTree<Key, Value>::makeNode(const Key& key, const Value& value) {
+    return new Node{std::pair<const Key, Value>(key, value), nullptr, nullptr, 1, version_};
+}
+
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node* ConcurrentAVLTree<Key, Value>::own(Node* node) {
+    if (node->version == version_) {
+        return node;
+    }
+    Node* copy = new Node(*node);
+    copy->version = version_;
+    retire(node);
+    return copy;
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::retire(Node* node) {
+    if (node->version == version_) {
+        // Never published, so no reader can have it
+        delete node;
+    } else {
+        retired_.push_back(Retired{node, epoch_.load()});
+    }
+}
+
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node* ConcurrentAVLTree<Key, Value>::rotateLeft(Node* node) {
+    Node* right = own(node->right);
+    node->right = right->left;
+    right->left = node;
+    node->height = 1 + std::max(height(node->left), height(node->right));
+    right->height = 1 + std::max(height(right->left), height(right->right));
+    return right;
+}
+
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node* ConcurrentAVLTree<Key, Value>::rotateRight(Node* node) {
+    Node* left = own(node->left);
+    node->left = left->right;
+    left->right = node;
+    node->height = 1 + std::max(height(node->left), height(node->right));
+    left->height = 1 + std::max(height(left->left), height(left->right));
+    return left;
+}
+
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node* ConcurrentAVLTree<Key, Value>::rebalance(Node* node) {
+    int balance = height(node->right) - height(node->left);
+    if (balance > 1) {
+        if (height(node->right->left) > height(node->right->right)) {
+            node->right = rotateRight(own(node->right));
+        }
+        return rotateLeft(node);
+    } else if (balance < -1) {
+        if (height(node->left->right) > height(node->left->left)) {
+            node->left = rotateLeft(own(node->left));
+        }
+        return rotateRight(node);
+    }
+    node->height = 1 + std::max(height(node->left), height(node->right));
+    return node;
+}
+
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node*
+ConcurrentAVLTree<Key, Value>::insertAt(Node* node, const Key& key, const Value& value) {
+    if (node == nullptr) {
+        size_.fetch_add(1);
+        return makeNode(key, value);
+    }
+    node = own(node);
+    if (key < node->item.first) {
+        node->left = insertAt(node->left, key, value);
+    } else if (node->item.first < key) {
+        node->right = insertAt(node->right, key, value);
+    } else {
+        node->item.second = value;
+        return node;
+    }
+    return rebalance(node);
+}
+
+// Assumes key is in the subtree
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node* ConcurrentAVLTree<Key, Value>::removeAt(Node* node, const Key& key) {
+    if (key < node->item.first) {
+        node = own(node);
+        node->left = removeAt(node->left, key);
+        return rebalance(node);
+    } else if (node->item.first < key) {
+        node = own(node);
+        node->right = removeAt(node->right, key);
+        return rebalance(node);
+    }
+
+    size_.fetch_sub(1);
+    Node* left = node->left;
+    Node* right = node->right;
+    retire(node);
+    if (left == nullptr) {
+        return right;
+    } else if (right == nullptr) {
+        return left;
+    }
+    // Put the successor in the removed node's place
+    Node* successor = nullptr;
+    right = removeSmallest(right, successor);
+    successor = own(successor);
+    successor->left = left;
+    successor->right = right;
+    return rebalance(successor);
+}
+
+// Unlinks the smallest node of the subtree into smallest, without retiring it
+template<class Key, class Value>
+typename ConcurrentAVLTree<Key, Value>::Node*
+ConcurrentAVLTree<Key, Value>::removeSmallest(Node* node, Node*& smallest) {
+    if (node->left == nullptr) {
+        smallest = node;
+        return node->right;
+    }
+    node = own(node);
+    node->left = removeSmallest(node->left, smallest);
+    return rebalance(node);
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair) {
+    std::lock_guard<std::mutex> lock(writer_);
+    version_++;
+    publish(insertAt(root_.load(), keyValuePair.first, keyValuePair.second));
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::remove(const Key& key) {
+    std::lock_guard<std::mutex> lock(writer_);
+    // Look first, so that removing a missing key copies nothing
+    Node* node = root_.load();
+    while (node != nullptr && node->item.first != key) {
+        node = key < node->item.first ? node->left : node->right;
+    }
+    if (node == nullptr) {
+        return;
+    }
+    version_++;
+    publish(removeAt(root_.load(), key));
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::publish(Node* root) {
+    // The nodes retired by this update carry the epoch from before the increment. A reader that announces a later
+    // epoch read it after root was stored, so it starts from the new root and cannot reach them.
+    root_.store(root);
+    epoch_.fetch_add(1);
+    reclaim();
+}
+
+template<class Key, class Value>
+void ConcurrentAVLTree<Key, Value>::reclaim() {
+    uint64_t oldest = IDLE;
+    for (const ReaderSlot& slot : readers_) {
+        oldest = std::min(oldest, slot.epoch.load());
+    }
+    // Retired nodes are in epoch order
+    size_t freed = 0;
+    while (freed < retired_.size() && retired_[freed].epoch < oldest) {
+        delete retired_[freed++].node;
+    }
+    retired_.erase(retired_.begin(), retired_.begin() + freed);
+}
+
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::Reader::Reader(ConcurrentAVLTree<Key, Value>& tree) : tree_(tree) {
+    for (slot_ = 0; slot_ < MAX_READERS; slot_++) {
+        bool claimed = false;
+        if (tree_.readers_[slot_].claimed.compare_exchange_strong(claimed, true)) {
+            return;
+        }
+    }
+    throw std::length_error("too many readers");
+}
+
+template<class Key, class Value>
+ConcurrentAVLTree<Key, Value>::Reader::~Reader() {
+    tree_.readers_[slot_].claimed.store(false);
+}
+
+template<class Key, class Value>
+bool ConcurrentAVLTree<Key, Value>::Reader::find(const Key& key, Value& value) {
+    // Announce the epoch before loading the root (both sequentially consistent), so the writer either sees the
+    // announcement or published its root before this load
+    std::atomic<uint64_t>& epoch = tree_.readers_[slot_].epoch;
+    epoch.store(tree_.epoch_.load());
+    const Node* node = tree_.root_.load();
+    while (node != nullptr && node->item.first != key) {
+        node = key < node->item.first ? node->left : node->right;
+    }
+    if (node != nullptr) {
+        value = node->item.second;
+    }
+    epoch.store(IDLE, std::memory_order_release);
+    return node != nullptr;
+}
+
+#endif
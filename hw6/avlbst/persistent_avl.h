@@ -0,0 +1,382 @@
+#ifndef PERSISTENT_AVL_H
+#define PERSISTENT_AVL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+/**
+ * An AVL tree whose versions never change. insert and remove leave the tree they are called on as it was and return
+ * a new version, which copies the O(log n) nodes on the path to the change and shares every other subtree with the
+ * old version. Copying a tree is an O(1) snapshot.
+ *
+ *     PersistentAVLTree<int, int> v1 = v0.insert(std::make_pair(1, 10));
+ *     PersistentAVLTree<int, int> snapshot = v1;  // v1 as it is now, whatever happens to v1 later
+ *
+ * Nodes have no parent pointers, since a node can be in many versions, and count their own references instead of
+ * being held by std::shared_ptr. The counts are atomic, so versions that share nodes can be read, copied and
+ * dropped from different threads; one PersistentAVLTree object is not safe to assign from two threads at once.
+ *
+ * Iterators walk one version with a stack of the nodes above them, and stay valid while that version lives.
+ */
+template<class Key, class Value>
+class PersistentAVLTree {
+protected:
+    struct Node;
+
+public:
+    PersistentAVLTree();
+    PersistentAVLTree(const PersistentAVLTree& other);
+    PersistentAVLTree(PersistentAVLTree&& other) noexcept;
+    PersistentAVLTree& operator=(const PersistentAVLTree& other);
+    PersistentAVLTree& operator=(PersistentAVLTree&& other) noexcept;
+    ~PersistentAVLTree();
+
+    // The tree with keyValuePair added, or its value replaced if the key is already there
+    PersistentAVLTree insert(const std::pair<const Key, Value>& keyValuePair) const;
+
+    // The tree without key; a copy of this one if key is not in it
+    PersistentAVLTree remove(const Key& key) const;
+
+    bool isBalanced() const;
+    bool empty() const;
+    size_t size() const;
+
+    class iterator {
+    public:
+        iterator();
+
+        const std::pair<const Key, Value>& operator*() const;
+        const std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class PersistentAVLTree<Key, Value>;
+
+        // The current node on top, under it every node whose left subtree the walk is in
+        std::vector<const Node*> path_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+
+protected:
+    typedef std::pair<const Key, Value> Item;
+
+    struct Node {
+        Node(Node* left, const Item& item, Node* right);
+
+        Item item;
+        Node* left;
+        Node* right;
+        int height;
+        std::atomic<size_t> references;
+    };
+
+    PersistentAVLTree(Node* root, size_t size);
+
+    static int height(const Node* node);
+    static Node* retain(Node* node);
+    static void release(Node* node);
+
+    // These take over the references to left and right passed in and return a new reference
+    static Node* makeNode(Node* left, const Item& item, Node* right);
+    static Node* balance(Node* left, const Item& item, Node* right);
+
+    // These return a new reference to a changed copy of node's subtree; node is left alone
+    static Node* insertAt(const Node* node, const Item& item);
+    static Node* removeAt(const Node* node, const Key& key);
+    static Node* removeSmallest(const Node* node);
+
+    static bool contains(const Node* node, const Key& key);
+    static int balancedHeight(const Node* node);
+
+    Node* root_;
+    size_t size_;
+};
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::Node::Node(Node* left, const Item& item, Node* right)
+        : item(item),
+          left(left),
+          right(right),
+          height(1 + std::max(PersistentAVLTree::height(left), PersistentAVLTree::height(right))),
+          references(1) {}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::PersistentAVLTree() : root_(nullptr), size_(0) {}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::PersistentAVLTree(Node* root, size_t size) : root_(root), size_(size) {}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::PersistentAVLTree(const PersistentAVLTree& other)
+        : root_(retain(other.root_)), size_(other.size_) {}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::PersistentAVLTree(PersistentAVLTree&& other) noexcept
+        : root_(other.root_), size_(other.size_) {
+    other.root_ = nullptr;
+    other.size_ = 0;
+}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>& PersistentAVLTree<Key, Value>::operator=(const PersistentAVLTree& other) {
+    Node* root = retain(other.root_);
+    release(root_);
+    root_ = root;
+    size_ = other.size_;
+    return *this;
+}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>& PersistentAVLTree<Key, Value>::operator=(PersistentAVLTree&& other) noexcept {
+    if (this != &other) {
+        release(root_);
+        root_ = other.root_;
+        size_ = other.size_;
+        other.root_ = nullptr;
+        other.size_ = 0;
+    }
+    return *this;
+}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::~PersistentAVLTree() {
+    release(root_);
+}
+
+template<class Key, class Value>
+int PersistentAVLTree<Key, Value>::height(const Node* node) {
+    return node == nullptr ? 0 : node->height;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::Node* PersistentAVLTree<Key, Value>::retain(Node* node) {
+    if (node != nullptr) {
+        node->references.fetch_add(1, std::memory_order_relaxed);
+    }
+    return node;
+}
+
+// Drops one reference to node, freeing it and dropping its references to its children if it was the last
+template<class Key, class Value>
+void PersistentAVLTree<Key, Value>::release(Node* node) {
+    while (node != nullptr && node->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        release(node->left);
+        Node* right = node->right;
+        delete node;
+        node = right;
+    }
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::Node*
+PersistentAVLTree<Key, Value>::makeNode(Node* left, const Item& item, Node* right) {
+    return new Node(left, item, right);
+}
+
+// Joins left, item and right, whose heights differ by at most 2, into a balanced subtree. A rotation takes apart
+// the taller side's root, sharing its children with the new nodes before dropping it.
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::Node*
+PersistentAVLTree<Key, Value>::balance(Node* left, const Item& item, Node* right) {
+    Node* result;
+    if (height(left) > height(right) + 1) {
+        if (height(left->right) > height(left->left)) {
+            // zig-zag: left's right child ends up on top
+            Node* middle = left->right;
+            result = makeNode(
+                    makeNode(retain(left->left), left->item, retain(middle->left)),
+                    middle->item,
+                    makeNode(retain(middle->right), item, right));
+        } else {
+            result = makeNode(retain(left->left), left->item, makeNode(retain(left->right), item, right));
+        }
+        release(left);
+    } else if (height(right) > height(left) + 1) {
+        if (height(right->left) > height(right->right)) {
+            Node* middle = right->left;
+            result = makeNode(
+                    makeNode(left, item, retain(middle->left)),
+                    middle->item,
+                    makeNode(retain(middle->right), right->item, retain(right->right)));
+        } else {
+            result = makeNode(makeNode(left, item, retain(right->left)), right->item, retain(right->right));
+        }
+        release(right);
+    } else {
+        result = makeNode(left, item, right);
+    }
+    return result;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::Node*
+PersistentAVLTree<Key, Value>::insertAt(const Node* node, const Item& item) {
+    if (node == nullptr) {
+        return makeNode(nullptr, item, nullptr);
+    } else if (item.first < node->item.first) {
+        return balance(insertAt(node->left, item), node->item, retain(node->right));
+    } else if (node->item.first < item.first) {
+        return balance(retain(node->left), node->item, insertAt(node->right, item));
+    }
+    return makeNode(retain(node->left), item, retain(node->right));
+}
+
+// Assumes key is in node's subtree
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::Node*
+PersistentAVLTree<Key, Value>::removeAt(const Node* node, const Key& key) {
+    if (key < node->item.first) {
+        return balance(removeAt(node->left, key), node->item, retain(node->right));
+    } else if (node->item.first < key) {
+        return balance(retain(node->left), node->item, removeAt(node->right, key));
+    } else if (node->left == nullptr) {
+        return retain(node->right);
+    } else if (node->right == nullptr) {
+        return retain(node->left);
+    }
+    // The successor takes the removed item's place
+    const Node* successor = node->right;
+    while (successor->left != nullptr) {
+        successor = successor->left;
+    }
+    return balance(retain(node->left), successor->item, removeSmallest(node->right));
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::Node* PersistentAVLTree<Key, Value>::removeSmallest(const Node* node) {
+    if (node->left == nullptr) {
+        return retain(node->right);
+    }
+    return balance(removeSmallest(node->left), node->item, retain(node->right));
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::contains(const Node* node, const Key& key) {
+    while (node != nullptr && node->item.first != key) {
+        node = key < node->item.first ? node->left : node->right;
+    }
+    return node != nullptr;
+}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>
+PersistentAVLTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair) const {
+    bool present = contains(root_, keyValuePair.first);
+    return PersistentAVLTree(insertAt(root_, keyValuePair), present ? size_ : size_ + 1);
+}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value> PersistentAVLTree<Key, Value>::remove(const Key& key) const {
+    if (!contains(root_, key)) {
+        return *this;
+    }
+    return PersistentAVLTree(removeAt(root_, key), size_ - 1);
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::empty() const {
+    return root_ == nullptr;
+}
+
+template<class Key, class Value>
+size_t PersistentAVLTree<Key, Value>::size() const {
+    return size_;
+}
+
+// Returns the height of node's subtree, or -1 if it is not balanced or a stored height is wrong
+template<class Key, class Value>
+int PersistentAVLTree<Key, Value>::balancedHeight(const Node* node) {
+    if (node == nullptr) {
+        return 0;
+    }
+    int left = balancedHeight(node->left);
+    int right = balancedHeight(node->right);
+    if (left < 0 || right < 0 || std::abs(left - right) > 1 || node->height != 1 + std::max(left, right)) {
+        return -1;
+    }
+    return node->height;
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::isBalanced() const {
+    return balancedHeight(root_) >= 0;
+}
+
+template<class Key, class Value>
+PersistentAVLTree<Key, Value>::iterator::iterator() {}
+
+template<class Key, class Value>
+const std::pair<const Key, Value>& PersistentAVLTree<Key, Value>::iterator::operator*() const {
+    return path_.back()->item;
+}
+
+template<class Key, class Value>
+const std::pair<const Key, Value>* PersistentAVLTree<Key, Value>::iterator::operator->() const {
+    return &path_.back()->item;
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::iterator::operator==(const iterator& rhs) const {
+    return path_.empty() ? rhs.path_.empty() : !rhs.path_.empty() && path_.back() == rhs.path_.back();
+}
+
+template<class Key, class Value>
+bool PersistentAVLTree<Key, Value>::iterator::operator!=(const iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+// Steps to the smallest node of the right subtree, or else back up to the nearest node whose left subtree this was
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator& PersistentAVLTree<Key, Value>::iterator::operator++() {
+    const Node* node = path_.back()->right;
+    path_.pop_back();
+    for (; node != nullptr; node = node->left) {
+        path_.push_back(node);
+    }
+    return *this;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator PersistentAVLTree<Key, Value>::begin() const {
+    iterator it;
+    for (const Node* node = root_; node != nullptr; node = node->left) {
+        it.path_.push_back(node);
+    }
+    return it;
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator PersistentAVLTree<Key, Value>::end() const {
+    return iterator();
+}
+
+template<class Key, class Value>
+typename PersistentAVLTree<Key, Value>::iterator PersistentAVLTree<Key, Value>::find(const Key& key) const {
+    iterator it;
+    const Node* node = root_;
+    while (node != nullptr) {
+        if (key < node->item.first) {
+            it.path_.push_back(node);
+            node = node->left;
+        } else if (node->item.first < key) {
+            node = node->right;
+        } else {
+            it.path_.push_back(node);
+            return it;
+        }
+    }
+    return end();
+}
+
+#endif
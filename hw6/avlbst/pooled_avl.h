@@ -0,0 +1,795 @@
+#ifndef POOLED_AVL_H
+#define POOLED_AVL_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * An AVL tree with the same insert/remove/find/iterator interface as AVLTree, for indexes with millions of keys.
+ *
+ * Nodes live in a slab of fixed size chunks and link to each other by 32 bit index instead of std::shared_ptr, so a
+ * node is its item plus 12 bytes: the left and right child and the parent, with the balance packed into the top two
+ * bits of the parent index. Chunks never move, so iterators and references to items stay valid until their item is
+ * removed. Removed nodes go on a free list and are reused by the next inserts; clear() gives the memory back.
+ *
+ * Balances follow AVLTree: -1 when the left subtree is taller, +1 when the right one is.
+ */
+template<class Key, class Value>
+class PooledAVLTree {
+public:
+    PooledAVLTree();
+    ~PooledAVLTree();
+
+    PooledAVLTree(const PooledAVLTree&) = delete;
+    PooledAVLTree& operator=(const PooledAVLTree&) = delete;
+
+    void insert(const std::pair<const Key, Value>& keyValuePair);
+    void remove(const Key& key);
+    void clear();
+    bool isBalanced() const;
+    bool empty() const;
+    size_t size() const;
+
+    class iterator {
+    public:
+        iterator();
+
+        std::pair<const Key, Value>& operator*() const;
+        std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const iterator& rhs) const;
+        bool operator!=(const iterator& rhs) const;
+
+        iterator& operator++();
+
+    protected:
+        friend class PooledAVLTree<Key, Value>;
+        iterator(const PooledAVLTree<Key, Value>* tree, uint32_t index);
+        const PooledAVLTree<Key, Value>* tree_;
+        uint32_t current_;
+    };
+
+    // Walks the items from the largest key down, using predecessor
+    class reverse_iterator {
+    public:
+        reverse_iterator();
+
+        std::pair<const Key, Value>& operator*() const;
+        std::pair<const Key, Value>* operator->() const;
+
+        bool operator==(const reverse_iterator& rhs) const;
+        bool operator!=(const reverse_iterator& rhs) const;
+
+        reverse_iterator& operator++();
+
+    protected:
+        friend class PooledAVLTree<Key, Value>;
+        reverse_iterator(const PooledAVLTree<Key, Value>* tree, uint32_t index);
+        const PooledAVLTree<Key, Value>* tree_;
+        uint32_t current_;
+    };
+
+    iterator begin() const;
+    iterator end() const;
+    iterator find(const Key& key) const;
+
+    reverse_iterator rbegin() const;
+    reverse_iterator rend() const;
+
+protected:
+    typedef std::pair<const Key, Value> Item;
+
+    // The index of no node. Indices use the 30 bits below the balance.
+    static const uint32_t NIL = (uint32_t(1) << 30) - 1;
+    static const uint32_t MAX_NODES = NIL;
+
+    static const uint32_t CHUNK_BITS = 12;
+    static const uint32_t CHUNK_SIZE = uint32_t(1) << CHUNK_BITS;
+
+    struct Slot {
+        typename std::aligned_storage<sizeof(Item), alignof(Item)>::type item;  // Constructed while in the tree
+        uint32_t left;                                                          // The next free slot when free
+        uint32_t right;
+        uint32_t parentBalance;  // Parent index in the low 30 bits, balance + 1 in the top 2
+    };
+
+    Slot& slot(uint32_t index) const;
+    Item& item(uint32_t index) const;
+
+    uint32_t getParent(uint32_t index) const;
+    uint32_t getLeft(uint32_t index) const;
+    uint32_t getRight(uint32_t index) const;
+    int getBalance(uint32_t index) const;
+    void setParent(uint32_t index, uint32_t parent);
+    void setLeft(uint32_t index, uint32_t left);
+    void setRight(uint32_t index, uint32_t right);
+    void setBalance(uint32_t index, int balance);
+
+    // Takes a slot off the free list, or from the end of the slab, and constructs the item in it
+    uint32_t allocate(const Item& keyValuePair, uint32_t parent);
+    // Destroys the item and puts the slot on the free list
+    void release(uint32_t index);
+
+    uint32_t internalFind(const Key& key) const;
+    uint32_t getSmallestNode() const;
+    uint32_t getLargestNode() const;
+    uint32_t successor(uint32_t current) const;
+    uint32_t predecessor(uint32_t current) const;
+
+    // Replaces child of parent with replacement, or the root if parent is NIL
+    void replaceChild(uint32_t parent, uint32_t child, uint32_t replacement);
+
+    // Pre condition: p is the parent of n. Post condition: p is the left (rotateLeft) or right child of n
+    void rotateLeft(uint32_t p, uint32_t n);
+    void rotateRight(uint32_t p, uint32_t n);
+
+    void insertFix(uint32_t p, uint32_t n);
+    void removeFix(uint32_t n, int diff);
+
+    // Swaps the positions of two nodes in the tree, balances included, as BinarySearchTree::nodeSwap does
+    void nodeSwap(uint32_t n1, uint32_t n2);
+
+    std::vector<std::unique_ptr<Slot[]>> chunks_;
+    uint32_t used_;      // Slots handed out from the slab, free or not
+    uint32_t freeList_;  // Removed slots, linked through left
+    uint32_t root_;
+    size_t size_;
+};
+
+/*
+------------------------------------------------------------
+Begin implementations for the PooledAVLTree::iterator class.
+------------------------------------------------------------
+*/
+
+template<class Key, class Value>
+PooledAVLTree<Key, Value>::iterator::iterator() : tree_(nullptr), current_(NIL) {}
+
+template<class Key, class Value>
+PooledAVLTree<Key, Value>::iterator::iterator(const PooledAVLTree<Key, Value>* tree, uint32_t index)
+        : tree_(tree), current_(index) {}
+
+template<class Key, class Value>
+std::pair<const Key, Value>& PooledAVLTree<Key, Value>::iterator::operator*() const {
+    return tree_->item(current_);
+}
+
+template<class Key, class Value>
+std::pair<const Key, Value>* PooledAVLTree<Key, Value>::iterator::operator->() const {
+    return &tree_->item(current_);
+}
+
+// End iterators compare equal whichever tree they came from, like null node pointers
+template<class Key, class Value>
+bool PooledAVLTree<Key, Value>::iterator::operator==(const iterator& rhs) const {
+    return current_ == rhs.current_ && (current_ == NIL || tree_ == rhs.tree_);
+}
+
+template<class Key, class Value>
+bool PooledAVLTree<Key, Value>::iterator::operator!=(const iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::iterator& PooledAVLTree<Key, Value>::iterator::operator++() {
+    current_ = tree_->successor(current_);
+    return *this;
+}
+
+template<class Key, class Value>
+PooledAVLTree<Key, Value>::reverse_iterator::reverse_iterator() : tree_(nullptr), current_(NIL) {}
+
+template<class Key, class Value>
+PooledAVLTree<Key, Value>::reverse_iterator::reverse_iterator(const PooledAVLTree<Key, Value>* tree, uint32_t index)
+        : tree_(tree), current_(index) {}
+
+template<class Key, class Value>
+std::pair<const Key, Value>& PooledAVLTree<Key, Value>::reverse_iterator::operator*() const {
+    return tree_->item(current_);
+}
+
+template<class Key, class Value>
+std::pair<const Key, Value>* PooledAVLTree<Key, Value>::reverse_iterator::operator->() const {
+    return &tree_->item(current_);
+}
+
+template<class Key, class Value>
+bool PooledAVLTree<Key, Value>::reverse_iterator::operator==(const reverse_iterator& rhs) const {
+    return current_ == rhs.current_ && (current_ == NIL || tree_ == rhs.tree_);
+}
+
+template<class Key, class Value>
+bool PooledAVLTree<Key, Value>::reverse_iterator::operator!=(const reverse_iterator& rhs) const {
+    return !(*this == rhs);
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::reverse_iterator& PooledAVLTree<Key, Value>::reverse_iterator::operator++() {
+    current_ = tree_->predecessor(current_);
+    return *this;
+}
+
+/*
+----------------------------------------------
+Begin implementations for the PooledAVLTree class.
+----------------------------------------------
+*/
+
+template<class Key, class Value>
+PooledAVLTree<Key, Value>::PooledAVLTree() : used_(0), freeList_(NIL), root_(NIL), size_(0) {}
+
+template<class Key, class Value>
+PooledAVLTree<Key, Value>::~PooledAVLTree() {
+    clear();
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::Slot& PooledAVLTree<Key, Value>::slot(uint32_t index) const {
+    return chunks_[index >> CHUNK_BITS][index & (CHUNK_SIZE - 1)];
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::Item& PooledAVLTree<Key, Value>::item(uint32_t index) const {
+    return *reinterpret_cast<Item*>(&slot(index).item);
+}
+
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::getParent(uint32_t index) const {
+    return slot(index).parentBalance & NIL;
+}
+
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::getLeft(uint32_t index) const {
+    return slot(index).left;
+}
+
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::getRight(uint32_t index) const {
+    return slot(index).right;
+}
+
+template<class Key, class Value>
+int PooledAVLTree<Key, Value>::getBalance(uint32_t index) const {
+    return static_cast<int>(slot(index).parentBalance >> 30) - 1;
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::setParent(uint32_t index, uint32_t parent) {
+    Slot& s = slot(index);
+    s.parentBalance = (s.parentBalance & ~NIL) | parent;
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::setLeft(uint32_t index, uint32_t left) {
+    slot(index).left = left;
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::setRight(uint32_t index, uint32_t right) {
+    slot(index).right = right;
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::setBalance(uint32_t index, int balance) {
+    Slot& s = slot(index);
+    s.parentBalance = (s.parentBalance & NIL) | static_cast<uint32_t>(balance + 1) << 30;
+}
+
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::allocate(const Item& keyValuePair, uint32_t parent) {
+    uint32_t index = freeList_;
+    if (index != NIL) {
+        freeList_ = slot(index).left;
+    } else {
+        if (used_ == MAX_NODES) {
+            throw std::length_error("PooledAVLTree is full");
+        }
+        if ((used_ & (CHUNK_SIZE - 1)) == 0) {
+            chunks_.push_back(std::unique_ptr<Slot[]>(new Slot[CHUNK_SIZE]));
+        }
+        index = used_++;
+    }
+    Slot& s = slot(index);
+    new (&s.item) Item(keyValuePair);
+    s.left = NIL;
+    s.right = NIL;
+    s.parentBalance = parent | uint32_t(1) << 30;
+    size_++;
+    return index;
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::release(uint32_t index) {
+    item(index).~Item();
+    slot(index).left = freeList_;
+    freeList_ = index;
+    size_--;
+}
+
+template<class Key, class Value>
+bool PooledAVLTree<Key, Value>::empty() const {
+    return root_ == NIL;
+}
+
+template<class Key, class Value>
+size_t PooledAVLTree<Key, Value>::size() const {
+    return size_;
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::iterator PooledAVLTree<Key, Value>::begin() const {
+    return iterator(this, getSmallestNode());
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::iterator PooledAVLTree<Key, Value>::end() const {
+    return iterator(this, NIL);
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::iterator PooledAVLTree<Key, Value>::find(const Key& key) const {
+    return iterator(this, internalFind(key));
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::reverse_iterator PooledAVLTree<Key, Value>::rbegin() const {
+    return reverse_iterator(this, getLargestNode());
+}
+
+template<class Key, class Value>
+typename PooledAVLTree<Key, Value>::reverse_iterator PooledAVLTree<Key, Value>::rend() const {
+    return reverse_iterator(this, NIL);
+}
+
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::internalFind(const Key& key) const {
+    uint32_t traverse = root_;
+    while (traverse != NIL) {
+        const Key& here = item(traverse).first;
+        if (key == here) {
+            return traverse;
+        }
+        traverse = key < here ? getLeft(traverse) : getRight(traverse);
+    }
+    return NIL;
+}
+
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::getSmallestNode() const {
+    uint32_t traverse = root_;
+    if (traverse == NIL) {
+        return NIL;
+    }
+    while (getLeft(traverse) != NIL) {
+        traverse = getLeft(traverse);
+    }
+    return traverse;
+}
+
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::getLargestNode() const {
+    uint32_t traverse = root_;
+    if (traverse == NIL) {
+        return NIL;
+    }
+    while (getRight(traverse) != NIL) {
+        traverse = getRight(traverse);
+    }
+    return traverse;
+}
+
+// Returns the next largest node or NIL if it doesn't exist
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::successor(uint32_t current) const {
+    if (current == NIL) {
+        return NIL;
+    }
+    // Case 1: If the node has a right child: go right then all the way left
+    if (getRight(current) != NIL) {
+        current = getRight(current);
+        while (getLeft(current) != NIL) {
+            current = getLeft(current);
+        }
+        return current;
+    }
+    // Case 2: If not, we have to go up the tree until we come up from a left child
+    uint32_t parent = getParent(current);
+    while (parent != NIL && current == getRight(parent)) {
+        current = parent;
+        parent = getParent(parent);
+    }
+    return parent;
+}
+
+// Returns the next smallest node or NIL if it doesn't exist
+template<class Key, class Value>
+uint32_t PooledAVLTree<Key, Value>::predecessor(uint32_t current) const {
+    if (current == NIL) {
+        return NIL;
+    }
+    if (getLeft(current) != NIL) {
+        current = getLeft(current);
+        while (getRight(current) != NIL) {
+            current = getRight(current);
+        }
+        return current;
+    }
+    uint32_t parent = getParent(current);
+    while (parent != NIL && current == getLeft(parent)) {
+        current = parent;
+        parent = getParent(parent);
+    }
+    return parent;
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::replaceChild(uint32_t parent, uint32_t child, uint32_t replacement) {
+    if (parent == NIL) {
+        root_ = replacement;
+    } else if (getLeft(parent) == child) {
+        setLeft(parent, replacement);
+    } else {
+        setRight(parent, replacement);
+    }
+    if (replacement != NIL) {
+        setParent(replacement, parent);
+    }
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::rotateLeft(uint32_t p, uint32_t n) {
+    uint32_t nLeft = getLeft(n);
+    replaceChild(getParent(p), p, n);
+
+    // Move p down and re-parent n's left child
+    setLeft(n, p);
+    setParent(p, n);
+    setRight(p, nLeft);
+    if (nLeft != NIL) {
+        setParent(nLeft, p);
+    }
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::rotateRight(uint32_t p, uint32_t n) {
+    uint32_t nRight = getRight(n);
+    replaceChild(getParent(p), p, n);
+
+    setRight(n, p);
+    setParent(p, n);
+    setLeft(p, nRight);
+    if (nRight != NIL) {
+        setParent(nRight, p);
+    }
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::insert(const std::pair<const Key, Value>& keyValuePair) {
+    // Empty AVL
+    if (root_ == NIL) {
+        root_ = allocate(keyValuePair, NIL);
+        return;
+    }
+
+    uint32_t traverse = root_;
+    uint32_t newNode;
+    while (true) {
+        Item& here = item(traverse);
+        // Same key
+        if (keyValuePair.first == here.first) {
+            here.second = keyValuePair.second;
+            return;
+        }
+        // Smaller key, go left
+        if (keyValuePair.first < here.first) {
+            if (getLeft(traverse) == NIL) {
+                newNode = allocate(keyValuePair, traverse);
+                setLeft(traverse, newNode);
+                break;
+            }
+            traverse = getLeft(traverse);
+        }
+        // Bigger key, go right
+        else {
+            if (getRight(traverse) == NIL) {
+                newNode = allocate(keyValuePair, traverse);
+                setRight(traverse, newNode);
+                break;
+            }
+            traverse = getRight(traverse);
+        }
+    }
+
+    // Update parent balance
+    if (getBalance(traverse) != 0) {
+        setBalance(traverse, 0);
+    } else {
+        setBalance(traverse, newNode == getLeft(traverse) ? -1 : 1);
+        insertFix(traverse, newNode);
+    }
+}
+
+// The same cases as AVLTree::insertFix, walking up in a loop
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::insertFix(uint32_t p, uint32_t n) {
+    while (true) {
+        uint32_t g = getParent(p);
+        if (g == NIL) {
+            return;
+        }
+        // side is -1 when p is the left child of g
+        int side = p == getLeft(g) ? -1 : 1;
+        int balance = getBalance(g) + side;
+        // Case 1: b(g) == 0
+        if (balance == 0) {
+            setBalance(g, 0);
+            return;
+        }
+        // Case 2: g got taller on p's side
+        if (balance == side) {
+            setBalance(g, balance);
+            n = p;
+            p = g;
+            continue;
+        }
+        // Case 3: zig-zig
+        if (side == -1 ? n == getLeft(p) : n == getRight(p)) {
+            if (side == -1) {
+                rotateRight(g, p);
+            } else {
+                rotateLeft(g, p);
+            }
+            setBalance(p, 0);
+            setBalance(g, 0);
+            return;
+        }
+        // Case 3: zig-zag
+        if (side == -1) {
+            rotateLeft(p, n);
+            rotateRight(g, n);
+        } else {
+            rotateRight(p, n);
+            rotateLeft(g, n);
+        }
+        int b = getBalance(n);
+        setBalance(p, b == -side ? side : 0);
+        setBalance(g, b == side ? -side : 0);
+        setBalance(n, 0);
+        return;
+    }
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::remove(const Key& key) {
+    uint32_t removeNode = internalFind(key);
+    if (removeNode == NIL) {
+        return;
+    }
+
+    if (getLeft(removeNode) != NIL && getRight(removeNode) != NIL) {
+        nodeSwap(removeNode, predecessor(removeNode));
+    }
+
+    // removeNode now has at most one child, which takes its place
+    uint32_t p = getParent(removeNode);
+    int diff = 0;
+    if (p != NIL) {
+        diff = removeNode == getLeft(p) ? 1 : -1;
+    }
+    uint32_t child = getLeft(removeNode) != NIL ? getLeft(removeNode) : getRight(removeNode);
+    replaceChild(p, removeNode, child);
+
+    release(removeNode);
+    removeFix(p, diff);
+}
+
+// The same cases as AVLTree::removeFix, walking up in a loop. diff is +1 when n's left subtree got shorter.
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::removeFix(uint32_t n, int diff) {
+    while (n != NIL) {
+        // Compute the next step's arguments now before altering tree
+        uint32_t p = getParent(n);
+        int ndiff = 0;
+        if (p != NIL) {
+            ndiff = n == getLeft(p) ? 1 : -1;
+        }
+
+        int balance = getBalance(n) + diff;
+        // Case 2: n is now one taller on the other side but just as tall
+        if (balance == diff) {
+            setBalance(n, balance);
+            return;
+        }
+        // Case 3: n got shorter
+        if (balance == 0) {
+            setBalance(n, 0);
+            n = p;
+            diff = ndiff;
+            continue;
+        }
+
+        // Case 1: b(n) + diff == 2 * diff, rotate the taller child c up
+        uint32_t c = diff == -1 ? getLeft(n) : getRight(n);
+        int cBalance = getBalance(c);
+        if (cBalance == diff) {
+            // Case 1a: zig-zig
+            if (diff == -1) {
+                rotateRight(n, c);
+            } else {
+                rotateLeft(n, c);
+            }
+            setBalance(n, 0);
+            setBalance(c, 0);
+        } else if (cBalance == 0) {
+            // Case 1b: zig-zig, the height does not change
+            if (diff == -1) {
+                rotateRight(n, c);
+            } else {
+                rotateLeft(n, c);
+            }
+            setBalance(n, diff);
+            setBalance(c, -diff);
+            return;
+        } else {
+            // Case 1c: zig-zag
+            uint32_t g = diff == -1 ? getRight(c) : getLeft(c);
+            if (diff == -1) {
+                rotateLeft(c, g);
+                rotateRight(n, g);
+            } else {
+                rotateRight(c, g);
+                rotateLeft(n, g);
+            }
+            int gBalance = getBalance(g);
+            setBalance(n, gBalance == diff ? -diff : 0);
+            setBalance(c, gBalance == -diff ? diff : 0);
+            setBalance(g, 0);
+        }
+        n = p;
+        diff = ndiff;
+    }
+}
+
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::nodeSwap(uint32_t n1, uint32_t n2) {
+    if (n1 == n2 || n1 == NIL || n2 == NIL) {
+        return;
+    }
+    uint32_t n1p = getParent(n1);
+    uint32_t n1r = getRight(n1);
+    uint32_t n1lt = getLeft(n1);
+    bool n1isLeft = n1p != NIL && n1 == getLeft(n1p);
+    uint32_t n2p = getParent(n2);
+    uint32_t n2r = getRight(n2);
+    uint32_t n2lt = getLeft(n2);
+    bool n2isLeft = n2p != NIL && n2 == getLeft(n2p);
+
+    int balance = getBalance(n1);
+    setBalance(n1, getBalance(n2));
+    setBalance(n2, balance);
+
+    setParent(n1, n2p);
+    setParent(n2, n1p);
+    setLeft(n1, n2lt);
+    setLeft(n2, n1lt);
+    setRight(n1, n2r);
+    setRight(n2, n1r);
+
+    // When one was the child of the other, the swapped links point at themselves
+    if (n1r == n2) {
+        setRight(n2, n1);
+        setParent(n1, n2);
+    } else if (n2r == n1) {
+        setRight(n1, n2);
+        setParent(n2, n1);
+    } else if (n1lt == n2) {
+        setLeft(n2, n1);
+        setParent(n1, n2);
+    } else if (n2lt == n1) {
+        setLeft(n1, n2);
+        setParent(n2, n1);
+    }
+
+    if (n1p != NIL && n1p != n2) {
+        if (n1isLeft) {
+            setLeft(n1p, n2);
+        } else {
+            setRight(n1p, n2);
+        }
+    }
+    if (n1r != NIL && n1r != n2) {
+        setParent(n1r, n2);
+    }
+    if (n1lt != NIL && n1lt != n2) {
+        setParent(n1lt, n2);
+    }
+
+    if (n2p != NIL && n2p != n1) {
+        if (n2isLeft) {
+            setLeft(n2p, n1);
+        } else {
+            setRight(n2p, n1);
+        }
+    }
+    if (n2r != NIL && n2r != n1) {
+        setParent(n2r, n1);
+    }
+    if (n2lt != NIL && n2lt != n1) {
+        setParent(n2lt, n1);
+    }
+
+    if (root_ == n1) {
+        root_ = n2;
+    } else if (root_ == n2) {
+        root_ = n1;
+    }
+}
+
+// Destroys every item without recursion: children are unlinked on the way down and freed on the way back up
+template<class Key, class Value>
+void PooledAVLTree<Key, Value>::clear() {
+    uint32_t n = root_;
+    while (n != NIL) {
+        if (getLeft(n) != NIL) {
+            uint32_t left = getLeft(n);
+            setLeft(n, NIL);
+            n = left;
+        } else if (getRight(n) != NIL) {
+            uint32_t right = getRight(n);
+            setRight(n, NIL);
+            n = right;
+        } else {
+            uint32_t parent = getParent(n);
+            item(n).~Item();
+            n = parent;
+        }
+    }
+    chunks_.clear();
+    used_ = 0;
+    freeList_ = NIL;
+    root_ = NIL;
+    size_ = 0;
+}
+
+// Checks the heights of every subtree, and that the stored balances match them, in one post-order walk
+template<class Key, class Value>
+bool PooledAVLTree<Key, Value>::isBalanced() const {
+    std::vector<unsigned char> height(used_, 0);
+    uint32_t prev = NIL;
+    uint32_t n = root_;
+    while (n != NIL) {
+        uint32_t parent = getParent(n);
+        uint32_t left = getLeft(n);
+        uint32_t right = getRight(n);
+        uint32_t next;
+        if (prev == parent && left != NIL) {
+            next = left;
+        } else if ((prev == parent || prev == left) && right != NIL) {
+            next = right;
+        } else {
+            int leftHeight = left == NIL ? 0 : height[left];
+            int rightHeight = right == NIL ? 0 : height[right];
+            if (rightHeight - leftHeight != getBalance(n) || leftHeight - rightHeight > 1
+                || rightHeight - leftHeight > 1) {
+                return false;
+            }
+            height[n] = static_cast<unsigned char>(1 + std::max(leftHeight, rightHeight));
+            next = parent;
+        }
+        prev = n;
+        n = next;
+    }
+    return true;
+}
+
+// ---------------------------------------------------
+// End implementations for the PooledAVLTree class.
+// ---------------------------------------------------
+
+#endif